@@ -86,48 +86,131 @@ bool NTPClient::forceUpdate() {
     Serial.println("Update from NTP Server");
   #endif
 
-  // flush any existing packets
-  while(this->_udp->parsePacket() != 0)
-    this->_udp->flush();
-
-  this->sendNTPPacket();
+  if (!this->beginUpdate()) return false;
 
   // Wait till data is there or timeout...
-  byte timeout = 0;
-  int cb = 0;
-  do {
+  UpdateState state;
+  while ((state = this->pollUpdate()) == NTP_PENDING)
     delay ( 10 );
-    cb = this->_udp->parsePacket();
-    if (timeout > 100) return false; // timeout after 1000 ms
-    timeout++;
-  } while (cb == 0);
 
-  this->_lastUpdate = millis() - (10 * (timeout + 1)); // Account for delay in reading the time
+  return state == NTP_DONE;
+}
 
-  this->_udp->read(this->_packetBuffer, NTP_PACKET_SIZE);
+bool NTPClient::beginUpdate() {
+  // flush any existing packets
+  while(this->_udp->parsePacket() != 0)
+    this->_udp->flush();
 
-  unsigned long highWord = word(this->_packetBuffer[40], this->_packetBuffer[41]);
-  unsigned long lowWord = word(this->_packetBuffer[42], this->_packetBuffer[43]);
-  // combine the four bytes (two words) into a long integer
-  // this is NTP time (seconds since Jan 1 1900):
-  unsigned long secsSince1900 = highWord << 16 | lowWord;
+  this->sendNTPPacket();
+  this->_state = NTP_PENDING;
+  return true;
+}
 
-  this->_currentEpoc = secsSince1900 - SEVENZYYEARS;
+NTPClient::UpdateState NTPClient::pollUpdate() {
+  if (this->_state != NTP_PENDING) return NTP_IDLE;
+
+  // The reply is taken as soon as it is seen, its arrival time is T4
+  int cb;
+  while ((cb = this->_udp->parsePacket()) != 0) {
+    unsigned long received = millis();
+    if (cb >= NTP_PACKET_SIZE && this->readReply(received)) {
+      this->_state = NTP_IDLE;
+      return NTP_DONE;
+    }
+    this->_udp->flush(); // short, stale or foreign packet
+  }
 
-  return true;  // return true after successful update
+  if (millis() - this->_requestSent >= NTP_REQUEST_TIMEOUT) {
+    this->_state = NTP_FAILED;
+    return NTP_FAILED;
+  }
+  return NTP_PENDING;
 }
 
 bool NTPClient::update() {
+  if (this->_state == NTP_PENDING)
+    return this->pollUpdate() == NTP_DONE;
+
+  // After an unanswered request wait a little before asking again
+  if (this->_state == NTP_FAILED && millis() - this->_requestSent < NTP_RETRY_INTERVAL)
+    return false;
+
   if ((millis() - this->_lastUpdate >= this->_updateInterval)     // Update after _updateInterval
-    || this->_lastUpdate == 0) {                                // Update if there was no update yet.
+    || !this->_timeSet) {                                       // Update if there was no update yet.
     if (!this->_udpSetup || this->_port != NTP_DEFAULT_LOCAL_PORT) this->begin(this->_port); // setup the UDP client if needed
-    return this->forceUpdate();
+    this->beginUpdate();
   }
-  return false;   // return false if update does not occur
+  return false;   // the reply is picked up by a later call
+}
+
+// NTP timestamp (seconds since 1900 and a 32 bit fraction) to ms since 1970
+static uint64_t ntpToUnixMillis(const byte* p) {
+  uint32_t secs = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+  uint32_t frac = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 8 | p[7];
+  return (uint64_t)(uint32_t)(secs - SEVENZYYEARS) * 1000 + (((uint64_t)frac * 1000) >> 32);
+}
+
+bool NTPClient::readReply(unsigned long received) {
+  this->_udp->read(this->_packetBuffer, NTP_PACKET_SIZE);
+
+  // Server mode, not a kiss-o'-death, and an answer to our latest request
+  if ((this->_packetBuffer[0] & 0x07) != 4 || this->_packetBuffer[1] == 0) return false;
+  if (memcmp(this->_packetBuffer + 24, this->_originate, sizeof(this->_originate)) != 0) return false;
+
+  // T1 and T4 are our millis(), T2 (receive) and T3 (transmit) come from the server
+  uint64_t t2 = ntpToUnixMillis(this->_packetBuffer + 32);
+  uint64_t t3 = ntpToUnixMillis(this->_packetBuffer + 40);
+  long roundTrip = (long)(received - this->_requestSent);
+  long processing = (t3 >= t2) ? (long)(t3 - t2) : 0;
+  long delayMs = roundTrip > processing ? roundTrip - processing : 0;
+
+  if (this->_timeSet) {
+    int64_t t1 = this->localEpochMillis(this->_requestSent);
+    int64_t t4 = this->localEpochMillis(received);
+    this->_offsetMs = (long)((((int64_t)t2 - t1) + ((int64_t)t3 - t4)) / 2);
+  } else {
+    this->_offsetMs = 0;
+  }
+  this->_delayMs = delayMs;
+
+  // Server time when the reply arrived, the answer left T3 and spent half the delay on the way back
+  uint64_t epochMs = t3 + delayMs / 2;
+
+  // Keep _lastUpdate on a second boundary so getEpochTime() steps exactly on the second
+  this->_currentEpoc = epochMs / 1000;
+  this->_lastUpdate = received - (unsigned long)(epochMs % 1000);
+  this->_timeSet = true;
+  return true;
+}
+
+// Our current idea of the time at millis() timestamp at, in ms since 1970
+int64_t NTPClient::localEpochMillis(unsigned long at) const {
+  return (int64_t)this->_currentEpoc * 1000 + (long)(at - this->_lastUpdate);
 }
 
 bool NTPClient::isTimeSet() const {
-  return (this->_lastUpdate != 0); // returns true if the time has been set, else false
+  return this->_timeSet; // returns true if the time has been set, else false
+}
+
+unsigned long NTPClient::getLastUpdate() const {
+  return this->_lastUpdate;
+}
+
+unsigned long NTPClient::getEpochTimeAtLastUpdate() const {
+  return this->_timeOffset + this->_currentEpoc;
+}
+
+uint64_t NTPClient::getEpochMillis() const {
+  return (uint64_t)(this->_timeOffset + this->_currentEpoc) * 1000 + // User offset and epoch at the last update
+         (millis() - this->_lastUpdate); // Time since last update
+}
+
+long NTPClient::getOffsetMillis() const {
+  return this->_offsetMs;
+}
+
+unsigned long NTPClient::getDelayMillis() const {
+  return this->_delayMs;
 }
 
 unsigned long NTPClient::getEpochTime() const {
@@ -195,6 +278,14 @@ void NTPClient::sendNTPPacket() {
   this->_packetBuffer[14]  = 49;
   this->_packetBuffer[15]  = 52;
 
+  // The server copies our transmit timestamp into the originate field of its reply,
+  // a value unique to this request tells the answer apart from late replies to older ones
+  this->_requestCount++;
+  uint32_t stamp[2] = { (uint32_t)millis(), this->_requestCount };
+  for (int i = 0; i < 8; i++)
+    this->_originate[i] = (byte)(stamp[i / 4] >> (24 - 8 * (i % 4)));
+  memcpy(this->_packetBuffer + 40, this->_originate, sizeof(this->_originate));
+
   // all NTP fields have been given values, now
   // you can send a packet requesting a timestamp:
   if  (this->_poolServerName) {
@@ -204,6 +295,7 @@ void NTPClient::sendNTPPacket() {
   }
   this->_udp->write(this->_packetBuffer, NTP_PACKET_SIZE);
   this->_udp->endPacket();
+  this->_requestSent = millis();
 }
 
 void NTPClient::setRandomPort(unsigned int minValue, unsigned int maxValue) {
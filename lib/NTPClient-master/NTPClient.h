@@ -7,8 +7,18 @@
 #define SEVENZYYEARS 2208988800UL
 #define NTP_PACKET_SIZE 48
 #define NTP_DEFAULT_LOCAL_PORT 1337
+#define NTP_REQUEST_TIMEOUT 1000  // In ms, how long to wait for a reply
+#define NTP_RETRY_INTERVAL 5000   // In ms, pause after a request went unanswered
 
 class NTPClient {
+  public:
+    enum UpdateState {
+      NTP_IDLE,     // No request outstanding
+      NTP_PENDING,  // Request sent, waiting for the reply
+      NTP_DONE,     // Reply received and applied
+      NTP_FAILED    // No valid reply within NTP_REQUEST_TIMEOUT
+    };
+
   private:
     UDP*          _udp;
     bool          _udpSetup       = false;
@@ -21,11 +31,21 @@ class NTPClient {
     unsigned long _updateInterval = 60000;  // In ms
 
     unsigned long _currentEpoc    = 0;      // In s
-    unsigned long _lastUpdate     = 0;      // In ms
+    unsigned long _lastUpdate     = 0;      // In ms, millis() at which _currentEpoc started
+    bool          _timeSet        = false;
+
+    UpdateState   _state          = NTP_IDLE;
+    unsigned long _requestSent    = 0;      // In ms, millis() when the request went out (T1)
+    byte          _originate[8];            // Our transmit timestamp, echoed back by the server
+    uint32_t      _requestCount   = 0;
+    long          _offsetMs       = 0;      // Last measured clock offset
+    unsigned long _delayMs        = 0;      // Last measured round trip delay
 
     byte          _packetBuffer[NTP_PACKET_SIZE];
 
     void          sendNTPPacket();
+    bool          readReply(unsigned long received);
+    int64_t       localEpochMillis(unsigned long at) const;
 
   public:
     NTPClient(UDP& udp);
@@ -62,18 +82,32 @@ class NTPClient {
     /**
      * This should be called in the main loop of your application. By default an update from the NTP Server is only
      * made every 60 seconds. This can be configured in the NTPClient constructor.
+     * It never waits: a due request is sent and the reply is picked up by one of the following calls.
      *
-     * @return true on success, false on failure
+     * @return true when a reply arrived and the time was updated during this call, else false
      */
     bool update();
 
     /**
-     * This will force the update from the NTP Server.
+     * This will force the update from the NTP Server. Blocks until the reply arrives or the request times out.
      *
      * @return true on success, false on failure
      */
     bool forceUpdate();
 
+    /**
+     * Sends a request to the NTP Server and returns immediately, poll for the reply with pollUpdate().
+     *
+     * @return false if no request could be sent
+     */
+    bool beginUpdate();
+
+    /**
+     * Checks for the reply to the request sent by beginUpdate(), never waits.
+     * NTP_DONE and NTP_FAILED are reported once, later calls return NTP_IDLE.
+     */
+    UpdateState pollUpdate();
+
     /**
      * This allows to check if the NTPClient successfully received a NTP packet and set the time.
      *
@@ -107,6 +141,34 @@ class NTPClient {
      */
     unsigned long getEpochTime() const;
 
+    /**
+     * @return time in milliseconds since Jan. 1, 1970
+     */
+    uint64_t getEpochMillis() const;
+
+    /**
+     * @return difference between the server clock and ours at the last update, in ms.
+     *         ((T2 - T1) + (T3 - T4)) / 2 from the four NTP timestamps, 0 for the first update.
+     */
+    long getOffsetMillis() const;
+
+    /**
+     * @return network round trip of the last update without the server's own processing
+     *         time, (T4 - T1) - (T3 - T2), in ms
+     */
+    unsigned long getDelayMillis() const;
+
+    /**
+     * @return millis() timestamp of the last server update. getEpochTime() steps to the
+     *         next second at this timestamp plus whole seconds.
+     */
+    unsigned long getLastUpdate() const;
+
+    /**
+     * @return time in seconds since Jan. 1, 1970 at the last server update
+     */
+    unsigned long getEpochTimeAtLastUpdate() const;
+
     /**
      * Stops the underlying UDP client
      */
@@ -6,6 +6,7 @@
 //
 
 #include "../src/PNGdec.h"
+#include <time.h>
 
 PNG png; // static instance of class
 
@@ -97,17 +98,223 @@ void PNGDraw(PNGDRAW *pDraw)
     uint16_t usPixels[320];
       png.getLineAsRGB565(pDraw, usPixels, PNG_RGB565_LITTLE_ENDIAN, 0xffffffff);
 }
+
+//
+// Band mode benchmark
+// Every draw callback stands for one panel write: an ILI9341 address window
+// (CASET + 4, PASET + 4, RAMWR = 11 bytes) followed by the RGB565 pixels.
+// The pixels are checksummed so each band height can be compared with line mode.
+//
+#define BENCH_SPI_HZ 55000000 // HamClock's SPI_FREQUENCY
+#define BENCH_WINDOW_BYTES 11
+#define BENCH_PASSES 50
+
+typedef struct bench_tag
+{
+    int iCalls;
+    uint32_t u32Sum;
+} BENCH;
+
+static uint16_t usBenchLine[480];
+
+static void BenchSum(BENCH *pBench, const uint16_t *pPixels, int iCount)
+{
+    for (int i=0; i<iCount; i++)
+        pBench->u32Sum = (pBench->u32Sum * 31) + pPixels[i];
+}
+
+void BenchLineDraw(PNGDRAW *pDraw)
+{
+    BENCH *pBench = (BENCH *)pDraw->pUser;
+    png.getLineAsRGB565(pDraw, usBenchLine, PNG_RGB565_BIG_ENDIAN, 0xffffffff);
+    BenchSum(pBench, usBenchLine, pDraw->iWidth);
+    pBench->iCalls++;
+}
+
+void BenchBandDraw(PNGDRAW *pDraw)
+{
+    BENCH *pBench = (BENCH *)pDraw->pUser;
+    BenchSum(pBench, pDraw->pBand, pDraw->iWidth * pDraw->iLines);
+    pBench->iCalls++;
+}
+
+static double BenchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int Bench(uint8_t *pData, int iDataSize)
+{
+    static const int iBands[] = {0, 1, 2, 4, 8, 16, 32}; // 0 = line mode
+    uint16_t *pBand = NULL;
+    uint32_t u32Ref = 0;
+    int iErrors = 0;
+
+    for (int b=0; b<(int)(sizeof(iBands)/sizeof(iBands[0])); b++) {
+        BENCH bench;
+        double dStart, dDecode;
+        int rc = png.openRAM(pData, iDataSize, iBands[b] ? BenchBandDraw : BenchLineDraw);
+        if (rc != PNG_SUCCESS) {
+            fprintf(stderr, "Unable to open the image\n");
+            return -1;
+        }
+        if (iBands[b] && pBand == NULL)
+            pBand = (uint16_t *)malloc(png.getWidth() * 32 * sizeof(uint16_t));
+        dStart = BenchNow();
+        for (int i=0; i<BENCH_PASSES; i++) {
+            png.openRAM(pData, iDataSize, iBands[b] ? BenchBandDraw : BenchLineDraw);
+            if (iBands[b])
+                png.setBand(pBand, iBands[b], PNG_RGB565_BIG_ENDIAN, 0xffffffff);
+            memset(&bench, 0, sizeof(bench));
+            png.decode(&bench, 0);
+        }
+        dDecode = (BenchNow() - dStart) / BENCH_PASSES;
+        if (b == 0)
+            u32Ref = bench.u32Sum;
+        else if (bench.u32Sum != u32Ref)
+            iErrors++;
+
+        uint32_t u32Pixels = (uint32_t)png.getWidth() * png.getHeight();
+        uint32_t u32Overhead = bench.iCalls * BENCH_WINDOW_BYTES;
+        double dBus = (u32Pixels * 2 + u32Overhead) * 8.0 * 1e6 / BENCH_SPI_HZ;
+        printf("%-5s %3d: %4d writes, %6u window bytes, bus %7.1f us, decode %8.1f us, pixels %s\n",
+               iBands[b] ? "band" : "line", iBands[b] ? iBands[b] : 1, bench.iCalls, u32Overhead, dBus, dDecode,
+               (b == 0) ? "reference" : ((bench.u32Sum == u32Ref) ? "match" : "DIFFER"));
+        png.close();
+    }
+    free(pBand);
+    return iErrors;
+} /* Bench() */
+
+//
+// Fit check
+// Decodes the image fitted into a iMaxWidth x iMaxHeight box (setScale + band
+// mode) and compares it with a box filter of the fully decoded image computed
+// here. Every box pixel must be written at most once and the image centred.
+//
+static uint16_t *pFitBox;
+static uint8_t *pFitWritten;
+static int iFitMaxWidth, iFitMaxHeight, iFitOverlaps, iFitOutside;
+
+void FitDraw(PNGDRAW *pDraw)
+{
+    for (int y=0; y<pDraw->iLines; y++) {
+        for (int x=0; x<pDraw->iWidth; x++) {
+            int bx = pDraw->x + x, by = pDraw->y + y;
+            if (bx < 0 || by < 0 || bx >= iFitMaxWidth || by >= iFitMaxHeight) {
+                iFitOutside++;
+                continue;
+            }
+            if (pFitWritten[by * iFitMaxWidth + bx]++)
+                iFitOverlaps++;
+            pFitBox[by * iFitMaxWidth + bx] = pDraw->pBand[y * pDraw->iWidth + x];
+        }
+    }
+}
+
+int Fit(uint8_t *pData, int iDataSize, int iMaxWidth, int iMaxHeight)
+{
+    int rc, iWidth, iHeight, iOutWidth, iOutHeight, iOutX, iOutY, iWorst = 0, iMissing = 0;
+    uint16_t *pBand, *pFull;
+    uint8_t *pImage;
+
+    rc = png.openRAM(pData, iDataSize, FitDraw);
+    if (rc != PNG_SUCCESS) {
+        printf("open failed, error %d\n", png.getLastError());
+        return 2;
+    }
+    iWidth = png.getWidth(); iHeight = png.getHeight();
+    rc = png.setScale(iMaxWidth, iMaxHeight);
+    if (rc != PNG_SUCCESS) {
+        printf("setScale failed, error %d\n", rc);
+        return 2;
+    }
+    iOutWidth = png.getOutputWidth(); iOutHeight = png.getOutputHeight();
+    iOutX = (iMaxWidth - iOutWidth) / 2; iOutY = (iMaxHeight - iOutHeight) / 2;
+    iFitMaxWidth = iMaxWidth; iFitMaxHeight = iMaxHeight;
+    iFitOverlaps = iFitOutside = 0;
+    pFitBox = (uint16_t *)calloc(iMaxWidth * iMaxHeight, sizeof(uint16_t));
+    pFitWritten = (uint8_t *)calloc(iMaxWidth * iMaxHeight, 1);
+    pBand = (uint16_t *)malloc(iOutWidth * 7 * sizeof(uint16_t)); // odd band height on purpose
+    png.setBand(pBand, 7, PNG_RGB565_LITTLE_ENDIAN, 0xffffffff);
+    rc = png.decode(NULL, 0);
+    free(pBand);
+    if (rc != PNG_SUCCESS) {
+        printf("decode failed, error %d\n", rc);
+        return 1;
+    }
+
+    // Reference: the whole image in RGB565, then a box filter of it
+    png.openRAM(pData, iDataSize, NULL);
+    pImage = (uint8_t *)malloc(png.getBufferSize());
+    pFull = (uint16_t *)malloc((iWidth * iHeight + 8) * sizeof(uint16_t));
+    png.setBuffer(pImage);
+    png.decode(NULL, 0);
+    for (int y=0; y<iHeight; y++) {
+        PNGDRAW pngd;
+        memset(&pngd, 0, sizeof(pngd));
+        pngd.iWidth = iWidth;
+        pngd.iPitch = png.getBufferSize() / iHeight;
+        pngd.iPixelType = png.getPixelType();
+        pngd.iBpp = png.getBpp();
+        pngd.iHasAlpha = png.hasAlpha();
+        pngd.pPalette = png.getPalette();
+        pngd.pPixels = &pImage[y * pngd.iPitch];
+        png.getLineAsRGB565(&pngd, &pFull[y * iWidth], PNG_RGB565_LITTLE_ENDIAN, 0xffffffff);
+    }
+    for (int oy=0; oy<iOutHeight; oy++) {
+        int y0 = (int)(((int64_t)oy * iHeight + iOutHeight - 1) / iOutHeight);
+        int y1 = (int)(((int64_t)(oy+1) * iHeight + iOutHeight - 1) / iOutHeight);
+        for (int ox=0; ox<iOutWidth; ox++) {
+            int x0 = (int)(((int64_t)ox * iWidth + iOutWidth - 1) / iOutWidth);
+            int x1 = (int)(((int64_t)(ox+1) * iWidth + iOutWidth - 1) / iOutWidth);
+            double r = 0, g = 0, b = 0, n = (double)(x1 - x0) * (y1 - y0);
+            for (int y=y0; y<y1; y++)
+                for (int x=x0; x<x1; x++) {
+                    uint16_t us = pFull[y * iWidth + x];
+                    r += us >> 11; g += (us >> 5) & 0x3f; b += us & 0x1f;
+                }
+            int bx = iOutX + ox, by = iOutY + oy;
+            if (!pFitWritten[by * iMaxWidth + bx]) {
+                iMissing++;
+                continue;
+            }
+            uint16_t us = pFitBox[by * iMaxWidth + bx];
+            int dr = abs((int)(us >> 11) - (int)(r / n + 0.5));
+            int dg = abs((int)((us >> 5) & 0x3f) - (int)(g / n + 0.5));
+            int db = abs((int)(us & 0x1f) - (int)(b / n + 0.5));
+            if (dr > iWorst) iWorst = dr;
+            if (dg > iWorst) iWorst = dg;
+            if (db > iWorst) iWorst = db;
+        }
+    }
+    printf("(%d x %d) type %d, %d bpp -> (%d x %d) at (%d, %d): missing %d, overlaps %d, outside %d, worst difference %d\n",
+           iWidth, iHeight, png.getPixelType(), png.getBpp(), iOutWidth, iOutHeight, iOutX, iOutY,
+           iMissing, iFitOverlaps, iFitOutside, iWorst);
+    free(pImage); free(pFull); free(pFitBox); free(pFitWritten);
+    // the sums are rounded once, the reference only differs when a .5 falls the other way
+    return (iMissing || iFitOverlaps || iFitOutside || iWorst > 1) ? 1 : 0;
+} /* Fit() */
+
 int main(int argc, const char * argv[]) {
     int i, rc;
     uint8_t *pData;
     int iDataSize;
     FILE *ihandle;
     uint8_t *pPalette;
+    bool bBench = (argc == 3 && strcmp(argv[1], "-bench") == 0);
+    bool bFit = (argc == 5 && strcmp(argv[1], "-fit") == 0);
     
-    if (argc != 3) {
+    if (argc != 3 && !bFit) {
        printf("Usage: png_demo <infile.png> <outfile.bmp>\n");
+       printf("       png_demo -bench <infile.png>\n");
+       printf("       png_demo -fit <infile.png> <width> <height>\n");
        return 0;
     }
+    if (bBench || bFit)
+        argv++;
     ihandle = fopen(argv[1],"rb"); // open input file
     if (ihandle == NULL)
     {
@@ -120,6 +327,20 @@ int main(int argc, const char * argv[]) {
     pData = (uint8_t *)malloc(iDataSize);
     fread(pData, 1, iDataSize, ihandle);
     fclose(ihandle);
+    if (bFit) {
+        printf("%s: ", argv[1]);
+        rc = Fit(pData, iDataSize, atoi(argv[2]), atoi(argv[3]));
+        free(pData);
+        return rc;
+    }
+    if (bBench) {
+        printf("%s: ", argv[1]);
+        rc = png.openRAM(pData, iDataSize, NULL);
+        printf("(%d x %d), %d bpp, pixel type: %d\n", png.getWidth(), png.getHeight(), png.getBpp(), png.getPixelType());
+        rc = Bench(pData, iDataSize);
+        free(pData);
+        return rc;
+    }
     
 //    for (int j=0; j<10000; j++) {
         rc = png.openRAM(pData, iDataSize, NULL); //PNGDraw);
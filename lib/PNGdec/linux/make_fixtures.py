@@ -0,0 +1,85 @@
+# make_fixtures.py — PNG files for png_demo -fit, written with zlib
+#
+# fit_*.png must decode, fitted into the box, to the box filter of the full image (the
+# widest RGBA and RGB rows PNGdec buffers among them). unsupported_*.png (interlaced,
+# 16 bits per channel) must fail to open with PNG_UNSUPPORTED_FEATURE and too_big_*.png
+# (one pixel past the widest rows) with PNG_TOO_BIG. Pixels follow a pattern with every
+# channel changing, so a misplaced row or column shows in the comparison.
+#   python3 make_fixtures.py fixtures
+
+import os
+import struct
+import sys
+import zlib
+
+SAMPLES = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}  # Per pixel, by colour type
+
+
+def chunk(kind, data):
+    body = kind + data
+    return struct.pack(">I", len(data)) + body + struct.pack(">I", zlib.crc32(body))
+
+
+def sample(x, y, c, depth):
+    v = (x * (7 + 2 * c) + y * (3 + c) + (x * y >> 4)) & 0xFFFF
+    return v & ((1 << depth) - 1)
+
+
+def png(width, height, depth, colour, interlace=0):
+    ihdr = struct.pack(">IIBBBBB", width, height, depth, colour, 0, 0, interlace)
+    out = b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", ihdr)
+    if colour == 3:
+        out += chunk(b"PLTE", bytes((i * 53 + c * 91) & 0xFF for i in range(1 << depth) for c in range(3)))
+
+    # Filter type 0 on every row; an interlaced file is only checked for its header, one
+    # pass of the whole image stands in for the seven
+    raw = bytearray()
+    for y in range(height):
+        bits = 0
+        nbits = 0
+        row = bytearray([0])
+        for x in range(width):
+            for c in range(SAMPLES[colour]):
+                v = sample(x, y, c, depth)
+                if depth == 16:
+                    row += struct.pack(">H", v)
+                    continue
+                bits = bits << depth | v
+                nbits += depth
+                if nbits == 8:
+                    row.append(bits)
+                    bits = nbits = 0
+        if nbits:
+            row.append(bits << (8 - nbits))
+        raw += row
+    return out + chunk(b"IDAT", zlib.compress(bytes(raw), 9)) + chunk(b"IEND", b"")
+
+
+FIXTURES = {
+    "fit_rgb_320x240.png": (320, 240, 8, 2),
+    "fit_rgb_640x480.png": (640, 480, 8, 2),
+    "fit_rgb_1280x300.png": (1280, 300, 8, 2),  # 3840 bytes a row, the widest RGB
+    "fit_rgba_960x300.png": (960, 300, 8, 6),  # Likewise for RGBA
+    "fit_rgba_100x80.png": (100, 80, 8, 6),
+    "fit_grey_alpha_500x50.png": (500, 50, 8, 4),
+    "fit_grey_2bit_101x77.png": (101, 77, 2, 0),
+    "fit_palette_4bit_333x500.png": (333, 500, 4, 3),
+    "fit_palette_1bit_7x5.png": (7, 5, 1, 3),
+    "unsupported_interlaced.png": (64, 48, 8, 2, 1),
+    "unsupported_16bit.png": (100, 100, 16, 2),
+    "too_big_rgba_961.png": (961, 2, 8, 6),
+    "too_big_rgb_1281.png": (1281, 2, 8, 2),
+}
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: make_fixtures.py <folder>")
+    os.makedirs(sys.argv[1], exist_ok=True)
+    for name, args in FIXTURES.items():
+        with open(os.path.join(sys.argv[1], name), "wb") as f:
+            f.write(png(*args))
+
+
+if __name__ == "__main__":
+    main()
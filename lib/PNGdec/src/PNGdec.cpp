@@ -24,6 +24,7 @@
 // forward references
 PNG_STATIC int PNGInit(PNGIMAGE *pPNG);
 PNG_STATIC int DecodePNG(PNGIMAGE *pImage, void *pUser, int iOptions);
+PNG_STATIC int PNGSetScale(PNGIMAGE *pPage, int iMaxWidth, int iMaxHeight);
 PNG_STATIC uint8_t PNGMakeMask(PNGDRAW *pDraw, uint8_t *pMask, uint8_t ucThreshold);
 // Include the C code which does the actual work
 #include "png.inl"
@@ -73,8 +74,10 @@ int PNG::open(const char *szFilename, PNG_OPEN_CALLBACK *pfnOpen, PNG_CLOSE_CALL
     _png.pfnOpen = pfnOpen;
     _png.pfnClose = pfnClose;
     _png.PNGFile.fHandle = (*pfnOpen)(szFilename, &_png.PNGFile.iSize);
-    if (_png.PNGFile.fHandle == NULL)
-       return 0;
+    if (_png.PNGFile.fHandle == NULL) {
+       _png.iError = PNG_INVALID_FILE;
+       return _png.iError;
+    }
     return PNGInit(&_png);
 
 } /* open() */
@@ -153,6 +156,40 @@ void PNG::setBuffer(uint8_t *pBuffer)
     _png.pImage = pBuffer;
 } /* setBuffer() */
 //
+// Band mode: rows are converted to RGB565 into pBand (iLines * width pixels,
+// managed by the caller) and the PNGDRAW callback gets iLines rows at once,
+// so a display can write them through one address window. Call after open().
+//
+void PNG::setBand(uint16_t *pBand, int iLines, int iEndianness, uint32_t u32Bkgd)
+{
+    _png.pBand = (iLines > 0) ? pBand : NULL;
+    _png.iBandLines = iLines;
+    _png.iBandEndianness = iEndianness;
+    _png.u32BandBkgd = u32Bkgd;
+} /* setBand() */
+//
+// Band mode: fit the image into iMaxWidth x iMaxHeight and centre it there.
+// A larger image is box filtered down (aspect ratio kept) while it decodes,
+// only one output row of sums is kept. Call after open(), then size the band
+// buffer from getOutputWidth(). Without this the output is the image as is.
+//
+int PNG::setScale(int iMaxWidth, int iMaxHeight)
+{
+    return PNGSetScale(&_png, iMaxWidth, iMaxHeight);
+} /* setScale() */
+//
+// Band mode output size, valid after open() (and setScale())
+//
+int PNG::getOutputWidth()
+{
+    return _png.iOutWidth ? _png.iOutWidth : _png.iWidth;
+} /* getOutputWidth() */
+
+int PNG::getOutputHeight()
+{
+    return _png.iOutHeight ? _png.iOutHeight : _png.iHeight;
+} /* getOutputHeight() */
+//
 // Returns the previously set image buffer or NULL if there is none
 //
 uint8_t * PNG::getBuffer()
@@ -179,7 +216,7 @@ uint8_t * PNG::getPalette()
 //
 void PNG::close()
 {
-    if (_png.pfnClose)
+    if (_png.pfnClose && _png.PNGFile.fHandle)
         (*_png.pfnClose)(_png.PNGFile.fHandle);
 } /* close() */
 
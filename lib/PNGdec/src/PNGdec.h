@@ -50,7 +50,13 @@
 #define PNG_FILE_BUF_SIZE 2048
 // Number of bytes to reserve for current and previous lines
 // Defaults to 480 32-bit pixels max width
+#ifndef PNG_MAX_BUFFERED_PIXELS
 #define PNG_MAX_BUFFERED_PIXELS ((480*4 + 1)*2)
+#endif
+// Widest output of the downscaling stage (setScale)
+#ifndef PNG_MAX_SCALED_WIDTH
+#define PNG_MAX_SCALED_WIDTH 480
+#endif
 // PNG filter type
 enum {
     PNG_FILTER_NONE=0,
@@ -100,8 +106,11 @@ enum {
 
 typedef struct png_draw_tag
 {
+    int x; // band mode: left edge of the rows (centring), else 0
     int y; // starting x,y of this line
     int iWidth; // size of this line
+    int iLines; // band mode: number of rows in pBand (the last band can be short), else 1
+    uint16_t *pBand; // band mode: iLines rows of iWidth RGB565 pixels, else NULL
     int iPitch; // bytes per line
     int iPixelType; // PNG pixel type (0,2,3,4,6)
     int iBpp; // bits per color stimulus
@@ -141,6 +150,15 @@ typedef struct png_image_tag
     int iInterlaced;
     uint32_t iTransparent; // transparent color index/value
     int iError;
+    uint16_t *pBand; // caller's RGB565 band buffer, NULL = one callback per raw line
+    int iBandLines, iBandEndianness;
+    uint32_t u32BandBkgd;
+    int iBandRows; // rows waiting in the band buffer
+    int iOutWidth, iOutHeight; // band mode output size, the image size unless downscaled
+    int iOutX, iOutY; // band mode position of the output (centring)
+    int iOutRow; // next output row
+    int iAccRows; // source rows summed into u32Acc
+    uint32_t u32Acc[PNG_MAX_SCALED_WIDTH * 3]; // downscaling: R, G, B sums per output column
     PNG_READ_CALLBACK *pfnRead;
     PNG_SEEK_CALLBACK *pfnSeek;
     PNG_OPEN_CALLBACK *pfnOpen;
@@ -149,7 +167,7 @@ typedef struct png_image_tag
     PNGFILE PNGFile;
     uint8_t ucZLIB[32768 + sizeof(inflate_state)]; // put this here to avoid needing malloc/free
     uint8_t ucPalette[1024];
-    uint8_t ucPixels[PNG_MAX_BUFFERED_PIXELS * 2];
+    uint8_t ucPixels[PNG_MAX_BUFFERED_PIXELS * 2 + 32]; // current and previous line, both 16-byte aligned
     uint8_t ucFileBuf[PNG_FILE_BUF_SIZE]; // holds temp file data
 } PNGIMAGE;
 
@@ -178,6 +196,10 @@ class PNG
     int getBufferSize();
     uint8_t *getBuffer();
     void setBuffer(uint8_t *pBuffer);
+    void setBand(uint16_t *pBand, int iLines, int iEndianness, uint32_t u32Bkgd);
+    int setScale(int iMaxWidth, int iMaxHeight);
+    int getOutputWidth();
+    int getOutputHeight();
     uint8_t getAlphaMask(PNGDRAW *pDraw, uint8_t *pMask, uint8_t ucThreshold);
     void getLineAsRGB565(PNGDRAW *pDraw, uint16_t *pPixels, int iEndianness, uint32_t u32Bkgd);
 
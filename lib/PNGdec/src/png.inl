@@ -264,6 +264,21 @@ PNG_STATIC void PNGRGB565(PNGDRAW *pDraw, uint16_t *pPixels, int iEndiannes, uin
                     *pDest++ = usPixel;
                 }
                 break;
+                case 4:
+                case 2:
+                   for (x=0; x<pDraw->iWidth; x++) {
+                       int iShift = 8 - pDraw->iBpp;
+                       if ((x & ((8 / pDraw->iBpp) - 1)) == 0) {
+                           c = *s++;
+                       }
+                       j = ((c >> iShift) * 255) / ((1 << pDraw->iBpp) - 1); // scale to 8 bits
+                       usPixel = usGrayTo565[j];
+                       if (iEndiannes == PNG_RGB565_BIG_ENDIAN)
+                           usPixel = __builtin_bswap16(usPixel);
+                       *pDest++ = usPixel;
+                       c <<= pDraw->iBpp;
+                   }
+                break;
                 case 1:
                    for (x=0; x<pDraw->iWidth; x++) {
                        if ((x & 7) == 0) {
@@ -557,8 +572,10 @@ PNG_STATIC int PNGParseInfo(PNGIMAGE *pPage)
                 pPage->iHasAlpha = 1;
         } // switch
     }
-    if (pPage->iPitch >= PNG_MAX_BUFFERED_PIXELS)
-       return PNG_TOO_BIG;
+    if (pPage->iPitch >= PNG_MAX_BUFFERED_PIXELS) {
+       pPage->iError = PNG_TOO_BIG;
+       return pPage->iError;
+    }
 
     return PNG_SUCCESS;
 } /* PNGParseInfo() */
@@ -658,6 +675,123 @@ PNG_STATIC void DeFilter(uint8_t *pCurr, uint8_t *pPrev, int iWidth, int iPitch)
     } // switch on filter type
 } /* DeFilter() */
 //
+// Band mode output size and position for an image fitted into iMaxWidth x iMaxHeight
+//
+PNG_STATIC int PNGSetScale(PNGIMAGE *pPage, int iMaxWidth, int iMaxHeight)
+{
+    int64_t w = pPage->iWidth, h = pPage->iHeight;
+
+    if (iMaxWidth <= 0 || iMaxHeight <= 0)
+        return PNG_INVALID_PARAMETER;
+    if (w > iMaxWidth || h > iMaxHeight) { // shrink the side that overflows most
+        if (w * iMaxHeight >= h * iMaxWidth) {
+            w = iMaxWidth;
+            h = ((int64_t)pPage->iHeight * iMaxWidth + pPage->iWidth/2) / pPage->iWidth;
+        } else {
+            h = iMaxHeight;
+            w = ((int64_t)pPage->iWidth * iMaxHeight + pPage->iHeight/2) / pPage->iHeight;
+        }
+        if (w < 1) w = 1;
+        if (h < 1) h = 1;
+        if (w > PNG_MAX_SCALED_WIDTH)
+            return PNG_TOO_BIG;
+    }
+    pPage->iOutWidth = (int)w;
+    pPage->iOutHeight = (int)h;
+    pPage->iOutX = (iMaxWidth - (int)w) / 2;
+    pPage->iOutY = (iMaxHeight - (int)h) / 2;
+    return PNG_SUCCESS;
+} /* PNGSetScale() */
+//
+// Bits of one source pixel in the raw line
+//
+PNG_STATIC int PNGBitsPerPixel(PNGIMAGE *pPage)
+{
+    switch (pPage->ucPixelType) {
+        case PNG_PIXEL_TRUECOLOR:
+            return pPage->ucBpp * 3;
+        case PNG_PIXEL_GRAY_ALPHA:
+            return pPage->ucBpp * 2;
+        case PNG_PIXEL_TRUECOLOR_ALPHA:
+            return pPage->ucBpp * 4;
+        default: // grayscale and indexed
+            return pPage->ucBpp;
+    }
+} /* PNGBitsPerPixel() */
+//
+// Band mode: convert one decoded row, either straight into the band or
+// summed into the output row it shrinks to. Calls the draw callback when
+// the band is full or the last output row is done.
+// The row is converted in pieces of 64 pixels (a whole number of bytes at any
+// bit depth) so a sub-byte format never writes past the end of the band.
+//
+#define PNG_BAND_CHUNK 64
+PNG_STATIC void PNGBandLine(PNGIMAGE *pPage, PNGDRAW *pDraw)
+{
+    uint16_t usTemp[PNG_BAND_CHUNK + 8]; // 2/4 bit loops may write a few extra
+    PNGDRAW chunk = *pDraw;
+    int iWidth = pPage->iWidth, iOutWidth = pPage->iOutWidth ? pPage->iOutWidth : iWidth;
+    int iOutHeight = pPage->iOutHeight ? pPage->iOutHeight : pPage->iHeight;
+    int bScale = (iOutWidth != iWidth || iOutHeight != pPage->iHeight);
+    int iBits = PNGBitsPerPixel(pPage);
+    uint16_t *pRow = &pPage->pBand[pPage->iBandRows * iOutWidth];
+    uint32_t *pAcc = pPage->u32Acc;
+    int x, i, n;
+
+    for (x=0; x<iWidth; x += PNG_BAND_CHUNK) {
+        n = iWidth - x;
+        if (n > PNG_BAND_CHUNK) n = PNG_BAND_CHUNK;
+        chunk.pPixels = pDraw->pPixels + (x * iBits) / 8;
+        chunk.iWidth = n;
+        if (!bScale) {
+            PNGRGB565(&chunk, usTemp, pPage->iBandEndianness, pPage->u32BandBkgd, pPage->iHasAlpha);
+            memcpy(&pRow[x], usTemp, n * sizeof(uint16_t));
+        } else { // sum R, G, B into the output column each pixel falls in
+            PNGRGB565(&chunk, usTemp, PNG_RGB565_LITTLE_ENDIAN, pPage->u32BandBkgd, pPage->iHasAlpha);
+            for (i=0; i<n; i++) {
+                uint16_t us = usTemp[i];
+                uint32_t *d = &pAcc[((int64_t)(x + i) * iOutWidth / iWidth) * 3];
+                d[0] += us >> 11;
+                d[1] += (us >> 5) & 0x3f;
+                d[2] += us & 0x1f;
+            }
+        }
+    }
+    if (bScale) {
+        int y = pDraw->y;
+        pPage->iAccRows++;
+        // this output row is done when the next source row belongs to the next one
+        if (y != pPage->iHeight-1 && ((int64_t)(y+1) * iOutHeight / pPage->iHeight) == ((int64_t)y * iOutHeight / pPage->iHeight))
+            return;
+        for (i=0; i<iOutWidth; i++) {
+            // columns x with x * iOutWidth / iWidth == i
+            int x0 = (int)(((int64_t)i * iWidth + iOutWidth - 1) / iOutWidth);
+            int x1 = (int)(((int64_t)(i+1) * iWidth + iOutWidth - 1) / iOutWidth);
+            uint32_t u32Count = (uint32_t)(x1 - x0) * pPage->iAccRows;
+            uint32_t *s = &pAcc[i * 3];
+            uint16_t us = (uint16_t)(((s[0] + u32Count/2) / u32Count) << 11);
+            us |= (uint16_t)(((s[1] + u32Count/2) / u32Count) << 5);
+            us |= (uint16_t)((s[2] + u32Count/2) / u32Count);
+            if (pPage->iBandEndianness == PNG_RGB565_BIG_ENDIAN)
+                us = __builtin_bswap16(us);
+            pRow[i] = us;
+            s[0] = s[1] = s[2] = 0;
+        }
+        pPage->iAccRows = 0;
+    }
+    pPage->iBandRows++;
+    pPage->iOutRow++;
+    if (pPage->iBandRows == pPage->iBandLines || pPage->iOutRow == iOutHeight) {
+        pDraw->x = pPage->iOutX;
+        pDraw->y = pPage->iOutY + pPage->iOutRow - pPage->iBandRows;
+        pDraw->iWidth = iOutWidth;
+        pDraw->iLines = pPage->iBandRows;
+        pDraw->pBand = pPage->pBand;
+        (*pPage->pfnDraw)(pDraw);
+        pPage->iBandRows = 0;
+    }
+} /* PNGBandLine() */
+//
 // PNGInit
 // Parse the PNG file header and confirm that it's a valid file
 //
@@ -698,6 +832,8 @@ PNG_STATIC int DecodePNG(PNGIMAGE *pPage, void *pUser, int iOptions)
     y += (15 - (y & 15));
     pPrev = &pPage->ucPixels[y];
     pPage->iError = PNG_SUCCESS;
+    pPage->iBandRows = pPage->iOutRow = pPage->iAccRows = 0;
+    memset(pPage->u32Acc, 0, sizeof(pPage->u32Acc));
     // Start decoding the image
     bDone = FALSE;
     // Inflate the compressed image data
@@ -838,8 +974,14 @@ PNG_STATIC int DecodePNG(PNGIMAGE *pPage, void *pUser, int iOptions)
                                 pngd.iPixelType = pPage->ucPixelType;
                                 pngd.iHasAlpha = pPage->iHasAlpha;
                                 pngd.iBpp = pPage->ucBpp;
+                                pngd.x = 0;
                                 pngd.y = y;
-                                (*pPage->pfnDraw)(&pngd);
+                                pngd.iLines = 1;
+                                pngd.pBand = NULL;
+                                if (pPage->pBand == NULL)
+                                    (*pPage->pfnDraw)(&pngd);
+                                else
+                                    PNGBandLine(pPage, &pngd);
                             } else {
                                 // copy to destination bitmap
                                 memcpy(&pPage->pImage[y * pPage->iPitch], &pCurr[1], pPage->iPitch);
@@ -0,0 +1,274 @@
+        ////////////////////////////////////////////////////
+        //      TFT_eSPI Linux host emulator functions    //
+        ////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Global variables
+////////////////////////////////////////////////////////////////////////////////////////
+
+// The emulator stands in for the SPI port
+ILI9341_Emulator tft_emulator;
+ILI9341_Emulator& spi = tft_emulator;
+
+// ILI9341 command codes decoded by the emulator
+#define EMU_CMD_CASET  0x2A
+#define EMU_CMD_PASET  0x2B
+#define EMU_CMD_RAMWR  0x2C
+#define EMU_CMD_MADCTL 0x36
+#define EMU_CMD_VSCRDEF  0x33
+#define EMU_CMD_VSCRSADD 0x37
+
+#define EMU_MAD_MY 0x80
+#define EMU_MAD_MX 0x40
+#define EMU_MAD_MV 0x20
+
+/***************************************************************************************
+** Function name:           ILI9341_Emulator
+** Description:             Constructor, power on reset state
+***************************************************************************************/
+ILI9341_Emulator::ILI9341_Emulator(void)
+{
+  memset(_gram, 0, sizeof(_gram));
+  _dc = true; _cs = true;
+  _cmd = 0; _nparam = 0;
+  _madctl = 0;
+  _tfa = 0; _vsa = EMU_PANEL_HEIGHT; _bfa = 0; _vsp = 0;
+  _xs = 0; _xe = EMU_PANEL_WIDTH - 1;
+  _ys = 0; _ye = EMU_PANEL_HEIGHT - 1;
+  _col = 0; _row = 0;
+  _pixHi = 0; _pixPhase = false;
+  _frames = 0;
+  resetStats();
+}
+
+/***************************************************************************************
+** Function name:           dc / cs
+** Description:             Data/command and chip select line state
+***************************************************************************************/
+void ILI9341_Emulator::dc(bool data)
+{
+  _dc = data;
+}
+
+void ILI9341_Emulator::cs(bool high)
+{
+  if (!high && _cs) { _frame.transactions++; _total.transactions++; }
+  _cs = high;
+}
+
+/***************************************************************************************
+** Function name:           transfer / transfer16
+** Description:             Clock bytes into the emulated controller
+***************************************************************************************/
+uint8_t ILI9341_Emulator::transfer(uint8_t b)
+{
+  count(1);
+  if (_dc) data(b);
+  else command(b);
+  return 0; // Reads are not emulated
+}
+
+uint16_t ILI9341_Emulator::transfer16(uint16_t w)
+{
+  transfer(w >> 8);
+  transfer(w & 0xFF);
+  return 0;
+}
+
+/***************************************************************************************
+** Function name:           count
+** Description:             Update byte counters
+***************************************************************************************/
+void ILI9341_Emulator::count(uint32_t bytes)
+{
+  _frame.bytes += bytes;
+  _total.bytes += bytes;
+}
+
+/***************************************************************************************
+** Function name:           command
+** Description:             Decode a command byte
+***************************************************************************************/
+void ILI9341_Emulator::command(uint8_t c)
+{
+  _cmd = c;
+  _nparam = 0;
+  _frame.commands++; _total.commands++;
+
+  if (c == EMU_CMD_RAMWR) {
+    _col = _xs;
+    _row = _ys;
+    _pixPhase = false;
+    _frame.windows++; _total.windows++;
+  }
+}
+
+/***************************************************************************************
+** Function name:           data
+** Description:             Decode a parameter or pixel byte for the current command
+***************************************************************************************/
+void ILI9341_Emulator::data(uint8_t d)
+{
+  switch (_cmd) {
+    case EMU_CMD_CASET:
+    case EMU_CMD_PASET:
+      if (_nparam < 4) _param[_nparam++] = d;
+      if (_nparam == 4) {
+        uint16_t s = (_param[0] << 8) | _param[1];
+        uint16_t e = (_param[2] << 8) | _param[3];
+        if (_cmd == EMU_CMD_CASET) { _xs = s; _xe = e; }
+        else                       { _ys = s; _ye = e; }
+        _nparam++; // Ignore any further bytes
+      }
+      break;
+
+    case EMU_CMD_MADCTL:
+      if (_nparam++ == 0) _madctl = d;
+      break;
+
+    case EMU_CMD_VSCRDEF:
+      if (_nparam < 6) _param[_nparam++] = d;
+      if (_nparam == 6) {
+        _tfa = (_param[0] << 8) | _param[1];
+        _vsa = (_param[2] << 8) | _param[3];
+        _bfa = (_param[4] << 8) | _param[5];
+        _nparam++;
+      }
+      break;
+
+    case EMU_CMD_VSCRSADD:
+      if (_nparam < 2) _param[_nparam++] = d;
+      if (_nparam == 2) {
+        _vsp = (_param[0] << 8) | _param[1];
+        _nparam++;
+      }
+      break;
+
+    case EMU_CMD_RAMWR:
+      if (!_pixPhase) { _pixHi = d; _pixPhase = true; }
+      else {
+        writePixel((_pixHi << 8) | d);
+        _pixPhase = false;
+      }
+      break;
+
+    default: // Other commands (init sequence etc.) are counted but not interpreted
+      break;
+  }
+}
+
+/***************************************************************************************
+** Function name:           writePixel
+** Description:             Store a pixel and advance the address counters
+***************************************************************************************/
+void ILI9341_Emulator::writePixel(uint16_t colour)
+{
+  int32_t px, py;
+  if (mapToPanel(_col, _row, &px, &py)) _gram[py * EMU_PANEL_WIDTH + px] = colour;
+
+  _frame.pixels++; _total.pixels++;
+
+  // Column address increments first, then page address, wrapping inside the window
+  if (_col >= _xe) {
+    _col = _xs;
+    if (_row >= _ye) _row = _ys;
+    else _row++;
+  }
+  else _col++;
+}
+
+/***************************************************************************************
+** Function name:           mapToPanel
+** Description:             Map column/page address to native panel pixel using MADCTL
+***************************************************************************************/
+bool ILI9341_Emulator::mapToPanel(int32_t c, int32_t r, int32_t *px, int32_t *py) const
+{
+  int32_t x = c, y = r;
+  if (_madctl & EMU_MAD_MV) { x = r; y = c; }
+  if (x < 0 || x >= EMU_PANEL_WIDTH || y < 0 || y >= EMU_PANEL_HEIGHT) return false;
+  if (_madctl & EMU_MAD_MX) x = EMU_PANEL_WIDTH  - 1 - x;
+  if (_madctl & EMU_MAD_MY) y = EMU_PANEL_HEIGHT - 1 - y;
+  *px = x; *py = y;
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           readPanel / readScreen
+** Description:             Read back GRAM, returns 0 outside the panel
+***************************************************************************************/
+uint16_t ILI9341_Emulator::readPanel(int32_t px, int32_t py) const
+{
+  if (px < 0 || px >= EMU_PANEL_WIDTH || py < 0 || py >= EMU_PANEL_HEIGHT) return 0;
+  return _gram[py * EMU_PANEL_WIDTH + px];
+}
+
+uint16_t ILI9341_Emulator::readScreen(int32_t x, int32_t y) const
+{
+  int32_t px, py;
+  if (!mapToPanel(x, y, &px, &py)) return 0;
+  return _gram[scrolledLine(py) * EMU_PANEL_WIDTH + px];
+}
+
+/***************************************************************************************
+** Function name:           scrolledLine
+** Description:             GRAM line shown on a display line, per VSCRDEF/VSCRSADD
+***************************************************************************************/
+int32_t ILI9341_Emulator::scrolledLine(int32_t line) const
+{
+  // Scrolling is undefined unless the areas add up to the panel height, show GRAM as is
+  if (_tfa + _vsa + _bfa != EMU_PANEL_HEIGHT || _vsa == 0) return line;
+  if (line < _tfa || line >= _tfa + _vsa) return line;
+  if (_vsp < _tfa || _vsp >= _tfa + _vsa) return line;
+
+  return _tfa + (line - _tfa + _vsp - _tfa) % _vsa;
+}
+
+/***************************************************************************************
+** Function name:           endFrame / resetStats
+** Description:             Frame accounting
+***************************************************************************************/
+void ILI9341_Emulator::endFrame(void)
+{
+  _last = _frame;
+  memset(&_frame, 0, sizeof(_frame));
+  _frames++;
+}
+
+void ILI9341_Emulator::resetStats(void)
+{
+  memset(&_frame, 0, sizeof(_frame));
+  memset(&_last,  0, sizeof(_last));
+  memset(&_total, 0, sizeof(_total));
+}
+
+/***************************************************************************************
+** Function name:           busMicros
+** Description:             Convert a byte count to bus time at SPI_FREQUENCY
+***************************************************************************************/
+uint32_t ILI9341_Emulator::busMicros(const emu_stats_t& s)
+{
+  return (uint32_t)(((uint64_t)s.bytes * 8 * 1000000UL) / SPI_FREQUENCY);
+}
+
+/***************************************************************************************
+** Function name:           pushBlock - for Linux emulator
+** Description:             Write a block of pixels of the same colour
+***************************************************************************************/
+void TFT_eSPI::pushBlock(uint16_t color, uint32_t len){
+
+  _pixelsPushed += len;
+  while ( len-- ) {tft_Write_16(color);}
+}
+
+/***************************************************************************************
+** Function name:           pushPixels - for Linux emulator
+** Description:             Write a sequence of pixels
+***************************************************************************************/
+void TFT_eSPI::pushPixels(const void* data_in, uint32_t len){
+
+  _pixelsPushed += len;
+  uint16_t *data = (uint16_t*)data_in;
+
+  if (_swapBytes) while ( len-- ) {tft_Write_16(*data); data++;}
+  else while ( len-- ) {tft_Write_16S(*data); data++;}
+}
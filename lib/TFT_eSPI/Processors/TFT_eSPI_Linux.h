@@ -0,0 +1,179 @@
+        ////////////////////////////////////////////////////
+        //      TFT_eSPI Linux host emulator functions    //
+        ////////////////////////////////////////////////////
+
+// This is a host (Linux) target that replaces the SPI bus with an ILI9341 command
+// stream interpreter. Every byte the library sends is decoded (CASET, PASET, RAMWR,
+// MADCTL, VSCRDEF, VSCRSADD) into an emulated 240x320 GRAM and counted, so the cost
+// of any rendering code can be measured without hardware. Only the SPI 16-bit colour interface is
+// supported. The sketch/harness must supply an Arduino.h compatible header; the host
+// tests in the sketch's linux/ folder build and run it (make -C linux test).
+
+#ifndef _TFT_eSPI_LINUXH_
+#define _TFT_eSPI_LINUXH_
+
+// Processor ID reported by getSetup()
+#define PROCESSOR_ID 0x1170
+
+// Include processor specific header
+#include <stdint.h>
+#include <string.h>
+
+// Processor specific code used by SPI bus transaction startWrite and endWrite functions
+#define SET_BUS_WRITE_MODE // Not used
+#define SET_BUS_READ_MODE  // Not used
+
+// Code to check if DMA is busy, used by SPI bus transaction startWrite and endWrite functions
+#define DMA_BUSY_CHECK // Not used so leave blank
+
+// To be safe, SUPPORT_TRANSACTIONS is assumed mandatory
+#if !defined (SUPPORT_TRANSACTIONS)
+  #define SUPPORT_TRANSACTIONS
+#endif
+
+// Initialise processor specific SPI functions, used by init()
+#define INIT_TFT_DATA_BUS
+
+// Emulated panel geometry (native portrait orientation)
+#define EMU_PANEL_WIDTH  240
+#define EMU_PANEL_HEIGHT 320
+
+////////////////////////////////////////////////////////////////////////////////////////
+// ILI9341 command stream emulator
+////////////////////////////////////////////////////////////////////////////////////////
+class ILI9341_Emulator {
+
+ public:
+
+  // Bus activity counters
+  typedef struct {
+    uint32_t bytes;        // Bytes clocked out on MOSI (commands + parameters + pixels)
+    uint32_t commands;     // Command bytes (DC low)
+    uint32_t windows;      // Address windows opened, i.e. RAMWR commands (one per setWindow)
+    uint32_t pixels;       // Pixels written to GRAM
+    uint32_t transactions; // Chip select low periods
+  } emu_stats_t;
+
+  ILI9341_Emulator(void);
+
+  // Bus interface used by the TFT_eSPI write macros
+  void     begin(void) {}
+  void     end(void) {}
+  void     setFrequency(uint32_t) {}
+  void     dc(bool data);
+  void     cs(bool high);
+  uint8_t  transfer(uint8_t b);
+  uint16_t transfer16(uint16_t w);
+
+  // Frame accounting, endFrame() latches and clears the current frame counters
+  void     endFrame(void);
+  void     resetStats(void);
+  const emu_stats_t& frameStats(void)     const { return _frame; }
+  const emu_stats_t& lastFrameStats(void) const { return _last; }
+  const emu_stats_t& totalStats(void)     const { return _total; }
+  uint32_t frames(void)                   const { return _frames; }
+
+  // Cost model: time the counted bytes occupy the bus at SPI_FREQUENCY
+  static uint32_t busMicros(const emu_stats_t& s);
+
+  // GRAM access, native panel coordinates or sketch coordinates via current MADCTL.
+  // readScreen() returns what is visible, i.e. after the vertical scroll is applied.
+  uint16_t readPanel(int32_t px, int32_t py) const;
+  uint16_t readScreen(int32_t x, int32_t y) const;
+  const uint16_t* gram(void) const { return _gram; }
+  uint8_t  madctl(void) const { return _madctl; }
+
+  // Vertical scroll state in native panel lines
+  uint16_t scrollTop(void)    const { return _tfa; }
+  uint16_t scrollHeight(void) const { return _vsa; }
+  uint16_t scrollStart(void)  const { return _vsp; }
+
+ private:
+  void     command(uint8_t c);
+  void     data(uint8_t d);
+  void     writePixel(uint16_t colour);
+  bool     mapToPanel(int32_t c, int32_t r, int32_t *px, int32_t *py) const;
+  int32_t  scrolledLine(int32_t line) const;
+  void     count(uint32_t bytes);
+
+  uint16_t _gram[EMU_PANEL_WIDTH * EMU_PANEL_HEIGHT];
+
+  bool     _dc, _cs;
+  uint8_t  _cmd, _param[6], _nparam;
+  uint8_t  _madctl;
+  uint16_t _tfa, _vsa, _bfa, _vsp;
+  uint16_t _xs, _xe, _ys, _ye, _col, _row;
+  uint8_t  _pixHi;
+  bool     _pixPhase;
+
+  emu_stats_t _frame, _last, _total;
+  uint32_t _frames;
+};
+
+// The emulator is the SPI port, so getSPIinstance() returns it
+typedef ILI9341_Emulator SPIClass;
+
+// Emulator instance, also accessible by the host harness
+extern ILI9341_Emulator tft_emulator;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Define the DC (TFT Data/Command or Register Select (RS))pin drive code
+////////////////////////////////////////////////////////////////////////////////////////
+#define DC_C spi.dc(false)
+#define DC_D spi.dc(true)
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Define the CS (TFT chip select) pin drive code
+////////////////////////////////////////////////////////////////////////////////////////
+#define CS_L spi.cs(false)
+#define CS_H spi.cs(true)
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Make sure TFT_RD is defined if not used to avoid an error message
+////////////////////////////////////////////////////////////////////////////////////////
+#ifndef TFT_RD
+  #define TFT_RD -1
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Define the touch screen chip select pin drive code
+////////////////////////////////////////////////////////////////////////////////////////
+#define T_CS_L // No macro allocated so it generates no code
+#define T_CS_H // No macro allocated so it generates no code
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Make sure TFT_MISO is defined if not used to avoid an error message
+////////////////////////////////////////////////////////////////////////////////////////
+#ifndef TFT_MISO
+  #define TFT_MISO -1
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Macros to write commands/pixel colour data to the emulated SPI TFT
+////////////////////////////////////////////////////////////////////////////////////////
+#define tft_Write_8(C)   spi.transfer(C)
+#define tft_Write_16(C)  spi.transfer16(C)
+#define tft_Write_16S(C) spi.transfer16(((C)>>8) | ((C)<<8))
+
+#define tft_Write_32(C) \
+tft_Write_16((uint16_t) ((C)>>16)); \
+tft_Write_16((uint16_t) ((C)>>0))
+
+#define tft_Write_32C(C,D) \
+tft_Write_16((uint16_t) (C)); \
+tft_Write_16((uint16_t) (D))
+
+#define tft_Write_32D(C) \
+tft_Write_16((uint16_t) (C)); \
+tft_Write_16((uint16_t) (C))
+
+#ifndef tft_Write_16N
+  #define tft_Write_16N tft_Write_16
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Macros to read from display
+////////////////////////////////////////////////////////////////////////////////////////
+#define tft_Read_8() spi.transfer(0)
+
+#endif // Header end
@@ -29,6 +29,8 @@
   #include "Processors/TFT_eSPI_STM32.c"
 #elif defined (ARDUINO_ARCH_RP2040)  || defined (ARDUINO_ARCH_MBED) // Raspberry Pi Pico
   #include "Processors/TFT_eSPI_RP2040.c"
+#elif defined (__linux__) // Host emulator for profiling
+  #include "Processors/TFT_eSPI_Linux.c"
 #else
   #include "Processors/TFT_eSPI_Generic.c"
 #endif
@@ -454,6 +456,15 @@ TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
 
   _fillbg    = false;   // Smooth font only at the moment, force text background fill
 
+  _gfxCellX  = 0;       // No opaque GFX Free Font cell
+  _gfxCellY  = 0;
+  _gfxCellW  = 0;
+  _gfxCellH  = 0;
+
+  _scrollTfa    = 0;    // Power on scroll state, whole panel with no offset
+  _scrollVsa    = _init_height;
+  _scrollOffset = 0;
+
   isDigits   = false;   // No bounding box adjustment
   textwrapX  = true;    // Wrap text at end of line when using print stream
   textwrapY  = false;   // Wrap text at bottom of screen when using print stream
@@ -461,6 +472,7 @@ TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
   fontsloaded = 0;
 
   _swapBytes = false;   // Do not swap colour bytes by default
+  _pixelsPushed = 0;
 
   locked = true;           // Transaction mutex lock flag to ensure begin/endTranaction pairing
   inTransaction = false;   // Flag to prevent multiple sequential functions to keep bus access open
@@ -3283,6 +3295,46 @@ void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32
       uint8_t  xx, yy, bits=0, bit=0;
       int16_t  xo16 = 0, yo16 = 0;
 
+      // Opaque cell: background and glyph written in a single window, no erase pass needed
+      int32_t xd = x + _gfxCellX + _xDatum;
+      int32_t yd = y + _gfxCellY + _yDatum;
+      if (_gfxCellW && (bg != color) && (size == 1) &&
+          (xd >= _vpX) && (yd >= _vpY) && (xd + _gfxCellW <= _vpW) && (yd + _gfxCellH <= _vpH)) {
+        begin_tft_write();
+        bool swap = _swapBytes;
+        _swapBytes = false;
+
+        setWindow(xd, yd, xd + _gfxCellW - 1, yd + _gfxCellH - 1);
+
+        // Line buffer holds colours in transmit byte order
+        uint16_t lineBuf[_gfxCellW];
+        uint16_t fgs = (uint16_t)((color >> 8) | (color << 8));
+        uint16_t bgs = (uint16_t)((bg >> 8) | (bg << 8));
+
+        // Glyph box position inside the cell
+        int32_t gx0 = xo - _gfxCellX;
+        int32_t gy0 = yo - _gfxCellY;
+
+        for (int32_t cy = 0; cy < _gfxCellH; cy++) {
+          int32_t gy = cy - gy0;
+          for (int32_t cx = 0; cx < _gfxCellW; cx++) {
+            int32_t gx = cx - gx0;
+            uint16_t pix = bgs;
+            if ((gy >= 0) && (gy < h) && (gx >= 0) && (gx < w)) {
+              uint32_t bn = gy * w + gx;
+              if (pgm_read_byte(&bitmap[bo + (bn >> 3)]) & (0x80 >> (bn & 7))) pix = fgs;
+            }
+            lineBuf[cx] = pix;
+          }
+          pushPixels(lineBuf, _gfxCellW);
+        }
+
+        _swapBytes = swap;
+        inTransaction = lockTransaction;
+        end_tft_write();
+        return;
+      }
+
       if(size > 1) {
         xo16 = xo;
         yo16 = yo;
@@ -4846,6 +4898,59 @@ void TFT_eSPI::invertDisplay(bool i)
 }
 
 
+/***************************************************************************************
+** Function name:           setScrollArea
+** Description:             Define the hardware scroll area between tfa and bfa fixed lines
+***************************************************************************************/
+#ifndef TFT_VSCRDEF
+  #define TFT_VSCRDEF  0x33
+#endif
+#ifndef TFT_VSCRSADD
+  #define TFT_VSCRSADD 0x37
+#endif
+
+void TFT_eSPI::setScrollArea(uint16_t tfa, uint16_t bfa)
+{
+  if (tfa + bfa >= _init_height) return;
+
+  _scrollTfa = tfa;
+  _scrollVsa = _init_height - tfa - bfa;
+
+  begin_tft_write();
+  writecommand(TFT_VSCRDEF);
+  writedata(tfa >> 8);        writedata(tfa);
+  writedata(_scrollVsa >> 8); writedata(_scrollVsa);
+  writedata(bfa >> 8);        writedata(bfa);
+  end_tft_write();
+
+  scrollTo(0);
+}
+
+/***************************************************************************************
+** Function name:           scrollTo
+** Description:             Show panel line tfa + offset at the start of the scroll area
+***************************************************************************************/
+void TFT_eSPI::scrollTo(uint16_t offset)
+{
+  _scrollOffset = offset % _scrollVsa;
+  uint16_t vsp = _scrollTfa + _scrollOffset;
+
+  begin_tft_write();
+  writecommand(TFT_VSCRSADD);
+  writedata(vsp >> 8); writedata(vsp);
+  end_tft_write();
+}
+
+/***************************************************************************************
+** Function name:           resetScrollArea
+** Description:             Restore the power on scroll state
+***************************************************************************************/
+void TFT_eSPI::resetScrollArea(void)
+{
+  setScrollArea(0, 0);
+}
+
+
 /**************************************************************************
 ** Function name:           setAttribute
 ** Description:             Sets a control parameter of an attribute
@@ -5603,7 +5708,9 @@ int16_t TFT_eSPI::drawString(const char *string, int32_t poX, int32_t poY, uint8
 
   int8_t xo = 0;
 #ifdef LOAD_GFXFF
-  if (freeFont && (textcolor!=textbgcolor)) {
+  // Opaque glyph cells overwrite their own background, so no fill is needed
+  if (freeFont && (textcolor!=textbgcolor) && _gfxCellW) padding -=100;
+  else if (freeFont && (textcolor!=textbgcolor)) {
       cheight = (glyph_ab + glyph_bb) * textsize;
       // Get the offset for the first character only to allow for negative offsets
       uint16_t c2 = 0;
@@ -5887,10 +5994,11 @@ void TFT_eSPI::setFreeFont(const GFXfont *f)
 
   textfont = 1;
   gfxFont = (GFXfont *)f;
+  _gfxCellW = 0; // Any opaque cell belonged to the previous font
 
   glyph_ab = 0;
   glyph_bb = 0;
-  uint16_t numChars = pgm_read_word(&gfxFont->last) - pgm_read_word(&gfxFont->first);
+  uint16_t numChars = pgm_read_word(&gfxFont->last) - pgm_read_word(&gfxFont->first) + 1; // last is included
 
   // Find the biggest above and below baseline offsets
   for (uint16_t c = 0; c < numChars; c++) {
@@ -5914,6 +6022,51 @@ void TFT_eSPI::setTextFont(uint8_t f)
   gfxFont = NULL;
 }
 
+
+/***************************************************************************************
+** Function name:           setFreeFontCell
+** Description:             Set the opaque character cell for the current GFX Free Font
+***************************************************************************************/
+void TFT_eSPI::setFreeFontCell(int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+  _gfxCellX = x;
+  _gfxCellY = y;
+  _gfxCellW = h ? w : 0;
+  _gfxCellH = h;
+}
+
+
+/***************************************************************************************
+** Function name:           setFreeFontCell
+** Description:             Set the opaque cell to bound all the characters in a string
+***************************************************************************************/
+void TFT_eSPI::setFreeFontCell(const char *chars)
+{
+  _gfxCellW = 0;
+  if (!gfxFont || !chars) return;
+
+  uint16_t first = pgm_read_word(&gfxFont->first);
+  uint16_t last  = pgm_read_word(&gfxFont->last);
+  int16_t x0 = 0x7FFF, y0 = 0x7FFF, x1 = -0x7FFF, y1 = -0x7FFF;
+
+  while (*chars) {
+    uint16_t c = (uint8_t)*chars++;
+    if ((c < first) || (c > last)) continue;
+    GFXglyph *glyph = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c - first]);
+    uint8_t w  = pgm_read_byte(&glyph->width),
+            h  = pgm_read_byte(&glyph->height);
+    int8_t  xo = pgm_read_byte(&glyph->xOffset),
+            yo = pgm_read_byte(&glyph->yOffset);
+    if (!w || !h) continue;
+    if (xo < x0) x0 = xo;
+    if (yo < y0) y0 = yo;
+    if (xo + w > x1) x1 = xo + w;
+    if (yo + h > y1) y1 = yo + h;
+  }
+
+  if ((x1 > x0) && (y1 > y0)) setFreeFontCell(x0, y0, x1 - x0, y1 - y0);
+}
+
 #else
 
 
@@ -29,7 +29,7 @@
 //Standard support
 #include <Arduino.h>
 #include <Print.h>
-#if !defined (TFT_PARALLEL_8_BIT) && !defined (RP2040_PIO_INTERFACE)
+#if !defined (TFT_PARALLEL_8_BIT) && !defined (RP2040_PIO_INTERFACE) && !defined (__linux__)
   #include <SPI.h>
 #endif
 /***************************************************************************************
@@ -82,6 +82,20 @@
     typeof(addr) _addr = (addr); \
     *(const unsigned long *)(_addr); \
   })
+#elif defined(__linux__)
+  // Host emulator, font structures hold 64-bit pointers
+  #ifndef PROGMEM
+    #define PROGMEM
+  #endif
+  #undef pgm_read_byte
+  #define pgm_read_byte(addr)   (*(const unsigned char *)(addr))
+  #undef pgm_read_word
+  #define pgm_read_word(addr)   (*(const unsigned short *)(addr))
+  #undef pgm_read_dword
+  #define pgm_read_dword(addr) ({ \
+    typeof(addr) _addr = (addr); \
+    *(const unsigned long *)(_addr); \
+  })
 #elif defined(__AVR__)
   #include <avr/pgmspace.h>
 #elif defined(ARDUINO_ARCH_ESP8266) || defined(ESP32)
@@ -105,6 +119,9 @@
   #include "Processors/TFT_eSPI_STM32.h"
 #elif defined(ARDUINO_ARCH_RP2040)
   #include "Processors/TFT_eSPI_RP2040.h"
+#elif defined (__linux__)
+  #include "Processors/TFT_eSPI_Linux.h"
+  #define GENERIC_PROCESSOR
 #else
   #include "Processors/TFT_eSPI_Generic.h"
   #define GENERIC_PROCESSOR
@@ -471,6 +488,13 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
 
   void     invertDisplay(bool i);  // Tell TFT to invert all displayed colours
 
+  // Hardware scrolling (VSCRDEF/VSCRSADD) along the panel's native height, which is the
+  // horizontal axis in landscape rotations. Line counts are in native panel lines.
+  void     setScrollArea(uint16_t tfa, uint16_t bfa); // Fixed lines before and after the scroll area
+  void     scrollTo(uint16_t offset);                 // Scroll the area by offset lines
+  void     resetScrollArea(void);                     // Whole panel scroll area, offset 0
+  uint16_t getScrollOffset(void) { return _scrollOffset; }
+
 
   // The TFT_eSprite class inherits the following functions (not all are useful to Sprite class
   void     setAddrWindow(int32_t xs, int32_t ys, int32_t w, int32_t h); // Note: start coordinates + width and height
@@ -502,6 +526,9 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
            // Write a set of pixels stored in memory, use setSwapBytes(true/false) function to correct endianess
   void     pushPixels(const void * data_in, uint32_t len);
 
+           // Pixels sent through pushBlock() and pushPixels() since boot (ESP32 and Linux only)
+  uint64_t pixelsPushed(void) { return _pixelsPushed; }
+
            // Support for half duplex (bi-directional SDA) SPI bus where MOSI must be switched to input
            #ifdef TFT_SDA_READ
              #if defined (TFT_eSPI_ENABLE_8_BIT_READ)
@@ -672,6 +699,12 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
 #ifdef LOAD_GFXFF
   void     setFreeFont(const GFXfont *f = NULL),            // Select the GFX Free Font
            setTextFont(uint8_t font);                       // Set the font number to use in future
+
+           // Opaque GFX Free Font cell, relative to the cursor x and baseline. When set and the
+           // text background differs from the foreground, each character fills the whole cell
+           // (background + glyph) in one window. Reset by setFreeFont(), w = 0 disables
+  void     setFreeFontCell(int16_t x, int16_t y, uint16_t w, uint16_t h),
+           setFreeFontCell(const char *chars);              // Cell that bounds all the listed characters
 #else
   void     setFreeFont(uint8_t font),                       // Not used, historical fix to prevent an error
            setTextFont(uint8_t font);                       // Set the font number to use in future
@@ -935,6 +968,7 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
   bool     isDigits;   // adjust bounding box for numbers to reduce visual jiggling
   bool     textwrapX, textwrapY;  // If set, 'wrap' text at right and optionally bottom edge of display
   bool     _swapBytes; // Swap the byte order for TFT pushImage()
+  uint64_t _pixelsPushed; // Pixel count for pixelsPushed()
 
   bool     _booted;    // init() or begin() has already run once
 
@@ -947,6 +981,11 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
 
   bool     _fillbg;    // Fill background flag (just for for smooth fonts at the moment)
 
+  int16_t  _gfxCellX, _gfxCellY;  // Opaque GFX Free Font cell offset from cursor x and baseline
+  uint16_t _gfxCellW, _gfxCellH;  // Cell size, width 0 = cell not used
+
+  uint16_t _scrollTfa, _scrollVsa, _scrollOffset; // Hardware scroll area and current offset
+
 #if defined (SSD1963_DRIVER)
   uint16_t Cswap;      // Swap buffer for SSD1963
   uint8_t r6, g6, b6;  // RGB buffer for SSD1963
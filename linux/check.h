@@ -0,0 +1,32 @@
+// check.h — Failure counting for the host tests
+//
+// CHECK() reports a failed condition and carries on, so one run shows every failure.
+// A test ends with `return checkResult();`, non-zero when anything failed.
+
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+#define CHECK(c)                                                         \
+    do                                                                   \
+    {                                                                    \
+        if (!(c))                                                        \
+        {                                                                \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #c);          \
+            checkFailures++;                                             \
+        }                                                                \
+    } while (0)
+
+static inline int checkResult()
+{
+    if (checkFailures)
+        printf("%d check(s) FAILED\n", checkFailures);
+    else
+        puts("all passed");
+    return checkFailures != 0;
+}
+
+#endif // HOST_CHECK_H
@@ -0,0 +1,17 @@
+// host.cpp — Serial and a virtual clock for the host tests
+//
+// Time stands still until delay() moves it, so a test decides exactly when deadlines
+// fall and runs days of clock ticks in seconds.
+
+#include <Arduino.h>
+
+HostSerial Serial;
+
+namespace
+{
+    unsigned long long nowUs = 0;
+}
+
+unsigned long millis() { return (unsigned long)(nowUs / 1000); }
+unsigned long micros() { return (unsigned long)nowUs; }
+void delay(unsigned long ms) { nowUs += ms * 1000ULL; }
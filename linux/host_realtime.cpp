@@ -0,0 +1,29 @@
+// host_realtime.cpp — Serial and the monotonic clock for tests that talk to sockets
+//
+// millis() starts at 5 s, so code that treats 0 as "never" behaves as on a running device.
+
+#include <Arduino.h>
+#include <time.h>
+
+HostSerial Serial;
+
+namespace
+{
+    long long monotonicUs()
+    {
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec * 1000000LL + t.tv_nsec / 1000;
+    }
+
+    const long long startUs = monotonicUs() - 5000000;
+}
+
+unsigned long millis() { return (unsigned long)((monotonicUs() - startUs) / 1000); }
+unsigned long micros() { return (unsigned long)(monotonicUs() - startUs); }
+
+void delay(unsigned long ms)
+{
+    struct timespec t = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+    nanosleep(&t, nullptr);
+}
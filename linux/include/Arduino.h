@@ -0,0 +1,138 @@
+// Arduino.h — The parts of the ESP32 Arduino core the host tests need
+//
+// Enough for the sketch modules, TFT_eSPI and NTPClient to build on Linux. millis(),
+// micros() and delay() come from host.cpp (a virtual clock that only delay() moves) or
+// host_realtime.cpp (the monotonic clock), whichever the test links. min() and max()
+// are std::min/std::max as in the ESP32 core, not macros, so STL headers mix freely.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define pgm_read_ptr(a) (*(void *const *)(a))
+#define digitalPinToBitMask(p) (1u << ((p) & 31))
+#define F(s) (s)
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define constrain(x, l, h) ((x) < (l) ? (l) : ((x) > (h) ? (h) : (x)))
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int digitalRead(int) { return 0; }
+inline int analogRead(int) { return 0; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+inline void delayMicroseconds(unsigned) {}
+inline void yield() {}
+
+inline long random(long lo, long hi) { return lo + rand() % (hi - lo); }
+inline long random(long hi) { return rand() % hi; }
+inline void randomSeed(unsigned long seed) { srand(seed); }
+
+inline char *ltoa(long value, char *s, int radix)
+{
+    sprintf(s, radix == 16 ? "%lx" : "%ld", value);
+    return s;
+}
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t length = strlen(src);
+    if (size)
+    {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return length;
+}
+#endif
+
+class __FlashStringHelper;
+
+class String : public std::string
+{
+public:
+    String() {}
+    String(const char *s) : std::string(s ? s : "") {}
+    String(const std::string &s) : std::string(s) {}
+    String(char c) : std::string(1, c) {}
+    String(int v) : std::string(std::to_string(v)) {}
+    String(unsigned v) : std::string(std::to_string(v)) {}
+    String(long v) : std::string(std::to_string(v)) {}
+    String(unsigned long v) : std::string(std::to_string(v)) {}
+    String(double v, int decimals = 2)
+    {
+        char b[32];
+        snprintf(b, sizeof(b), "%.*f", decimals, v);
+        assign(b);
+    }
+    unsigned int length() const { return (unsigned)size(); }
+    char charAt(unsigned i) const { return i < size() ? (*this)[i] : 0; }
+    void toCharArray(char *buf, unsigned n) const
+    {
+        if (n)
+            strlcpy(buf, c_str(), n);
+    }
+    void getBytes(uint8_t *buf, unsigned n) const { toCharArray((char *)buf, n); }
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t n)
+    {
+        size_t written = 0;
+        while (n--)
+            written += write(*buf++);
+        return written;
+    }
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+    size_t println(const char *s = "") { return print(s) + print("\n"); }
+};
+
+// Serial goes to stdout
+struct HostSerial
+{
+    void begin(unsigned long) {}
+    void print(const char *s) { fputs(s, stdout); }
+    void println(const char *s = "") { puts(s); }
+    template <class... Args>
+    void printf(const char *format, Args... args) { ::printf(format, args...); }
+};
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,87 @@
+// FS.h — fs::FS and fs::File of the ESP32 core over stdio
+//
+// An FS is a folder on the host standing in for the flash file system: "/logo1.png"
+// opens <root>/logo1.png. Files are shared handles as on the ESP32, copies refer to the
+// same open file and the last one closes it.
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <memory>
+#include <sys/stat.h>
+
+namespace fs
+{
+    class File
+    {
+    public:
+        File() {}
+        explicit File(const char *path, const char *mode = "rb")
+        {
+            if (FILE *f = fopen(path, mode))
+                _file.reset(f, fclose);
+        }
+
+        explicit operator bool() const { return (bool)_file; }
+        size_t size() const
+        {
+            struct stat st;
+            if (!_file || fflush(_file.get()) || fstat(fileno(_file.get()), &st))
+                return 0;
+            return st.st_size;
+        }
+        size_t position() const { return _file ? ftell(_file.get()) : 0; }
+        bool seek(size_t position) { return _file && fseek(_file.get(), position, SEEK_SET) == 0; }
+        size_t read(uint8_t *buf, size_t size) { return _file ? fread(buf, 1, size, _file.get()) : 0; }
+        size_t write(const uint8_t *buf, size_t size) { return _file ? fwrite(buf, 1, size, _file.get()) : 0; }
+        void flush()
+        {
+            if (_file)
+                fflush(_file.get());
+        }
+        bool isDirectory() const { return false; }
+        void close() { _file.reset(); }
+
+    private:
+        std::shared_ptr<FILE> _file;
+    };
+
+    class FS
+    {
+    public:
+        explicit FS(const char *root) : _root(root) {}
+
+        // Modes as on the ESP32: "r", "w" (truncate), "a" and "r+"
+        File open(const String &path, const char *mode = "r")
+        {
+            const char *stdioMode = !strcmp(mode, "w") ? "w+b" : !strcmp(mode, "a") ? "ab" : !strcmp(mode, "r+") ? "r+b" : "rb";
+            return File((_root + path).c_str(), stdioMode);
+        }
+        bool exists(const String &path)
+        {
+            FILE *f = fopen((_root + path).c_str(), "rb");
+            if (f)
+                fclose(f);
+            return f != nullptr;
+        }
+        bool remove(const String &path) { return ::remove((_root + path).c_str()) == 0; }
+        // As SPIFFS, never over an existing file
+        bool rename(const String &from, const String &to)
+        {
+            if ((failRenames > 0 && failRenames-- == 1) || exists(to))
+                return false;
+            return ::rename((_root + from).c_str(), (_root + to).c_str()) == 0;
+        }
+
+        // Test hook: the failRenames-th rename from now on fails (a full or worn flash), 0 for none
+        int failRenames = 0;
+
+    private:
+        std::string _root;
+    };
+}
+
+using fs::File;
+
+#endif // HOST_FS_H
@@ -0,0 +1,2 @@
+// Print.h — Print lives in the host Arduino.h
+#include <Arduino.h>
@@ -0,0 +1,38 @@
+// Udp.h — The Arduino UDP interface and IPAddress, as NTPClient uses them
+//
+// Only the interface: a test provides the socket behind it (test_ntp.cpp sends every
+// packet to a stand-in server on the loopback address).
+
+#ifndef HOST_UDP_H
+#define HOST_UDP_H
+
+#include <Arduino.h>
+
+class IPAddress
+{
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address((uint32_t)a << 24 | (uint32_t)b << 16 | (uint32_t)c << 8 | d) {}
+    operator uint32_t() const { return _address; }
+
+private:
+    uint32_t _address;
+};
+
+class UDP
+{
+public:
+    virtual ~UDP() {}
+    virtual uint8_t begin(uint16_t port) = 0;
+    virtual void stop() = 0;
+    virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+    virtual int beginPacket(const char *host, uint16_t port) = 0;
+    virtual int endPacket() = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+    virtual int parsePacket() = 0;
+    virtual int read(unsigned char *buffer, size_t length) = 0;
+    virtual void flush() = 0;
+};
+
+#endif // HOST_UDP_H
@@ -0,0 +1,33 @@
+// WiFiClient.h — A connected socket, shared between copies as in the ESP32 core
+//
+// Tests accept a connection themselves and wrap the descriptor; the last copy (or
+// stop()) closes it. fd() is what HttpStreamer and EventStream send on.
+
+#ifndef HOST_WIFI_CLIENT_H
+#define HOST_WIFI_CLIENT_H
+
+#include <Arduino.h>
+#include <memory>
+#include <unistd.h>
+
+class WiFiClient
+{
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : _socket(std::make_shared<Socket>(fd)) {}
+
+    int fd() const { return _socket ? _socket->fd : -1; }
+    bool connected() const { return (bool)_socket; }
+    void stop() { _socket.reset(); }
+
+private:
+    struct Socket
+    {
+        int fd;
+        explicit Socket(int fd) : fd(fd) {}
+        ~Socket() { ::close(fd); }
+    };
+    std::shared_ptr<Socket> _socket;
+};
+
+#endif // HOST_WIFI_CLIENT_H
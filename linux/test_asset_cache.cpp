@@ -0,0 +1,341 @@
+// test_asset_cache.cpp — What gzip and ETags save on a page load, and the headers they need
+//
+// A browser-like page load (index.html, four logos, github.png, the favicon and the two
+// fonts; the page first, then six connections) at about 250 kB/s per connection,
+// against data/ as it was (no compression, no ETag) and against build_assets.py output
+// (build/assets) first with an empty browser cache, then as a reload sending If-None-Match.
+// The request handling mirrors StreamedFileHandler::handle(). Every file must arrive
+// (or be confirmed by a 304) byte for byte; gzip bodies must carry Vary; a client that
+// refuses gzip gets 406 for them and the PNGs as they are.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <zlib.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TaskScheduler.h"
+#include "HttpStreamer.h"
+#include "AssetCatalog.h"
+#include "check.h"
+
+namespace
+{
+    const char *const PAGE[] = {"/", "/logo1.png", "/logo2.png", "/logo3.png", "/logo4.png", "/github.png",
+                                "/favicon.ico", "/fonts/digital.ttf", "/fonts/digital7monoitalic.ttf"};
+    const int PAGE_FILES = sizeof(PAGE) / sizeof(PAGE[0]);
+    const char SOURCE[] = "../data";
+    const char PREPARED[] = "build/assets";
+
+    std::string root;
+    bool useCatalog;
+    AssetCatalog catalog;
+    HttpStreamer streamer;
+    int listenFd, port;
+    std::atomic<bool> stopLoop(false);
+
+    void sendAll(int fd, const std::string &s)
+    {
+        const char *p = s.data();
+        size_t n = s.size();
+        while (n)
+        {
+            ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+            if (w <= 0)
+                return;
+            p += w;
+            n -= w;
+        }
+    }
+
+    std::string header(const char *request, const char *name)
+    {
+        const char *h = strcasestr(request, name);
+        if (!h)
+            return "";
+        h += strlen(name);
+        return std::string(h, strcspn(h, "\r"));
+    }
+
+    // StreamedFileHandler::handle() with the request parsed by hand
+    void serviceNetwork()
+    {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+            return;
+        char request[1024];
+        int n = 0;
+        struct pollfd p = {fd, POLLIN, 0};
+        while (n < (int)sizeof(request) - 1 && poll(&p, 1, 100) > 0)
+        {
+            int r = recv(fd, request + n, sizeof(request) - 1 - n, 0);
+            if (r <= 0)
+                break;
+            n += r;
+            request[n] = 0;
+            if (strstr(request, "\r\n\r\n"))
+                break;
+        }
+        char uri[128] = "";
+        sscanf(request, "GET %127s", uri);
+        std::string path = strcmp(uri, "/") ? uri : "/index.html";
+
+        fs::FS files(root.c_str());
+        fs::File file = files.open(path.c_str(), "r");
+        if (!file)
+        {
+            sendAll(fd, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            close(fd);
+            return;
+        }
+        const AssetCatalog::Asset *asset = useCatalog ? catalog.find(path.c_str()) : nullptr;
+        std::string vary = asset && asset->gzip ? "Vary: Accept-Encoding\r\n" : "";
+        if (asset && AssetCatalog::matches(header(request, "If-None-Match: ").c_str(), asset->etag))
+        {
+            sendAll(fd, "HTTP/1.1 304 Not Modified\r\n" + vary + "ETag: " + asset->etag +
+                            "\r\nCache-Control: no-cache\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            close(fd);
+            return;
+        }
+        if (asset && asset->gzip && !AssetCatalog::acceptsGzip(header(request, "Accept-Encoding: ").c_str()))
+        {
+            sendAll(fd, "HTTP/1.1 406 Not Acceptable\r\n" + vary + "Content-Length: 0\r\nConnection: close\r\n\r\n");
+            close(fd);
+            return;
+        }
+
+        std::string headers = std::string("HTTP/1.1 200 OK\r\n") + vary + "Content-Type: " + HttpStreamer::contentType(path.c_str()) + "\r\n";
+        if (asset)
+        {
+            headers += std::string("ETag: ") + asset->etag + "\r\nCache-Control: no-cache\r\n";
+            if (asset->gzip)
+                headers += "Content-Encoding: gzip\r\n";
+        }
+        headers += "Content-Length: " + std::to_string(file.size()) + "\r\nConnection: close\r\n\r\n";
+        sendAll(fd, headers);
+        WiFiClient client(fd);
+        CHECK(streamer.start(client, file));
+    }
+
+    void streamStep() { streamer.service(); }
+
+    struct Cached
+    {
+        std::string etag, body;
+    };
+    std::map<std::string, Cached> browserCache;
+    std::mutex cacheLock;
+    std::atomic<long long> wireBytes;
+    std::atomic<int> verified, failures, notModified, refused, missingVary;
+    std::string acceptEncoding;
+
+    std::string gunzip(const std::string &in)
+    {
+        std::string out;
+        z_stream z = {};
+        inflateInit2(&z, 16 + MAX_WBITS);
+        z.next_in = (Bytef *)in.data();
+        z.avail_in = in.size();
+        char buf[16384];
+        int r;
+        do
+        {
+            z.next_out = (Bytef *)buf;
+            z.avail_out = sizeof(buf);
+            r = inflate(&z, Z_NO_FLUSH);
+            out.append(buf, sizeof(buf) - z.avail_out);
+        } while (r == Z_OK);
+        inflateEnd(&z);
+        return out;
+    }
+
+    std::string slurp(const std::string &path)
+    {
+        std::string content;
+        if (FILE *f = fopen(path.c_str(), "rb"))
+        {
+            char buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+                content.append(buf, n);
+            fclose(f);
+        }
+        return content;
+    }
+
+    void fetch(const char *uri)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int receiveBuffer = 8192;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_port = htons(port);
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connect(fd, (sockaddr *)&a, sizeof(a));
+
+        std::string request = std::string("GET ") + uri + " HTTP/1.1\r\nHost: hamclock.local\r\n";
+        if (!acceptEncoding.empty())
+            request += "Accept-Encoding: " + acceptEncoding + "\r\n";
+        {
+            std::lock_guard<std::mutex> lock(cacheLock);
+            auto cached = browserCache.find(uri);
+            if (cached != browserCache.end() && !cached->second.etag.empty())
+                request += "If-None-Match: " + cached->second.etag + "\r\n";
+        }
+        request += "\r\n";
+        send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+        wireBytes += request.size();
+
+        std::string response;
+        char buf[4096];
+        ssize_t r;
+        while ((r = recv(fd, buf, sizeof(buf), 0)) > 0)
+        {
+            response.append(buf, r);
+            std::this_thread::sleep_for(std::chrono::milliseconds(16)); // About 250 kB/s
+        }
+        close(fd);
+        wireBytes += response.size();
+
+        size_t split = response.find("\r\n\r\n");
+        std::string head = response.substr(0, split), body = response.substr(split + 4);
+        std::string expected = slurp(std::string(SOURCE) + (strcmp(uri, "/") ? uri : "/index.html"));
+        bool gzip = head.find("Content-Encoding: gzip") != std::string::npos;
+        if ((gzip || !head.compare(0, 12, "HTTP/1.1 406")) && head.find("Vary: Accept-Encoding") == std::string::npos)
+            missingVary++;
+
+        std::lock_guard<std::mutex> lock(cacheLock);
+        if (!head.compare(0, 12, "HTTP/1.1 406"))
+        {
+            refused++;
+            return;
+        }
+        if (!head.compare(0, 12, "HTTP/1.1 304"))
+        {
+            notModified++;
+            (browserCache[uri].body == expected ? verified : failures)++;
+            return;
+        }
+        if (gzip)
+            body = gunzip(body);
+        std::string etag;
+        size_t e = head.find("ETag: ");
+        if (e != std::string::npos)
+            etag = head.substr(e + 6, head.find("\r\n", e) - e - 6);
+        browserCache[uri] = {etag, body};
+        (body == expected ? verified : failures)++;
+    }
+
+    long long pageLoad(const char *label)
+    {
+        wireBytes = 0;
+        verified = failures = notModified = refused = missingVary = 0;
+        unsigned long start = micros();
+        fetch(PAGE[0]);
+        std::atomic<int> next(1);
+        std::vector<std::thread> connections;
+        for (int i = 0; i < 6; i++)
+            connections.emplace_back([&]
+                                     { int k; while ((k = next++) < PAGE_FILES) fetch(PAGE[k]); });
+        for (std::thread &t : connections)
+            t.join();
+        printf("%-8s %8lld bytes on the wire %6.0f ms, %d/%d files verified (%d by 304), %d refused\n", label,
+               wireBytes.load(), (micros() - start) / 1000.0, verified.load(), PAGE_FILES, notModified.load(), refused.load());
+        CHECK(failures == 0);
+        CHECK(missingVary == 0);
+        return wireBytes;
+    }
+}
+
+int main()
+{
+    setvbuf(stdout, nullptr, _IONBF, 0);
+
+    CHECK(AssetCatalog::acceptsGzip(""));
+    CHECK(AssetCatalog::acceptsGzip("gzip, deflate, br"));
+    CHECK(AssetCatalog::acceptsGzip("br;q=1.0, GZIP;q=0.8"));
+    CHECK(AssetCatalog::acceptsGzip("*"));
+    CHECK(AssetCatalog::acceptsGzip("x-gzip"));
+    CHECK(!AssetCatalog::acceptsGzip("identity"));
+    CHECK(!AssetCatalog::acceptsGzip("deflate, br"));
+    CHECK(!AssetCatalog::acceptsGzip("gzip;q=0, *"));
+    CHECK(!AssetCatalog::acceptsGzip("*;q=0"));
+    CHECK(!AssetCatalog::acceptsGzip("gzip; q=0.000"));
+    CHECK(AssetCatalog::matches("\"ab\"", "\"ab\""));
+    CHECK(AssetCatalog::matches("\"x\", W/\"ab\"", "\"ab\""));
+    CHECK(AssetCatalog::matches("*", "\"ab\""));
+    CHECK(!AssetCatalog::matches("\"abc\"", "\"ab\""));
+    CHECK(!AssetCatalog::matches("", ""));
+
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1, sendBuffer = 5744; // lwIP's default send buffer
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(listenFd, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listenFd, (sockaddr *)&a, sizeof(a));
+    listen(listenFd, 16);
+    socklen_t length = sizeof(a);
+    getsockname(listenFd, (sockaddr *)&a, &length);
+    port = ntohs(a.sin_port);
+    fcntl(listenFd, F_SETFL, O_NONBLOCK);
+
+    TaskScheduler scheduler;
+    CHECK(scheduler.addTask("network", serviceNetwork, 2000, 2) >= 0);
+    CHECK(scheduler.addTask("stream", streamStep, 1000, 2) >= 0);
+    std::thread loop([&]
+                     { while (!stopLoop) scheduler.runOnce(); });
+
+    acceptEncoding = "gzip, deflate";
+    root = SOURCE;
+    useCatalog = false;
+    long long raw = pageLoad("raw");
+
+    root = PREPARED;
+    useCatalog = true;
+    fs::FS prepared(PREPARED);
+    fs::File list = prepared.open("/assets.txt", "r");
+    uint8_t assets = catalog.load(list);
+    printf("catalog: %u assets\n", assets);
+    CHECK(assets > 0 && catalog.find("/index.html") && catalog.find("/index.html")->gzip);
+    CHECK(catalog.find("/logo1.png") && !catalog.find("/logo1.png")->gzip);
+
+    browserCache.clear();
+    long long first = pageLoad("first");
+    CHECK(verified == PAGE_FILES && notModified == 0);
+    long long reload = pageLoad("reload");
+    CHECK(verified == PAGE_FILES && notModified == PAGE_FILES);
+    CHECK(first < raw);
+    CHECK(reload < first / 20);
+
+    // A client that takes no gzip: the compressed files are refused, the rest served
+    acceptEncoding = "identity";
+    browserCache.clear();
+    pageLoad("identity");
+    CHECK(refused > 0 && verified + refused == PAGE_FILES);
+    acceptEncoding = "gzip, deflate";
+
+    stopLoop = true;
+    loop.join();
+
+    // An uploaded logo4.png is forgotten and the saved list no longer validates it
+    CHECK(catalog.forget("/logo4.png"));
+    {
+        fs::File out = prepared.open("/assets.saved", "w"); // assets.txt stays for the next run
+        CHECK(catalog.save(out));
+    }
+    AssetCatalog reloaded;
+    fs::File in = prepared.open("/assets.saved", "r");
+    CHECK(reloaded.load(in) == assets - 1);
+    CHECK(!reloaded.find("/logo4.png"));
+
+    return checkResult();
+}
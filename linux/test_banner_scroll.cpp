@@ -0,0 +1,122 @@
+// test_banner_scroll.cpp — The hardware-scrolled banner screensaver against a pushed banner
+//
+// startBannerScreenSaver() and stepBannerScreenSaver() of main.cpp run on the emulator,
+// which shows GRAM through the VSCRDEF/VSCRSADD state TFT_eSPI sent. At checkpoints up to
+// past the wrap of the text, nothing outside the banner may differ from the screen the
+// screensaver started with, and the banner must match TickerStrip::push() at the matching
+// offset, drawn unscrolled. resetScrollArea() must then put drawing back where it belongs.
+
+#include <vector>
+#include <TFT_eSPI.h>
+#include "HB9IIOrbitronMed10pt.h"
+#include "TickerStrip.h"
+#include "check.h"
+
+TFT_eSPI tft;
+
+namespace
+{
+    // As in main.cpp
+    const uint16_t MARGIN = 8;
+    const int32_t BANNER_X = 5, BANNER_Y = 205, BANNER_W = 310, BANNER_H = 30;
+    const uint16_t FRAME_COLOUR = TFT_GREEN, BANNER_COLOUR = TFT_YELLOW;
+
+    TickerStrip ticker(&tft, BANNER_W, BANNER_H);
+    int32_t column = 0;
+
+    typedef std::vector<uint16_t> Screen;
+
+    Screen readScreen()
+    {
+        Screen s(320 * 240);
+        for (int y = 0; y < 240; y++)
+            for (int x = 0; x < 320; x++)
+                s[y * 320 + x] = tft_emulator.readScreen(x, y);
+        return s;
+    }
+
+    bool inBanner(int x, int y)
+    {
+        return x >= MARGIN && x < 320 - MARGIN && y >= BANNER_Y && y < BANNER_Y + BANNER_H;
+    }
+
+    void start()
+    {
+        tft.fillScreen(TFT_BLACK);
+        tft.drawRoundRect(0, 0, 320, 87, 5, FRAME_COLOUR);
+        tft.drawRoundRect(0, 105, 320, 87, 5, FRAME_COLOUR);
+        tft.setScrollArea(MARGIN, MARGIN);
+        column = 0;
+    }
+
+    void step()
+    {
+        int32_t scrollWidth = tft.width() - 2 * MARGIN;
+        tft.scrollTo(tft.getScrollOffset() + 1);
+        int32_t x = MARGIN + (tft.getScrollOffset() + scrollWidth - 1) % scrollWidth;
+        ticker.pushColumn(column, x, BANNER_Y, BANNER_COLOUR, TFT_BLACK);
+        if (++column >= ticker.textWidth() + scrollWidth)
+            column = 0;
+    }
+}
+
+int main()
+{
+    tft.init();
+    tft.setRotation(1);
+    CHECK(ticker.render("Geneva 18.5C, 62% humidity, wind 12 km/h SW, 1013 hPa, clear sky", &Orbitron_Medium10pt7b));
+    const int32_t scrollWidth = 320 - 2 * MARGIN, cycle = ticker.textWidth() + scrollWidth;
+
+    // Each checkpoint from a fresh start, the steps before it as the screensaver runs them
+    const int32_t checkpoints[] = {1, scrollWidth / 2, scrollWidth, ticker.textWidth(), cycle - 1, cycle,
+                                   cycle + scrollWidth + 37};
+    for (int32_t steps : checkpoints)
+    {
+        start();
+        const Screen before = readScreen();
+        tft_emulator.endFrame();
+        for (int32_t i = 0; i < steps; i++)
+            step();
+        tft_emulator.endFrame();
+        ILI9341_Emulator::emu_stats_t s = tft_emulator.lastFrameStats();
+        const Screen scrolled = readScreen();
+
+        // The frames are the same along a line, scrolling must not show
+        long changedOutside = 0;
+        for (int y = 0; y < 240; y++)
+            for (int x = 0; x < 320; x++)
+                changedOutside += !inBanner(x, y) && scrolled[y * 320 + x] != before[y * 320 + x];
+
+        // Screen column x shows text column x - MARGIN - scrollWidth + steps of this cycle
+        tft.resetScrollArea();
+        tft.fillScreen(TFT_BLACK);
+        ticker.push(MARGIN + scrollWidth - steps % cycle - BANNER_X, BANNER_X, BANNER_Y, BANNER_COLOUR, TFT_BLACK);
+        const Screen pushed = readScreen();
+        long bannerDiffers = 0, lit = 0;
+        for (int y = BANNER_Y; y < BANNER_Y + BANNER_H; y++)
+            for (int x = MARGIN; x < 320 - MARGIN; x++)
+            {
+                bannerDiffers += scrolled[y * 320 + x] != pushed[y * 320 + x];
+                lit += pushed[y * 320 + x] == BANNER_COLOUR;
+            }
+        printf("%5d steps: %u bytes, %u us on the bus, %ld lit, %ld changed outside, %ld differ in the banner\n",
+               (int)steps, s.bytes, ILI9341_Emulator::busMicros(s), lit, changedOutside, bannerDiffers);
+        CHECK(changedOutside == 0);
+        CHECK(bannerDiffers == 0);
+    }
+
+    // Drawing with the scroll area still set lands shifted; after a reset it does not
+    start();
+    for (int i = 0; i < 100; i++)
+        step();
+    tft.fillRect(150, 20, 4, 4, TFT_RED);
+    CHECK(tft_emulator.readScreen(150, 20) != TFT_RED);
+    tft.resetScrollArea();
+    CHECK(tft.getScrollOffset() == 0);
+    tft.fillScreen(TFT_BLACK);
+    tft.fillRect(150, 20, 4, 4, TFT_RED);
+    CHECK(tft_emulator.readScreen(150, 20) == TFT_RED && tft_emulator.readScreen(153, 23) == TFT_RED);
+    CHECK(tft_emulator.readScreen(149, 20) == TFT_BLACK && tft_emulator.readScreen(154, 20) == TFT_BLACK);
+
+    return checkResult();
+}
@@ -0,0 +1,136 @@
+// test_civil_time.cpp — CivilTime against gmtime_r, and what the clock's formatting costs
+//
+// Two million random epochs from 1901 to 2199 must convert and format as gmtime_r and
+// strftime do, and CivilClock must step second by second across month, leap day, century
+// and year ends with a single full conversion. Then one million HH:MM:SS strings are
+// made the ways the sketch used to (localtime_r + strftime into a String, and the
+// NTPClient::getFormattedTime concatenation) and the ways it does now, counting time and
+// operator new calls (none for any of them: both the host and the ESP32 String keep
+// eight characters inline, the gain is time and the libc time zone lock).
+
+#include <chrono>
+#include <new>
+#include <random>
+#include <time.h>
+#include "CivilTime.h"
+#include "check.h"
+
+static size_t allocations = 0;
+
+void *operator new(size_t n)
+{
+    allocations++;
+    if (void *p = malloc(n))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace
+{
+    // What formatLocalTime() did before CivilTime
+    String localtimeFormatted(long epoch)
+    {
+        struct tm t;
+        localtime_r(&epoch, &t);
+        char buf[9];
+        strftime(buf, sizeof(buf), "%H:%M:%S", &t);
+        return String(buf);
+    }
+
+    // NTPClient::getFormattedTime()
+    String concatenatedFormatted(unsigned long raw)
+    {
+        unsigned long hours = (raw % 86400L) / 3600;
+        String hoursStr = hours < 10 ? "0" + String(hours) : String(hours);
+        unsigned long minutes = (raw % 3600) / 60;
+        String minuteStr = minutes < 10 ? "0" + String(minutes) : String(minutes);
+        unsigned long seconds = raw % 60;
+        String secondStr = seconds < 10 ? "0" + String(seconds) : String(seconds);
+        return hoursStr + ":" + minuteStr + ":" + secondStr;
+    }
+}
+
+int main()
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    std::mt19937_64 rng(3);
+    uint32_t wrong = 0, misformatted = 0;
+    for (int i = 0; i < 2000000; i++)
+    {
+        int64_t epoch = (int64_t)(rng() % (298ULL * 365 * 86400)) - 69LL * 365 * 86400;
+        CivilTime t;
+        civilFromEpoch(epoch, t);
+        time_t tt = epoch;
+        struct tm g;
+        gmtime_r(&tt, &g);
+        wrong += t.year != g.tm_year + 1900 || t.month != g.tm_mon + 1 || t.day != g.tm_mday ||
+                 t.hour != g.tm_hour || t.minute != g.tm_min || t.second != g.tm_sec || t.weekday != g.tm_wday;
+        char ours[CIVIL_HMS_SIZE], theirs[CIVIL_HMS_SIZE];
+        formatHMS(t, ours);
+        strftime(theirs, sizeof(theirs), "%H:%M:%S", &g);
+        misformatted += strcmp(ours, theirs) != 0;
+        formatDMY(t, ours);
+        strftime(theirs, sizeof(theirs), "%d:%m:%y", &g);
+        misformatted += strcmp(ours, theirs) != 0;
+        CHECK(daysFromCivil(t.year, t.month, t.day) * 86400 + t.hour * 3600 + t.minute * 60 + t.second == epoch);
+    }
+    CHECK(wrong == 0);
+    CHECK(misformatted == 0);
+
+    // 2000-02-28 (leap century), 2100-02-28 (not leap), 2024-02-28, 2025-12-31
+    const int64_t starts[] = {951782390LL, 4107542390LL, 1709164790LL, 1767225590LL};
+    for (int64_t start : starts)
+    {
+        CivilClock clock;
+        uint32_t differing = 0;
+        for (int64_t epoch = start - 100000; epoch < start + 400000; epoch++)
+        {
+            CivilTime full;
+            civilFromEpoch(epoch, full);
+            differing += memcmp(&clock.at(epoch), &full, sizeof(full)) != 0;
+        }
+        CHECK(differing == 0);
+        CHECK(clock.conversions() == 1);
+    }
+
+    const int N = 1000000;
+    const unsigned long e0 = 1760000000;
+    volatile size_t sink = 0;
+    char buf[CIVIL_HMS_SIZE];
+    using Clock = std::chrono::steady_clock;
+    struct Result
+    {
+        const char *name;
+        double ns, allocations;
+    } results[4];
+    auto measure = [&](int i, const char *name, auto body)
+    {
+        Clock::time_point t0 = Clock::now();
+        size_t a0 = allocations;
+        for (int k = 0; k < N; k++)
+            sink += body(k);
+        results[i] = {name, std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / N,
+                      (double)(allocations - a0) / N};
+    };
+    measure(0, "localtime_r + strftime + String", [&](int k)
+            { return (size_t)localtimeFormatted(e0 + k)[7]; });
+    measure(1, "getFormattedTime concatenation", [&](int k)
+            { return (size_t)concatenatedFormatted(e0 + k)[7]; });
+    CivilClock clock;
+    measure(2, "CivilClock next second", [&](int k)
+            { formatHMS(clock.at(e0 + k), buf); return (size_t)buf[7]; });
+    CivilTime t;
+    measure(3, "civilFromEpoch, random seconds", [&](int k)
+            { civilFromEpoch(e0 + k * 7919LL, t); formatHMS(t, buf); return (size_t)buf[7]; });
+    for (const Result &r : results)
+        printf("%-32s %6.1f ns/call, %.2f allocations/call\n", r.name, r.ns, r.allocations);
+
+    CHECK(results[2].allocations == 0);
+    CHECK(results[3].allocations == 0);
+    CHECK(results[2].ns < results[0].ns);
+    return checkResult();
+}
@@ -0,0 +1,65 @@
+// test_emulator.cpp — The ILI9341 emulator decodes what TFT_eSPI sends and counts it
+
+#include <TFT_eSPI.h>
+#include "HB9IIU7seg42ptNormal.h"
+#include "check.h"
+
+TFT_eSPI tft;
+
+int main()
+{
+    tft.init();
+    tft.setRotation(1);
+    tft_emulator.endFrame();
+
+    // A full screen fill: one window, every pixel once
+    tft.fillScreen(TFT_BLACK);
+    tft_emulator.endFrame();
+    ILI9341_Emulator::emu_stats_t s = tft_emulator.lastFrameStats();
+    printf("fillScreen: %u bytes, %u commands, %u windows, %u px, %u us at SPI_FREQUENCY\n",
+           s.bytes, s.commands, s.windows, s.pixels, ILI9341_Emulator::busMicros(s));
+    CHECK(s.windows == 1);
+    CHECK(s.pixels == 320 * 240);
+    CHECK(s.bytes >= 320 * 240 * 2);
+    CHECK(ILI9341_Emulator::busMicros(s) >= 320UL * 240 * 16 / (SPI_FREQUENCY / 1000000));
+
+    // Sketch coordinates go through MADCTL, rotation 1 is landscape
+    tft.fillRect(10, 20, 5, 5, TFT_RED);
+    tft_emulator.endFrame();
+    s = tft_emulator.lastFrameStats();
+    CHECK(s.pixels == 25 && s.windows == 1);
+    CHECK(tft_emulator.readScreen(10, 20) == TFT_RED);
+    CHECK(tft_emulator.readScreen(14, 24) == TFT_RED);
+    CHECK(tft_emulator.readScreen(9, 20) == TFT_BLACK);
+    CHECK(tft_emulator.readScreen(15, 24) == TFT_BLACK);
+    tft.drawPixel(319, 239, TFT_GREEN);
+    CHECK(tft_emulator.readScreen(319, 239) == TFT_GREEN);
+    CHECK(tft_emulator.readPanel(0, 319) == TFT_GREEN || tft_emulator.readPanel(239, 0) == TFT_GREEN ||
+          tft_emulator.readPanel(0, 0) == TFT_GREEN || tft_emulator.readPanel(239, 319) == TFT_GREEN);
+
+    // A clock digit drawn the library's way, transparent and run by run
+    tft.fillScreen(TFT_BLACK);
+    tft_emulator.endFrame();
+    tft.setFreeFont(&digital_7__mono_42pt7b);
+    tft.setTextColor(TFT_GREEN);
+    tft.drawString("8", 8, 5, 1);
+    tft_emulator.endFrame();
+    s = tft_emulator.lastFrameStats();
+    printf("'8' transparent: %u bytes, %u windows, %u px, %u us\n", s.bytes, s.windows, s.pixels,
+           ILI9341_Emulator::busMicros(s));
+    uint32_t lit = 0;
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            lit += tft_emulator.readScreen(x, y) == TFT_GREEN;
+    CHECK(lit == s.pixels);
+    CHECK(s.windows > 1);
+
+    // Frame counters latch and clear, the totals keep going
+    uint32_t frames = tft_emulator.frames();
+    tft_emulator.endFrame();
+    CHECK(tft_emulator.frames() == frames + 1);
+    CHECK(tft_emulator.lastFrameStats().bytes == 0);
+    CHECK(tft_emulator.totalStats().pixels >= 320 * 240 * 2);
+
+    return checkResult();
+}
@@ -0,0 +1,194 @@
+// test_event_stream.cpp — /events under load: fast, stalled and vanished readers
+//
+// Two pages read every event, one never reads (a frozen tab behind a full receive
+// buffer) and one hangs up; a fifth finds every slot taken and gets 503. Two thousand
+// ticks and a 300-byte banner every twenty go out with service() after each, on lwIP's
+// 5744 byte send buffer. The fast readers must see every tick in order, the other two
+// must be dropped without holding the rest back, and service() must stay cheap. With
+// the virtual clock of host.cpp, heartbeats then find the closed sockets.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EventStream.h"
+#include "check.h"
+
+namespace
+{
+    int listenFd, port;
+    std::atomic<bool> stopReaders(false);
+    EventStream events;
+
+    int connectClient(int receiveBuffer)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (receiveBuffer)
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_port = htons(port);
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connect(fd, (sockaddr *)&a, sizeof(a));
+        const char request[] = "GET /events HTTP/1.1\r\nHost: hamclock\r\n\r\n";
+        send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL);
+        return fd;
+    }
+
+    // The /events handler: take the connection over, or answer 503
+    void acceptClients()
+    {
+        for (;;)
+        {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0)
+                return;
+            char request[256];
+            struct pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, 100) > 0)
+                recv(fd, request, sizeof(request), 0);
+            int sendBuffer = 5744; // lwIP's TCP_SND_BUF
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+            WiFiClient client(fd);
+            if (!events.add(client))
+            {
+                const char busy[] = "HTTP/1.1 503 Busy\r\nContent-Length: 0\r\n\r\n";
+                send(fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL);
+            }
+        }
+    }
+
+    // An EventSource: splits the stream into events, ticks carry a sequence number
+    struct Reader
+    {
+        std::atomic<long> ticks{0}, lastTick{-1};
+        std::atomic<bool> ordered{true}, headers{false};
+    };
+
+    void readEvents(int fd, Reader *r)
+    {
+        std::string stream;
+        char buf[2048];
+        while (!stopReaders)
+        {
+            struct pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, 20) <= 0)
+                continue;
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0)
+                break;
+            stream.append(buf, n);
+            if (!r->headers && stream.find("text/event-stream") != std::string::npos)
+                r->headers = true;
+            size_t end;
+            while ((end = stream.find("\n\n")) != std::string::npos)
+            {
+                std::string event = stream.substr(0, end);
+                stream.erase(0, end + 2);
+                if (event.compare(0, 11, "event: time"))
+                    continue;
+                long tick = atol(event.c_str() + event.find("data: ") + 6);
+                if (r->lastTick >= 0 && tick != r->lastTick + 1)
+                    r->ordered = false;
+                r->lastTick = tick;
+                r->ticks++;
+            }
+        }
+        close(fd);
+    }
+}
+
+int main()
+{
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listenFd, (sockaddr *)&a, sizeof(a));
+    listen(listenFd, 16);
+    socklen_t length = sizeof(a);
+    getsockname(listenFd, (sockaddr *)&a, &length);
+    port = ntohs(a.sin_port);
+    fcntl(listenFd, F_SETFL, O_NONBLOCK);
+
+    Reader fast[2];
+    std::vector<std::thread> readers;
+    for (Reader &r : fast)
+        readers.emplace_back(readEvents, connectClient(0), &r);
+    int stalled = connectClient(4096);
+    int quitter = connectClient(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    acceptClients();
+    CHECK(events.clients() == 4);
+
+    int extra = connectClient(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    acceptClients();
+    char reply[128] = "";
+    recv(extra, reply, sizeof(reply) - 1, 0);
+    CHECK(strstr(reply, "503") != nullptr);
+    close(extra);
+
+    const long TICKS = 2000;
+    std::string banner(300, 'W');
+    double totalUs = 0, worstUs = 0;
+    for (long tick = 0; tick < TICKS; tick++)
+    {
+        char data[32];
+        snprintf(data, sizeof(data), "%ld", tick);
+        events.broadcast("time", data);
+        if (tick % 20 == 0)
+            events.broadcast("banner", banner.c_str());
+        if (tick == 100)
+            close(quitter);
+        auto start = std::chrono::steady_clock::now();
+        events.service();
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        totalUs += us;
+        worstUs = std::max(worstUs, us);
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    for (int i = 0; i < 50; i++)
+    {
+        events.service();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    const EventStream::Stats &st = events.stats();
+    printf("service(): %.1f us average, %.1f us worst over %ld calls, %u clients left\n", totalUs / TICKS, worstUs, TICKS,
+           events.clients());
+    printf("accepted %u, dropped %u, %u events, %llu bytes; %zu bytes for all slots\n", st.accepted, st.dropped, st.events,
+           (unsigned long long)st.bytes, sizeof(events));
+    for (Reader &r : fast)
+    {
+        CHECK(r.headers);
+        CHECK(r.ticks == TICKS && r.lastTick == TICKS - 1);
+        CHECK(r.ordered);
+    }
+    CHECK(events.clients() == 2); // The stalled and the closed one are gone
+    CHECK(st.accepted == 4 && st.dropped == 2);
+    close(stalled);
+
+    // Idle: heartbeats keep the open ones until they close, then drop them
+    stopReaders = true;
+    for (std::thread &t : readers)
+        t.join();
+    for (int i = 0; i < 3; i++)
+    {
+        delay(EventStream::HEARTBEAT_MS);
+        events.service();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(events.clients() == 0);
+    close(listenFd);
+
+    return checkResult();
+}
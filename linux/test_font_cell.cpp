@@ -0,0 +1,97 @@
+// test_font_cell.cpp — Opaque free font cells, the clock's path when the glyph cache is
+// unavailable: one pass per character, neighbours left intact
+
+#include <TFT_eSPI.h>
+#include "HB9IIU7seg42ptNormal.h"
+#include "HB9IIU7seg42ptItalic.h"
+#include "check.h"
+
+TFT_eSPI tft;
+
+// Character offsets of displayTime() in main.cpp, "HH:MM:SS"
+const int POSITIONS[8] = {0, 48, 78, 108, 156, 186, 216, 264};
+
+static uint16_t screen[240][320];
+
+static void grab()
+{
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            screen[y][x] = tft_emulator.readScreen(x, y);
+}
+
+static int differences()
+{
+    int n = 0;
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            n += screen[y][x] != tft_emulator.readScreen(x, y);
+    return n;
+}
+
+// What displayTime() does for one character without the glyph cache
+static void drawOpaque(char c, int x, int y)
+{
+    tft.setFreeFontCell(c == ':' ? ":" : "0123456789");
+    tft.setTextColor(TFT_GREEN, TFT_BLACK);
+    char glyph[2] = {c, 0};
+    tft.drawString(glyph, x, y, 1);
+}
+
+int main()
+{
+    tft.init();
+    tft.setRotation(1);
+
+    for (const GFXfont *font : {&digital_7__mono_42pt7b, &digital_7_monoitalic42pt7b})
+    {
+        // Each character over an '8' in one window, as if drawn on a clear screen
+        const char *chars = "0123456789:";
+        int bad = 0;
+        for (int k = 0; k < 11; k++)
+        {
+            char glyph[2] = {chars[k], 0};
+            tft.fillScreen(TFT_BLACK);
+            tft.setFreeFont(font);
+            tft.setTextColor(TFT_GREEN);
+            tft.drawString(glyph, 100, 50, 1);
+            grab();
+            tft.fillScreen(TFT_BLACK);
+            tft.drawString(chars[k] == ':' ? ":" : "8", 100, 50, 1);
+            tft_emulator.endFrame();
+            drawOpaque(chars[k], 100, 50);
+            tft_emulator.endFrame();
+            CHECK(tft_emulator.lastFrameStats().windows == 1);
+            bad += differences();
+        }
+        CHECK(bad == 0);
+
+        // Whole clock lines, then every digit changed in place
+        const char *times[] = {"88:88:88", "20:19:59", "01:11:10"};
+        for (const char *time : times)
+        {
+            tft.fillScreen(TFT_BLACK);
+            tft.setFreeFont(font);
+            tft.setTextColor(TFT_GREEN);
+            for (int i = 0; i < 8; i++)
+            {
+                char glyph[2] = {time[i], 0};
+                tft.drawString(glyph, 8 + POSITIONS[i], 5, 1);
+            }
+            grab();
+
+            tft.fillScreen(TFT_BLACK);
+            tft.setFreeFont(font);
+            for (int i = 0; i < 8; i++)
+                drawOpaque("88:88:88"[i], 8 + POSITIONS[i], 5);
+            for (int i = 0; i < 8; i++)
+                drawOpaque(time[i], 8 + POSITIONS[i], 5);
+            int n = differences();
+            if (n)
+                printf("  %s: %d pixels differ from the font\n", time, n);
+            CHECK(n == 0);
+        }
+    }
+
+    return checkResult();
+}
@@ -0,0 +1,104 @@
+// test_glyph_cache.cpp — Cached clock glyphs draw what drawString() draws, and a whole
+// clock line drawn from the cache leaves every neighbouring character intact
+
+#include <TFT_eSPI.h>
+#include "HB9IIU7seg42ptNormal.h"
+#include "HB9IIU7seg42ptItalic.h"
+#include "ClockGlyphCache.h"
+#include "check.h"
+
+TFT_eSPI tft;
+ClockGlyphCache cache(&tft);
+
+// Character offsets of displayTime() in main.cpp, "HH:MM:SS"
+const int POSITIONS[8] = {0, 48, 78, 108, 156, 186, 216, 264};
+
+static uint16_t screen[240][320];
+
+static void grab()
+{
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            screen[y][x] = tft_emulator.readScreen(x, y);
+}
+
+static int differences()
+{
+    int n = 0;
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            n += screen[y][x] != tft_emulator.readScreen(x, y);
+    return n;
+}
+
+// The font's own transparent rendering of a time string at the clock positions
+static void reference(const GFXfont *font, const char *time, int x, int y)
+{
+    tft.fillScreen(TFT_BLACK);
+    tft.setFreeFont(font);
+    tft.setTextColor(TFT_GREEN);
+    for (int i = 0; i < 8; i++)
+    {
+        char glyph[2] = {time[i], 0};
+        tft.drawString(glyph, x + POSITIONS[i], y, 1);
+    }
+    grab();
+}
+
+int main()
+{
+    tft.init();
+    tft.setRotation(1);
+
+    for (const GFXfont *font : {&digital_7__mono_42pt7b, &digital_7_monoitalic42pt7b})
+    {
+        CHECK(cache.build(font));
+        const ClockGlyphCache::Cell &digit = cache.cell('0'), &colon = cache.cell(':');
+        printf("%s: digit cell %d,%d %dx%d, colon cell %d,%d %dx%d\n", font == &digital_7__mono_42pt7b ? "normal" : "italic",
+               digit.x, digit.y, digit.w, digit.h, colon.x, colon.y, colon.w, colon.h);
+
+        // Neighbouring cells never overlap at the clock positions
+        for (int i = 0; i + 1 < 8; i++)
+        {
+            const ClockGlyphCache::Cell &a = cache.cell("00:00:00"[i]), &b = cache.cell("00:00:00"[i + 1]);
+            CHECK(POSITIONS[i] + a.x + a.w <= POSITIONS[i + 1] + b.x);
+        }
+
+        // One cached character over another equals drawString() on a clear screen
+        const char *chars = "0123456789:";
+        int bad = 0;
+        for (int k = 0; k < 11; k++)
+        {
+            tft.fillScreen(TFT_BLACK);
+            tft.setFreeFont(font);
+            tft.setTextColor(TFT_GREEN);
+            char glyph[2] = {chars[k], 0};
+            tft.drawString(glyph, 100, 50, 1);
+            grab();
+            tft.fillScreen(TFT_BLACK);
+            tft.drawString(chars[k] == ':' ? ":" : "8", 100, 50, 1);
+            tft_emulator.endFrame();
+            CHECK(cache.drawChar(chars[k], 100, 50, TFT_GREEN, TFT_BLACK));
+            tft_emulator.endFrame();
+            bad += differences();
+            CHECK(tft_emulator.lastFrameStats().windows == 1);
+        }
+        CHECK(bad == 0);
+
+        // A full redraw of both clock lines, left to right as displayTime() does it
+        const char *times[] = {"88:88:88", "20:19:59", "01:11:10", "23:59:59"};
+        for (const char *time : times)
+        {
+            reference(font, time, 8, 5);
+            tft.fillScreen(TFT_BLACK);
+            for (int i = 0; i < 8; i++)
+                cache.drawChar(time[i], 8 + POSITIONS[i], 5, TFT_GREEN, TFT_BLACK);
+            int n = differences();
+            if (n)
+                printf("  %s: %d pixels differ from the font\n", time, n);
+            CHECK(n == 0);
+        }
+    }
+
+    return checkResult();
+}
@@ -0,0 +1,72 @@
+// test_heap_monitor.cpp — HeapMonitor slots, lows and fragmentation from a scripted heap
+
+#include "HeapMonitor.h"
+#include "check.h"
+
+namespace
+{
+    HeapMonitor::Sample heap;
+
+    void sampler(HeapMonitor::Sample &sample) { sample = heap; }
+
+    // The heap at second k: free memory saws, the largest block shrinks over time
+    HeapMonitor::Sample scripted(uint32_t k)
+    {
+        return {100000 - (k % 10) * 100, 60000 - (k % 7) * 1000 - k};
+    }
+}
+
+int main()
+{
+    const uint32_t INTERVAL_S = 10, SAMPLES = 1000;
+    HeapMonitor monitor(INTERVAL_S, sampler);
+    CHECK(monitor.historyCount() == 0);
+    CHECK(monitor.lowest().freeBytes == UINT32_MAX); // Nothing sampled yet
+
+    for (uint32_t k = 0; k < SAMPLES; k++)
+    {
+        heap = scripted(k);
+        monitor.sample();
+        if (k == INTERVAL_S - 2)
+            CHECK(monitor.historyCount() == 0); // A slot completes after its last second
+        if (k == INTERVAL_S - 1)
+            CHECK(monitor.historyCount() == 1);
+    }
+    CHECK(monitor.samples() == SAMPLES);
+    CHECK(monitor.historyCount() == HeapMonitor::HISTORY);
+
+    // The newest 96 of the 100 slots, oldest first, each the lows of its ten seconds
+    uint32_t wrong = 0;
+    const uint32_t firstSlot = SAMPLES / INTERVAL_S - HeapMonitor::HISTORY;
+    for (uint8_t i = 0; i < HeapMonitor::HISTORY; i++)
+    {
+        HeapMonitor::Sample low = {UINT32_MAX, UINT32_MAX};
+        for (uint32_t k = (firstSlot + i) * INTERVAL_S; k < (firstSlot + i + 1) * INTERVAL_S; k++)
+        {
+            low.freeBytes = min(low.freeBytes, scripted(k).freeBytes);
+            low.largestBlock = min(low.largestBlock, scripted(k).largestBlock);
+        }
+        wrong += monitor.history(i).freeBytes != low.freeBytes || monitor.history(i).largestBlock != low.largestBlock;
+    }
+    CHECK(wrong == 0);
+    CHECK(monitor.history(0).largestBlock > monitor.history(HeapMonitor::HISTORY - 1).largestBlock);
+
+    HeapMonitor::Sample last = scripted(SAMPLES - 1);
+    CHECK(monitor.current().freeBytes == last.freeBytes && monitor.current().largestBlock == last.largestBlock);
+    CHECK(monitor.lowest().freeBytes == 99100);
+    CHECK(monitor.lowest().largestBlock == monitor.history(HeapMonitor::HISTORY - 1).largestBlock);
+    CHECK(monitor.fragmentation() == (uint8_t)((uint64_t)(last.freeBytes - last.largestBlock) * 100 / last.freeBytes));
+    printf("last slot %u / %u, lowest %u / %u, fragmentation %u%%\n",
+           monitor.history(HeapMonitor::HISTORY - 1).freeBytes, monitor.history(HeapMonitor::HISTORY - 1).largestBlock,
+           monitor.lowest().freeBytes, monitor.lowest().largestBlock, monitor.fragmentation());
+
+    // One block holding all free memory is no fragmentation, an empty heap neither
+    heap = {50000, 50000};
+    monitor.sample();
+    CHECK(monitor.fragmentation() == 0);
+    heap = {0, 0};
+    monitor.sample();
+    CHECK(monitor.fragmentation() == 0);
+
+    return checkResult();
+}
@@ -0,0 +1,251 @@
+// test_http_streamer.cpp — Slow web clients against the clock: streamFile() versus HttpStreamer
+//
+// Eight clients on loopback fetch index.html and the logos from ../data, each reading
+// about 250 kB/s, while a TaskScheduler runs the clock (every 250 ms), the banner, a
+// network task that accepts and answers one request per call, and the streamer. The
+// listening socket has lwIP's 5744 byte send buffer. First the network task sends each
+// body whole before returning, as WebServer::streamFile() does, then it hands the
+// connection to an HttpStreamer. Every body must arrive intact both ways; the worst gap
+// between two clock ticks must shrink to about the clock's own period when streamed.
+// `./build/test_http_streamer blocking|streamed [clients] [seconds]` runs one mode only.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TaskScheduler.h"
+#include "HttpStreamer.h"
+#include "check.h"
+
+namespace
+{
+    const char *const FILES[] = {"/index.html", "/logo1.png", "/logo2.png", "/logo5.png", "/favicon.ico", "/github.png"};
+    const size_t FILE_COUNT = sizeof(FILES) / sizeof(FILES[0]);
+    const char DATA[] = "../data";
+    const uint32_t CLOCK_PERIOD_US = 250000;
+
+    std::vector<std::string> contents;
+    fs::FS data(DATA);
+    HttpStreamer streamer;
+    int listenFd, port;
+    bool streamed;
+    std::atomic<bool> stopClients;
+    std::atomic<long> ok, bad, busy;
+    std::atomic<long long> bodyBytes;
+    unsigned long lastTickUs, worstGapUs;
+
+    void sendAll(int fd, const char *p, size_t n)
+    {
+        while (n)
+        {
+            ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+            if (w <= 0)
+                return;
+            p += w;
+            n -= w;
+        }
+    }
+
+    // One request per call, read whole as WebServer does (it arrives in one piece here)
+    void serviceNetwork()
+    {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+            return;
+        char request[512];
+        int n = 0;
+        struct pollfd p = {fd, POLLIN, 0};
+        while (n < (int)sizeof(request) - 1 && poll(&p, 1, 100) > 0)
+        {
+            int r = recv(fd, request + n, sizeof(request) - 1 - n, 0);
+            if (r <= 0)
+                break;
+            n += r;
+            request[n] = 0;
+            if (strstr(request, "\r\n\r\n"))
+                break;
+        }
+        char path[128] = "";
+        sscanf(request, "GET %127s", path);
+
+        fs::File file = data.open(path, "r");
+        const char *refusal = nullptr;
+        if (!file)
+            refusal = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        else if (streamed && !streamer.hasRoom())
+            refusal = "HTTP/1.1 503 Busy\r\nRetry-After: 1\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        if (refusal)
+        {
+            sendAll(fd, refusal, strlen(refusal));
+            close(fd);
+            return;
+        }
+
+        char headers[256];
+        snprintf(headers, sizeof(headers), "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                 HttpStreamer::contentType(path), file.size());
+        sendAll(fd, headers, strlen(headers));
+        if (streamed)
+        {
+            WiFiClient client(fd);
+            CHECK(streamer.start(client, file));
+            return;
+        }
+        uint8_t buf[1460];
+        size_t r;
+        while ((r = file.read(buf, sizeof(buf))) > 0)
+            sendAll(fd, (const char *)buf, r);
+        close(fd);
+    }
+
+    void streamStep() { streamer.service(); }
+    void bannerStep() {}
+    void clockTick()
+    {
+        unsigned long now = micros();
+        if (lastTickUs && now - lastTickUs > worstGapUs)
+            worstGapUs = now - lastTickUs;
+        lastTickUs = now;
+    }
+
+    // A browser on a slow link: about 4 kB every 16 ms
+    void client(unsigned id)
+    {
+        std::string response;
+        char buf[4096];
+        for (unsigned k = id; !stopClients; k++)
+        {
+            size_t f = k % FILE_COUNT;
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            int receiveBuffer = 8192;
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+            sockaddr_in a = {};
+            a.sin_family = AF_INET;
+            a.sin_port = htons(port);
+            a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (connect(fd, (sockaddr *)&a, sizeof(a)) < 0)
+            {
+                close(fd);
+                continue;
+            }
+            std::string request = std::string("GET ") + FILES[f] + " HTTP/1.1\r\nHost: hamclock\r\n\r\n";
+            send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+            response.clear();
+            ssize_t r;
+            while ((r = recv(fd, buf, sizeof(buf), 0)) > 0)
+            {
+                response.append(buf, r);
+                std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            }
+            close(fd);
+
+            size_t body = response.find("\r\n\r\n");
+            if (body != std::string::npos && !response.compare(0, 12, "HTTP/1.1 503"))
+            {
+                busy++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+            else if (body != std::string::npos && !response.compare(0, 12, "HTTP/1.1 200") && !response.compare(body + 4, std::string::npos, contents[f]))
+            {
+                ok++;
+                bodyBytes += response.size() - body - 4;
+            }
+            else
+                bad++;
+        }
+    }
+
+    // Worst clock gap in ms while the clients were loading
+    unsigned long run(bool streamedMode, int clients, int seconds)
+    {
+        streamed = streamedMode;
+        stopClients = false;
+        ok = bad = busy = 0;
+        bodyBytes = 0;
+        lastTickUs = worstGapUs = 0;
+
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1, sendBuffer = 5744; // lwIP's default send buffer
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        setsockopt(listenFd, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listenFd, (sockaddr *)&a, sizeof(a));
+        listen(listenFd, 16);
+        socklen_t length = sizeof(a);
+        getsockname(listenFd, (sockaddr *)&a, &length);
+        port = ntohs(a.sin_port);
+        fcntl(listenFd, F_SETFL, O_NONBLOCK);
+
+        TaskScheduler scheduler;
+        int8_t clockTask = scheduler.addTask("clock", clockTick, CLOCK_PERIOD_US, 4, 20000);
+        int8_t bannerTask = scheduler.addTask("banner", bannerStep, 5000, 3);
+        int8_t networkTask = scheduler.addTask("network", serviceNetwork, 2000, 2, 20000);
+        int8_t streamTask = scheduler.addTask("stream", streamStep, 1000, 2);
+        CHECK(clockTask >= 0 && bannerTask >= 0 && networkTask >= 0 && streamTask >= 0);
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < clients; i++)
+            threads.emplace_back(client, i);
+        unsigned long start = millis();
+        while (millis() - start < (unsigned long)seconds * 1000)
+            scheduler.runOnce();
+        unsigned long worstMs = worstGapUs / 1000; // Under load only
+        TaskScheduler::TaskStats clock = scheduler.taskStats(clockTask), banner = scheduler.taskStats(bannerTask);
+
+        stopClients = true;
+        std::atomic<bool> joined(false);
+        std::thread joiner([&]
+                           { for (std::thread &t : threads) t.join(); joined = true; });
+        while (!joined || streamer.active())
+            scheduler.runOnce();
+        joiner.join();
+        close(listenFd);
+
+        printf("%-8s %d clients: %ld ok, %ld bad, %ld busy, %.0f kB/s | clock worst gap %lu ms, %u misses | "
+               "banner worst start %u us | network longest run %u us | stream longest run %u us\n",
+               streamed ? "streamed" : "blocking", clients, ok.load(), bad.load(), busy.load(), bodyBytes / 1024.0 / seconds,
+               worstMs, clock.misses, banner.maxStartDelayUs, scheduler.taskStats(networkTask).maxRunUs,
+               scheduler.taskStats(streamTask).maxRunUs);
+        CHECK(ok > 0);
+        CHECK(bad == 0);
+        return worstMs;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    setvbuf(stdout, nullptr, _IONBF, 0);
+    for (const char *f : FILES)
+    {
+        fs::File file = data.open(f, "r");
+        CHECK(file);
+        std::string c(file.size(), '\0');
+        file.read((uint8_t *)&c[0], c.size());
+        contents.push_back(c);
+    }
+
+    int clients = argc > 2 ? atoi(argv[2]) : 8;
+    int seconds = argc > 3 ? atoi(argv[3]) : 10;
+    if (argc > 1)
+    {
+        run(!strcmp(argv[1], "streamed"), clients, seconds);
+        return checkResult();
+    }
+
+    unsigned long blocking = run(false, clients, seconds);
+    unsigned long streamedGap = run(true, clients, seconds);
+    const HttpStreamer::Stats &st = streamer.stats();
+    printf("streamer: %u started, %u completed, %u dropped, %llu bytes\n", st.started, st.completed, st.dropped,
+           (unsigned long long)st.bytes);
+    CHECK(st.completed == st.started && st.dropped == 0);
+    CHECK(streamedGap < blocking / 2);
+    CHECK(streamedGap < CLOCK_PERIOD_US / 1000 + 50);
+    return checkResult();
+}
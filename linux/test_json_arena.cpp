@@ -0,0 +1,148 @@
+// test_json_arena.cpp — Request handler documents built in a JsonArena never touch the heap
+//
+// The documents are the ones main.cpp builds: a /saveall body parsed, the /heap reply
+// with its full history. Each must serialize exactly as with the default allocator,
+// make no malloc() call while it fits, and leave the arena empty for the next request.
+// Nested documents, growing strings and overflow to the heap are checked on their own.
+// ArduinoJson's memory pools are 4 kB on a 64-bit host (256 slots of 16 bytes) against
+// 1 kB on the ESP32 (128 of 8), so the arenas here are larger than the firmware's.
+
+#include <ArduinoJson.h>
+#include "JsonArena.h"
+#include "check.h"
+
+// Every malloc() is counted, except under AddressSanitizer which has its own
+#if !defined(__SANITIZE_ADDRESS__)
+const bool COUNTING = true;
+extern "C"
+{
+    void *__libc_malloc(size_t);
+    void *__libc_realloc(void *, size_t);
+    static size_t mallocs = 0;
+    void *malloc(size_t n)
+    {
+        mallocs++;
+        return __libc_malloc(n);
+    }
+    void *realloc(void *p, size_t n)
+    {
+        mallocs++;
+        return __libc_realloc(p, n);
+    }
+}
+#else
+const bool COUNTING = false;
+static size_t mallocs = 0;
+#endif
+
+namespace
+{
+    const char SAVEALL[] = "{\"latitude\":46.5197,\"longitude\":6.6323,\"localTimeLabel\":\"Lausanne\","
+                           "\"utcTimeLabel\":\"UTC\",\"italicClockFonts\":true,\"doubleFrame\":false,"
+                           "\"bannerSpeed\":20,\"screenSaverTimeout\":600000,\"bannerScreenSaver\":true,"
+                           "\"timeZone\":\"CET-1CEST,M3.5.0,M10.5.0/3\"}";
+
+    void buildHeap(JsonDocument &doc)
+    {
+        doc["freeBytes"] = 180000;
+        doc["largestBlock"] = 110000;
+        doc["fragmentationPct"] = 38;
+        doc["intervalS"] = 900;
+        JsonArray history = doc["history"].to<JsonArray>();
+        for (int i = 0; i < 96; i++)
+        {
+            JsonArray slot = history.add<JsonArray>();
+            slot.add(180000 - i);
+            slot.add(110000 - i);
+        }
+    }
+
+    template <class Build>
+    void compare(const char *name, Build build)
+    {
+        static JsonArena<9216> arena;
+        static char expected[4096], actual[4096];
+        JsonDocument reference;
+        build(reference);
+        serializeJson(reference, expected, sizeof(expected));
+
+        size_t before = mallocs;
+        {
+            JsonDocument doc(&arena);
+            build(doc);
+            CHECK(!doc.overflowed());
+            serializeJson(doc, actual, sizeof(actual));
+        }
+        size_t heapCalls = mallocs - before;
+        printf("%-8s %5zu bytes of JSON, arena peak %4zu bytes, %zu heap calls, %u fallbacks\n",
+               name, strlen(actual), arena.peak(), heapCalls, arena.fallbacks());
+        CHECK(!strcmp(expected, actual));
+        CHECK(heapCalls == 0);
+        CHECK(arena.fallbacks() == 0);
+    }
+}
+
+int main()
+{
+    compare("/saveall", [](JsonDocument &doc)
+            { CHECK(!deserializeJson(doc, SAVEALL)); });
+    compare("/heap", buildHeap);
+
+    // The second document is built while the first is alive, then both go
+    {
+        JsonArena<12288> arena;
+        JsonDocument *outer = new JsonDocument(&arena);
+        (*outer)["a"] = "outer";
+        {
+            JsonDocument inner(&arena);
+            CHECK(!deserializeJson(inner, SAVEALL));
+            CHECK(inner["bannerSpeed"] == 20);
+            CHECK((*outer)["a"] == "outer");
+        }
+        (*outer)["b"] = 2;
+        CHECK((*outer)["a"] == "outer" && (*outer)["b"] == 2);
+        delete outer;
+        CHECK(arena.fallbacks() == 0);
+
+        // Empty again: the whole buffer is there for the next request
+        uint8_t *first = (uint8_t *)arena.allocate(arena.capacity() - 64);
+        CHECK(first != nullptr);
+        CHECK(arena.fallbacks() == 0);
+        arena.deallocate(first);
+    }
+
+    // The newest block grows in place, an older one moves and keeps its bytes
+    {
+        JsonArena<256> arena;
+        char *a = (char *)arena.allocate(16);
+        strcpy(a, "fifteen chars..");
+        CHECK(arena.reallocate(a, 64) == a);
+        char *b = (char *)arena.allocate(8);
+        char *moved = (char *)arena.reallocate(a, 80);
+        CHECK(moved != a && !strcmp(moved, "fifteen chars.."));
+        arena.deallocate(b);
+        arena.deallocate(moved);
+        CHECK(arena.fallbacks() == 0);
+
+        // Too large for what is left: from the heap, and freed there
+        void *small = arena.allocate(100);
+        size_t before = mallocs;
+        void *large = arena.allocate(200);
+        CHECK(large != nullptr && arena.fallbacks() == 1);
+        CHECK(!COUNTING || mallocs == before + 1);
+        arena.deallocate(large);
+        arena.deallocate(small);
+    }
+
+    // A document larger than the arena still builds, the rest comes from the heap
+    {
+        JsonArena<512> arena;
+        JsonDocument doc(&arena);
+        buildHeap(doc);
+        CHECK(!doc.overflowed());
+        CHECK(doc["history"][95][1] == 110000 - 95);
+        CHECK(arena.fallbacks() > 0);
+    }
+
+    return checkResult();
+}
@@ -0,0 +1,89 @@
+// test_mailbox.cpp — SpscMailbox between a BackgroundTask thread and the main thread
+//
+// The background thread plays the network task: it takes requests and publishes large
+// reports, the main thread plays loop(). Every report must arrive whole and in order.
+// Build with `make SANITIZE=thread run-mailbox` to have ThreadSanitizer watch the slots.
+
+#include <atomic>
+#include <sched.h>
+#include "SpscMailbox.h"
+#include "BackgroundTask.h"
+#include "check.h"
+
+struct Report
+{
+    uint32_t sequence;
+    char text[320]; // As large as a weather banner, so a torn copy would show
+};
+
+const uint32_t REPORTS = 100000;
+
+SpscMailbox<Report, 2> reports; // One usable slot, the tightest hand-over
+SpscMailbox<uint32_t, 4> requests;
+std::atomic<bool> producerDone(false);
+std::atomic<uint32_t> requestsSeen(0);
+
+void producer(void *)
+{
+    uint32_t sequence = 0, request;
+    while (sequence < REPORTS)
+    {
+        while (requests.pop(request))
+            requestsSeen++;
+        Report r;
+        r.sequence = sequence;
+        memset(r.text, 'a' + sequence % 26, sizeof(r.text) - 1);
+        r.text[sizeof(r.text) - 1] = 0;
+        if (reports.push(r))
+            sequence++;
+        else
+            sched_yield();
+    }
+    producerDone = true;
+}
+
+int main()
+{
+    BackgroundTask network;
+    CHECK(network.start("network", producer, nullptr, 8192, 1, 0));
+    CHECK(network.running());
+    CHECK(!network.start("network", producer, nullptr, 8192, 1, 0)); // Once only
+
+    uint32_t expected = 0, outOfOrder = 0, torn = 0, requestsDropped = 0;
+    Report r;
+    while (!producerDone || !reports.empty())
+    {
+        if (reports.pop(r))
+        {
+            outOfOrder += r.sequence != expected;
+            expected = r.sequence + 1;
+            for (size_t i = 0; i < sizeof(r.text) - 1; i++)
+                if (r.text[i] != (char)('a' + r.sequence % 26))
+                {
+                    torn++;
+                    break;
+                }
+            torn += r.text[sizeof(r.text) - 1] != 0;
+        }
+        if (!requests.push(expected))
+            requestsDropped++;
+        sched_yield();
+    }
+
+    printf("%u reports received, %u out of order, %u torn; %u requests taken, %u dropped while full\n",
+           expected, outOfOrder, torn, requestsSeen.load(), requestsDropped);
+    CHECK(expected == REPORTS);
+    CHECK(outOfOrder == 0);
+    CHECK(torn == 0);
+    CHECK(requestsSeen > 0);
+
+    // Full and empty edges on one thread
+    SpscMailbox<int, 3> box;
+    int v;
+    CHECK(box.empty() && !box.pop(v));
+    CHECK(box.push(1) && box.push(2) && !box.push(3));
+    CHECK(box.pop(v) && v == 1 && box.push(3));
+    CHECK(box.pop(v) && v == 2 && box.pop(v) && v == 3 && !box.pop(v));
+
+    return checkResult();
+}
@@ -0,0 +1,255 @@
+// test_ntp.cpp — NTPClient against a stand-in NTP server on the loopback address
+//
+// The server thread answers with its own clock SERVER_SKEW ms ahead of CLOCK_REALTIME and
+// holds the request and the reply for the injected up and down latencies. The client
+// must land within half the latency asymmetry of the server's time (what any four
+// timestamp exchange can do), never block in update() or pollUpdate(), drop a reply that
+// does not echo its request, and hold off after a timeout. Uses the real clock.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <NTPClient.h>
+#include "check.h"
+
+namespace
+{
+    const uint16_t SERVER_PORT = 12123;
+    const uint16_t CLIENT_PORT = 12124;
+    const int64_t SERVER_SKEW = 123456; // ms the server's clock is ahead
+
+    std::atomic<int> upMs(0), downMs(0), processingMs(0);
+    std::atomic<bool> stale(false), mute(false);
+
+    sockaddr_in loopback(uint16_t port)
+    {
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_port = htons(port);
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return a;
+    }
+
+    int64_t realMs()
+    {
+        timespec t;
+        clock_gettime(CLOCK_REALTIME, &t);
+        return t.tv_sec * 1000LL + t.tv_nsec / 1000000;
+    }
+
+    void sleepMs(int ms)
+    {
+        if (ms > 0)
+        {
+            timespec t = {ms / 1000, (ms % 1000) * 1000000L};
+            nanosleep(&t, nullptr);
+        }
+    }
+
+    void putTimestamp(uint8_t *p, int64_t unixMs)
+    {
+        uint64_t seconds = unixMs / 1000 + 2208988800ULL;
+        uint64_t fraction = ((uint64_t)(unixMs % 1000) << 32) / 1000;
+        for (int i = 0; i < 4; i++)
+        {
+            p[i] = seconds >> (24 - 8 * i);
+            p[4 + i] = fraction >> (24 - 8 * i);
+        }
+    }
+
+    void server()
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in a = loopback(SERVER_PORT);
+        bind(fd, (sockaddr *)&a, sizeof(a));
+        for (;;)
+        {
+            uint8_t request[48];
+            sockaddr_in from = {};
+            socklen_t fromLength = sizeof(from);
+            if (recvfrom(fd, request, sizeof(request), 0, (sockaddr *)&from, &fromLength) != 48 || mute)
+                continue;
+            sleepMs(upMs);
+            int64_t t2 = realMs() + SERVER_SKEW;
+            sleepMs(processingMs);
+            int64_t t3 = realMs() + SERVER_SKEW;
+
+            uint8_t reply[48] = {0};
+            reply[0] = 0x24; // Version 4, server
+            reply[1] = 2;    // Stratum
+            memcpy(reply + 24, request + 40, 8); // Originate is the request's transmit
+            putTimestamp(reply + 32, t2);
+            putTimestamp(reply + 40, t3);
+            if (stale)
+            {
+                uint8_t old[48];
+                memcpy(old, reply, sizeof(old));
+                old[31] ^= 1; // Answers some other request
+                sendto(fd, old, sizeof(old), 0, (sockaddr *)&from, fromLength);
+            }
+            std::thread([=]
+                        { sleepMs(downMs);
+                          sendto(fd, reply, sizeof(reply), 0, (sockaddr *)&from, fromLength); })
+                .detach();
+        }
+    }
+}
+
+// Non-blocking datagram socket, every packet goes to the stand-in server
+class HostUDP : public UDP
+{
+public:
+    uint8_t begin(uint16_t port) override
+    {
+        _fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in a = loopback(port);
+        bind(_fd, (sockaddr *)&a, sizeof(a));
+        fcntl(_fd, F_SETFL, O_NONBLOCK);
+        return 1;
+    }
+    void stop() override
+    {
+        close(_fd);
+        _fd = -1;
+    }
+    int beginPacket(IPAddress, uint16_t) override { return beginPacket("", 0); }
+    int beginPacket(const char *, uint16_t) override
+    {
+        _outLength = 0;
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        size = min(size, sizeof(_out) - _outLength);
+        memcpy(_out + _outLength, buffer, size);
+        _outLength += size;
+        return size;
+    }
+    int endPacket() override
+    {
+        sockaddr_in a = loopback(SERVER_PORT);
+        return sendto(_fd, _out, _outLength, 0, (sockaddr *)&a, sizeof(a)) > 0;
+    }
+    int parsePacket() override
+    {
+        _inLength = max(0, (int)recv(_fd, _in, sizeof(_in), 0));
+        _inPosition = 0;
+        return _inLength;
+    }
+    int read(unsigned char *buffer, size_t length) override
+    {
+        int n = min((int)length, _inLength - _inPosition);
+        memcpy(buffer, _in + _inPosition, n);
+        _inPosition += n;
+        return n;
+    }
+    void flush() override { _inPosition = _inLength; }
+
+private:
+    int _fd = -1;
+    uint8_t _out[512], _in[512];
+    size_t _outLength = 0;
+    int _inLength = 0, _inPosition = 0;
+};
+
+int main()
+{
+    std::thread(server).detach();
+    sleepMs(50);
+
+    HostUDP udp;
+    NTPClient ntp(udp, IPAddress(127, 0, 0, 1), 0, 60000);
+    ntp.begin(CLIENT_PORT);
+    auto serverNow = []
+    { return realMs() + SERVER_SKEW; };
+
+    struct Latency
+    {
+        int up, down, processing;
+    } cases[] = {{0, 0, 0}, {40, 40, 5}, {150, 150, 20}, {10, 200, 0}, {300, 300, 100}};
+    for (const Latency &k : cases)
+    {
+        upMs = k.up;
+        downMs = k.down;
+        processingMs = k.processing;
+        unsigned long t0 = micros();
+        CHECK(ntp.beginUpdate());
+        unsigned long sendUs = micros() - t0, worstPollUs = 0;
+        NTPClient::UpdateState state;
+        do
+        {
+            unsigned long a = micros();
+            state = ntp.pollUpdate();
+            worstPollUs = max(worstPollUs, micros() - a);
+            sleepMs(1);
+        } while (state == NTPClient::NTP_PENDING);
+        CHECK(state == NTPClient::NTP_DONE);
+
+        long long error = (long long)ntp.getEpochMillis() - serverNow();
+        printf("up %3d down %3d processing %3d: delay %4lu ms, offset %7ld ms, error %+4lld ms, "
+               "send %lu us, longest poll %lu us\n",
+               k.up, k.down, k.processing, ntp.getDelayMillis(), ntp.getOffsetMillis(), error, sendUs, worstPollUs);
+        CHECK(llabs(error) <= abs(k.up - k.down) / 2 + 3);
+        CHECK(labs((long)ntp.getDelayMillis() - (k.up + k.down)) <= 3);
+        CHECK(ntp.getEpochTime() == ntp.getEpochMillis() / 1000);
+    }
+
+    // getEpochTime() steps at getLastUpdate() + n * 1000, on the second boundary
+    unsigned long last = ntp.getLastUpdate();
+    while ((millis() - last) % 1000 != 999)
+        ;
+    unsigned long second = ntp.getEpochTime();
+    while ((millis() - last) % 1000 == 999)
+        ;
+    CHECK(ntp.getEpochTime() == second + 1);
+
+    // A reply that does not echo the request is ignored, the real one follows it
+    upMs = 0;
+    downMs = 20;
+    processingMs = 0;
+    stale = true;
+    ntp.beginUpdate();
+    NTPClient::UpdateState state;
+    while ((state = ntp.pollUpdate()) == NTPClient::NTP_PENDING)
+        sleepMs(1);
+    stale = false;
+    CHECK(state == NTPClient::NTP_DONE);
+    CHECK(llabs((long long)ntp.getEpochMillis() - serverNow()) <= 13);
+
+    // No answer: forceUpdate() gives up after the timeout, update() then holds off
+    mute = true;
+    unsigned long start = millis();
+    CHECK(!ntp.forceUpdate());
+    unsigned long took = millis() - start;
+    printf("timeout after %lu ms\n", took);
+    CHECK(took >= 1000 && took < 1100);
+    start = micros();
+    for (int i = 0; i < 100; i++)
+        CHECK(!ntp.update());
+    printf("100 update() calls in %lu us while holding off\n", micros() - start);
+    mute = false;
+
+    // update() sends once due and picks the reply up on a later call, never waiting
+    ntp.setUpdateInterval(0);
+    delay(5000);
+    upMs = downMs = 100;
+    unsigned long worstUs = 0;
+    bool updated = false;
+    start = millis();
+    while (!updated && millis() - start < 2000)
+    {
+        unsigned long a = micros();
+        updated = ntp.update();
+        worstUs = max(worstUs, micros() - a);
+        sleepMs(1);
+    }
+    CHECK(updated);
+    printf("update() done after %lu ms, longest call %lu us, delay %lu ms\n", millis() - start, worstUs, ntp.getDelayMillis());
+    CHECK(worstUs < 2000);
+
+    return checkResult();
+}
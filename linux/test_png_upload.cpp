@@ -0,0 +1,243 @@
+// test_png_upload.cpp — Logo uploads in multipart pieces, broken ones never touch the stored logo
+//
+// A logo from ../data arrives as WebServer delivers it, in buffers of HTTP_UPLOAD_BUFLEN
+// and at random split points, into a folder standing in for SPIFFS. Flipped bytes,
+// truncation, trailing data, interlaced, 16-bit and too-wide images (built here with
+// zlib), an abort mid-way and failed renames must all leave the old logo in place and
+// no temporary file behind. recover() is run on the states a reset can leave.
+
+#include <sys/stat.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "PngUpload.h"
+#include "check.h"
+
+namespace
+{
+    typedef std::vector<uint8_t> Bytes;
+    const char ROOT[] = "build/spiffs";
+    const size_t HTTP_UPLOAD_BUFLEN = 1436;
+
+    fs::FS flash(ROOT);
+    PngUpload upload(flash, "/logo4.png");
+
+    Bytes load(const std::string &path)
+    {
+        Bytes d;
+        if (FILE *f = fopen(path.c_str(), "rb"))
+        {
+            int c;
+            while ((c = fgetc(f)) != EOF)
+                d.push_back(c);
+            fclose(f);
+        }
+        return d;
+    }
+
+    void store(const char *path, const Bytes &d)
+    {
+        fs::File f = flash.open(path, "w");
+        f.write(d.data(), d.size());
+    }
+
+    Bytes stored(const char *path = "/logo4.png") { return load(std::string(ROOT) + path); }
+    bool leftovers() { return flash.exists("/logo4.png.tmp") || flash.exists("/logo4.png.bak"); }
+
+    void putBigEndian(Bytes &d, uint32_t v)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            d.push_back(v >> shift);
+    }
+
+    void chunk(Bytes &png, const char *type, const Bytes &data)
+    {
+        putBigEndian(png, data.size());
+        size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        putBigEndian(png, crc32(0, &png[start], png.size() - start));
+    }
+
+    // A valid PNG of all-zero pixels, compressed by zlib
+    Bytes makePng(uint32_t width, uint32_t height, uint8_t depth, uint8_t colourType, uint8_t interlace = 0)
+    {
+        Bytes png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'}, ihdr;
+        putBigEndian(ihdr, width);
+        putBigEndian(ihdr, height);
+        ihdr.insert(ihdr.end(), {depth, colourType, 0, 0, interlace});
+        chunk(png, "IHDR", ihdr);
+        if (colourType == 3)
+            chunk(png, "PLTE", Bytes(3 * 2, 0x80));
+
+        static const uint8_t SAMPLES[7] = {1, 0, 3, 1, 2, 0, 4};
+        size_t row = 1 + ((size_t)SAMPLES[colourType] * depth * width + 7) / 8;
+        Bytes raw(row * height, 0);
+        uLongf packed = compressBound(raw.size());
+        Bytes idat(packed);
+        compress(idat.data(), &packed, raw.data(), raw.size());
+        idat.resize(packed);
+        chunk(png, "IDAT", idat);
+        chunk(png, "IEND", {});
+        return png;
+    }
+
+    // The same image claiming another width, too large to build
+    Bytes withWidth(Bytes png, uint32_t width)
+    {
+        for (int i = 0; i < 4; i++)
+            png[16 + i] = width >> (24 - 8 * i);
+        uint32_t crc = crc32(0, &png[12], 17);
+        for (int i = 0; i < 4; i++)
+            png[29 + i] = crc >> (24 - 8 * i);
+        return png;
+    }
+
+    // START, a WRITE per buffer, END
+    bool deliver(const Bytes &d, std::mt19937 *random = nullptr)
+    {
+        upload.begin();
+        for (size_t i = 0; i < d.size();)
+        {
+            size_t n = random ? 1 + (*random)() % HTTP_UPLOAD_BUFLEN : HTTP_UPLOAD_BUFLEN;
+            n = min(n, d.size() - i);
+            upload.write(&d[i], n);
+            i += n;
+        }
+        return upload.end();
+    }
+}
+
+int main()
+{
+    mkdir(ROOT, 0755);
+    flash.remove("/logo4.png.tmp");
+    flash.remove("/logo4.png.bak");
+    const Bytes old = load("../data/logo1.png"), good = load("../data/logo4.png");
+    CHECK(!old.empty() && !good.empty());
+    store("/logo4.png", old);
+
+    // In HTTP buffers, then at random split points
+    CHECK(deliver(good));
+    CHECK(stored() == good && !leftovers());
+    CHECK(upload.checker().width() == 320 && upload.checker().height() == 240);
+    printf("logo4.png: %u bytes, %u x %u\n", (unsigned)upload.bytes(), upload.checker().width(), upload.checker().height());
+    std::mt19937 random(7);
+    int splitFailures = 0;
+    for (int i = 0; i < 100; i++)
+        splitFailures += !deliver(i % 2 ? good : old, &random);
+    CHECK(splitFailures == 0);
+    CHECK(stored() == good);
+
+    // Widest rows PNGdec still decodes, and the first ones it refuses
+    struct Image
+    {
+        const char *name;
+        Bytes png;
+        bool valid;
+    };
+    const uint32_t LIMIT = PngChecker::MAX_ROW_BYTES;
+    std::vector<Image> images = {
+        {"RGBA 960", makePng(960, 2, 8, 6), true},
+        {"RGBA 961", makePng(961, 2, 8, 6), false},
+        {"RGB widest", makePng((LIMIT - 1) / 3, 2, 8, 2), true},
+        {"grey 1-bit widest", makePng((LIMIT - 1) * 8, 2, 1, 0), true},
+        {"grey 1-bit too wide", makePng((LIMIT - 1) * 8 + 1, 2, 1, 0), false},
+        {"palette 4-bit", makePng(13, 11, 4, 3), true},
+        {"grey + alpha 500", makePng(500, 5, 8, 4), true},
+        {"RGBA 2^31-1", withWidth(makePng(1, 1, 8, 6), 0x7fffffff), false},
+    };
+    CHECK(PngChecker::rowBytes(960, 8, 6) == 3840 && PngChecker::rowBytes(961, 8, 6) >= LIMIT);
+    for (const Image &image : images)
+    {
+        store("/logo4.png", good);
+        bool ok = deliver(image.png);
+        printf("%-20s -> %s\n", image.name, ok ? "accepted" : upload.errorText());
+        CHECK(ok == image.valid);
+        CHECK(!leftovers());
+        CHECK(stored() == (ok ? image.png : good));
+    }
+    store("/logo4.png", good);
+
+    // Broken uploads, each refused with the logo kept and nothing left behind
+    struct Broken
+    {
+        const char *name;
+        Bytes png;
+        PngChecker::Result result;
+    };
+    std::vector<Broken> broken;
+    Bytes d = good;
+    d[good.size() / 2] ^= 0x40;
+    broken.push_back({"flipped data byte", d, PngChecker::BAD_CRC});
+    d = good;
+    d[20] ^= 0x01;
+    broken.push_back({"flipped IHDR byte", d, PngChecker::BAD_CRC});
+    broken.push_back({"truncated", Bytes(good.begin(), good.end() - 100), PngChecker::TRUNCATED});
+    broken.push_back({"missing IEND", Bytes(good.begin(), good.end() - 12), PngChecker::TRUNCATED});
+    d = good;
+    d.push_back(0);
+    broken.push_back({"bytes after IEND", d, PngChecker::BAD_CHUNK});
+    d = good;
+    d[0] = 'G';
+    broken.push_back({"not a PNG", d, PngChecker::NOT_PNG});
+    const char html[] = "<html>hello</html>";
+    broken.push_back({"html page", Bytes(html, html + sizeof(html) - 1), PngChecker::NOT_PNG});
+    broken.push_back({"empty", {}, PngChecker::TRUNCATED});
+    broken.push_back({"interlaced", makePng(64, 48, 8, 2, 1), PngChecker::UNSUPPORTED});
+    broken.push_back({"16-bit", makePng(100, 100, 16, 2), PngChecker::UNSUPPORTED});
+    broken.push_back({"colour type 5", makePng(10, 10, 8, 5), PngChecker::UNSUPPORTED});
+    broken.push_back({"too wide", makePng(4000, 1, 8, 2), PngChecker::TOO_WIDE});
+    for (const Broken &b : broken)
+    {
+        bool ok = deliver(b.png);
+        printf("%-20s -> %s\n", b.name, ok ? "accepted" : upload.errorText());
+        CHECK(!ok && upload.error() == PngUpload::INVALID && upload.checker().result() == b.result);
+        CHECK(stored() == good && !leftovers());
+    }
+
+    // The client goes away half-way
+    upload.begin();
+    upload.write(old.data(), 5000);
+    upload.abort();
+    CHECK(stored() == good && !leftovers());
+    upload.abort(); // Twice is harmless
+
+    // Renames failing: the old logo to .bak, then the new one into place
+    for (int failing = 1; failing <= 2; failing++)
+    {
+        flash.failRenames = failing;
+        CHECK(!deliver(old));
+        CHECK(upload.error() == PngUpload::RENAME_FAILED);
+        CHECK(stored() == good && !leftovers());
+        flash.failRenames = 0;
+    }
+    // The first upload ever, no old logo to back up
+    flash.remove("/logo4.png");
+    CHECK(deliver(good) && stored() == good && !leftovers());
+
+    // What a reset can leave behind
+    CHECK(!upload.recover()); // Nothing to do
+    CHECK(stored() == good);
+
+    store("/logo4.png.tmp", Bytes(old.begin(), old.begin() + 3000)); // While uploading
+    CHECK(!upload.recover());
+    CHECK(stored() == good && !leftovers());
+
+    flash.rename("/logo4.png", "/logo4.png.bak"); // Backed up, the new one not yet renamed
+    store("/logo4.png.tmp", old);
+    CHECK(upload.recover());
+    CHECK(stored() == old && !leftovers());
+
+    flash.rename("/logo4.png", "/logo4.png.bak"); // Backed up, the new one only partly written
+    store("/logo4.png.tmp", Bytes(good.begin(), good.end() - 12));
+    CHECK(upload.recover());
+    CHECK(stored() == old && !leftovers());
+
+    store("/logo4.png.bak", good); // Swapped, the backup not yet deleted
+    CHECK(!upload.recover());
+    CHECK(stored() == old && !leftovers());
+
+    return checkResult();
+}
@@ -0,0 +1,108 @@
+// test_scheduler.cpp — TaskScheduler on a virtual microsecond clock that wraps mid-test
+
+#include "TaskScheduler.h"
+#include "check.h"
+
+static uint32_t nowUs;
+unsigned long virtualMicros() { return nowUs; }
+
+static uint32_t aStarts[200];
+static int aRuns = 0, bRuns = 0, cRuns = 0, hogRuns = 0;
+static uint32_t bCostUs = 0;
+
+void taskA() // Period 1000 us, run time varies 0..600 us
+{
+    if (aRuns < 200)
+        aStarts[aRuns] = nowUs;
+    aRuns++;
+    nowUs += (aRuns % 3) * 300;
+}
+void taskB() { bRuns++, nowUs += bCostUs; }
+void taskC() { cRuns++, nowUs += 50; }
+void hog() { hogRuns++, nowUs += 2700; } // Slower than its 1000 us period
+void nothing() {}
+
+// Run the scheduler for a while, idle time passes 1 us at a time
+static void runFor(TaskScheduler &s, uint32_t us)
+{
+    uint32_t end = nowUs + us;
+    while ((int32_t)(nowUs - end) < 0)
+        if (!s.runOnce())
+            nowUs++;
+}
+
+int main()
+{
+    // Releases stay on the grid while the clock wraps and other tasks run; a misses its
+    // 500 us deadline on the runs that take 600 us
+    nowUs = 0xFFFFFFFFu - 50000;
+    uint32_t t0 = nowUs;
+    TaskScheduler s(virtualMicros);
+    int8_t a = s.addTask("a", taskA, 1000, 3, 500);
+    int8_t b = s.addTask("b", taskB, 5000, 2);
+    int8_t c = s.addTask("c", taskC, 2000, 1);
+    CHECK(a == 0 && b == 1 && c == 2);
+    while (aRuns < 100)
+        if (!s.runOnce())
+            nowUs++;
+    int offGrid = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        int32_t d = (int32_t)(aStarts[i] - (t0 + i * 1000));
+        offGrid += d < 0 || d >= 400;
+    }
+    CHECK(offGrid == 0);
+    CHECK(s.taskStats(a).skipped == 0);
+    printf("grid: a runs %u, misses %u, max start delay %u us | b %d runs, c %d runs\n", s.taskStats(a).runs,
+           s.taskStats(a).misses, s.taskStats(a).maxStartDelayUs, bRuns, cRuns);
+
+    // A 3.5 ms task blocks a 1 ms one: lateness is recorded, missed releases are skipped
+    s.resetStats();
+    bCostUs = 3500;
+    runFor(s, 100000);
+    const TaskScheduler::TaskStats &as = s.taskStats(a);
+    printf("blocked: a runs %u, misses %u, skipped %u, max lateness %u us\n", as.runs, as.misses, as.skipped, as.maxLatenessUs);
+    CHECK(as.misses > 0 && as.skipped > 0);
+    CHECK(as.maxLatenessUs > 0 && as.maxStartDelayUs > 0);
+    CHECK(as.runs + as.skipped >= 95 && as.runs + as.skipped <= 101);
+
+    // A high-priority task slower than its period does not starve lower priorities
+    TaskScheduler s2(virtualMicros);
+    s2.addTask("hog", hog, 1000, 5);
+    int8_t low = s2.addTask("c", taskC, 2000, 1);
+    cRuns = 0;
+    runFor(s2, 100000);
+    printf("overrun: hog %d runs, skipped %u, c %d runs\n", hogRuns, s2.taskStats(0).skipped, cRuns);
+    CHECK(cRuns > 30);
+    CHECK(s2.taskStats(low).runs == (uint32_t)cRuns);
+
+    // Re-alignment and idle time
+    TaskScheduler s3(virtualMicros);
+    int8_t x = s3.addTask("x", nothing, 1000, 1);
+    CHECK(s3.runOnce());
+    CHECK(!s3.runOnce());
+    CHECK(s3.idleTime() == 1000);
+    s3.setNextRelease(x, nowUs + 250);
+    CHECK(s3.idleTime() == 250);
+    nowUs += 250;
+    CHECK(s3.runOnce());
+    CHECK(s3.idleTime() == 1000);
+
+    // A disabled task resumes now, without a backlog of releases
+    s3.setEnabled(x, false);
+    nowUs += 10000;
+    CHECK(!s3.runOnce());
+    s3.setEnabled(x, true);
+    CHECK(s3.runOnce());
+    CHECK(!s3.runOnce());
+    CHECK(s3.taskStats(x).skipped == 0);
+
+    // Only MAX_TASKS fit, the next addTask() says so
+    TaskScheduler full(virtualMicros);
+    for (uint8_t i = 0; i < TaskScheduler::MAX_TASKS; i++)
+        CHECK(full.addTask("t", nothing, 1000, 1) == (int8_t)i);
+    CHECK(full.addTask("extra", nothing, 1000, 1) == -1);
+    CHECK(full.taskCount() == TaskScheduler::MAX_TASKS);
+
+    return checkResult();
+}
@@ -0,0 +1,117 @@
+// test_segment_clock.cpp — Segment repaints equal full redraws, and 24 hours of clock
+// ticks cost a fraction of whole-cell pushes
+
+#include <TFT_eSPI.h>
+#include "HB9IIU7seg42ptNormal.h"
+#include "HB9IIU7seg42ptItalic.h"
+#include "ClockGlyphCache.h"
+#include "SegmentClock.h"
+#include "check.h"
+
+TFT_eSPI tft;
+ClockGlyphCache cache(&tft);
+SegmentClock segments(&cache);
+
+// Character offsets of displayTime() in main.cpp, "HH:MM:SS"
+const int POSITIONS[8] = {0, 48, 78, 108, 156, 186, 216, 264};
+
+static uint16_t screen[240][320];
+
+static void grab()
+{
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            screen[y][x] = tft_emulator.readScreen(x, y);
+}
+
+static int differences()
+{
+    int n = 0;
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            n += screen[y][x] != tft_emulator.readScreen(x, y);
+    return n;
+}
+
+static void fullLine(const char *time)
+{
+    for (int i = 0; i < 8; i++)
+        cache.drawChar(time[i], 8 + POSITIONS[i], 5, TFT_GREEN, TFT_BLACK);
+}
+
+int main()
+{
+    tft.init();
+    tft.setRotation(1);
+
+    for (const GFXfont *font : {&digital_7__mono_42pt7b, &digital_7_monoitalic42pt7b})
+    {
+        const char *name = font == &digital_7__mono_42pt7b ? "normal" : "italic";
+        CHECK(cache.build(font));
+        CHECK(segments.build());
+        printf("%s: %d segments\n", name, segments.segmentCount());
+
+        // Every digit pair: the transition leaves what a fresh draw of the new digit leaves
+        int bad = 0;
+        for (int a = 0; a < 10; a++)
+            for (int b = 0; b < 10; b++)
+            {
+                if (a == b)
+                    continue;
+                tft.fillScreen(TFT_BLACK);
+                cache.drawChar('0' + b, 100, 50, TFT_GREEN, TFT_BLACK);
+                grab();
+                tft.fillScreen(TFT_BLACK);
+                cache.drawChar('0' + a, 100, 50, TFT_GREEN, TFT_BLACK);
+                segments.drawTransition('0' + a, '0' + b, 100, 50, TFT_GREEN, TFT_BLACK);
+                bad += differences();
+            }
+        CHECK(bad == 0);
+
+        // 24 hours of ticks on a clock line: segment repaints against whole-cell pushes.
+        // The line is checked against a full redraw every simulated minute, so a column
+        // another cell clipped would show up long before its digit changes.
+        tft.fillScreen(TFT_BLACK);
+        char previous[9] = "00:00:00", time[9];
+        fullLine(previous);
+        uint64_t segPixels = 0, segWindows = 0, segBytes = 0, cellPixels = 0, cellWindows = 0, cellBytes = 0;
+        int lineErrors = 0;
+        for (int t = 1; t < 86400; t++)
+        {
+            snprintf(time, sizeof(time), "%02d:%02d:%02d", t / 3600, t / 60 % 60, t % 60);
+            tft_emulator.endFrame();
+            for (int i = 0; i < 8; i++)
+                if (time[i] != previous[i])
+                    segments.drawTransition(previous[i], time[i], 8 + POSITIONS[i], 5, TFT_GREEN, TFT_BLACK);
+            tft_emulator.endFrame();
+            const ILI9341_Emulator::emu_stats_t &s = tft_emulator.lastFrameStats();
+            segPixels += s.pixels;
+            segWindows += s.windows;
+            segBytes += s.bytes;
+
+            // What the same tick costs as whole-cell pushes (drawn below the clock line)
+            for (int i = 0; i < 8; i++)
+                if (time[i] != previous[i])
+                    cache.drawChar(time[i], 8 + POSITIONS[i], 120, TFT_GREEN, TFT_BLACK);
+            tft_emulator.endFrame();
+            cellPixels += tft_emulator.lastFrameStats().pixels;
+            cellWindows += tft_emulator.lastFrameStats().windows;
+            cellBytes += tft_emulator.lastFrameStats().bytes;
+            memcpy(previous, time, sizeof(time));
+
+            if (t % 60 == 0)
+            {
+                grab();
+                fullLine(time);
+                lineErrors += differences() != 0;
+            }
+        }
+        CHECK(lineErrors == 0);
+        printf("%s, per tick over 24 h: segments %.0f px, %.2f windows, %.0f bytes | whole cells %.0f px, %.2f windows, %.0f bytes\n",
+               name, segPixels / 86399.0, segWindows / 86399.0, segBytes / 86399.0,
+               cellPixels / 86399.0, cellWindows / 86399.0, cellBytes / 86399.0);
+        CHECK(segPixels * 2 < cellPixels);
+    }
+
+    return checkResult();
+}
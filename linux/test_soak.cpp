@@ -0,0 +1,173 @@
+// test_soak.cpp — Two days of clock ticks and banner updates without a heap allocation
+//
+// The per-second path of main.cpp (time zone, CivilClock, formatting, segment repaints,
+// flip timing and latency histograms) and the per-frame banner push run against the
+// emulator for two days of virtual time, across the 2026 spring DST change. A new
+// weather report is built in a FixedString and rendered every five minutes. Every
+// malloc() and operator new is counted after the first minute; the clock, the banner and
+// a new report must make none (the ticker renders into the strip it already has).
+
+#include <new>
+#include <TFT_eSPI.h>
+#include "HB9IIU7seg42ptNormal.h"
+#include "HB9IIOrbitronMed10pt.h"
+#include "ClockGlyphCache.h"
+#include "SegmentClock.h"
+#include "TickerStrip.h"
+#include "Timebase.h"
+#include "CivilTime.h"
+#include "TimeZone.h"
+#include "FixedString.h"
+#include "Metrics.h"
+#include "check.h"
+
+// Every allocation is counted, except under AddressSanitizer which has its own
+#if !defined(__SANITIZE_ADDRESS__)
+static size_t allocations = 0;
+void *operator new(size_t n)
+{
+    allocations++;
+    if (void *p = malloc(n))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+extern "C"
+{
+    void *__libc_malloc(size_t);
+    void *__libc_calloc(size_t, size_t);
+    void *__libc_realloc(void *, size_t);
+    void *malloc(size_t n)
+    {
+        allocations++;
+        return __libc_malloc(n);
+    }
+    void *calloc(size_t n, size_t size)
+    {
+        allocations++;
+        return __libc_calloc(n, size);
+    }
+    void *realloc(void *p, size_t n)
+    {
+        allocations++;
+        return __libc_realloc(p, n);
+    }
+}
+#else
+static size_t allocations = 0;
+#endif
+
+namespace
+{
+    unsigned long long virtualUs = 0;
+    unsigned long virtualClock() { return (unsigned long)virtualUs; }
+
+    typedef FixedString<320> BannerText;
+
+    TFT_eSPI tft;
+    ClockGlyphCache glyphs(&tft);
+    SegmentClock segments(&glyphs);
+    TickerStrip ticker(&tft, 310, 30);
+    Timebase timebase(virtualClock);
+    TimeZone timeZone;
+    Histogram displayTimeHistogram, bannerHistogram;
+    BannerText scrollText;
+    char previousLocalTime[CIVIL_HMS_SIZE] = "", previousUTCtime[CIVIL_HMS_SIZE] = "";
+
+    // displayTime() of main.cpp, the cached glyph path
+    void displayTime(int x, int y, const char *time, char *previousTime, uint16_t colour)
+    {
+        int positions[] = {x, x + 48, x + 78, x + 108, x + 156, x + 186, x + 216, x + 264};
+        for (int i = 0; time[i] && i < (int)CIVIL_HMS_SIZE - 1; i++)
+            if (time[i] != previousTime[i])
+                CHECK(segments.drawTransition(previousTime[i], time[i], positions[i], y, colour, TFT_BLACK));
+        strlcpy(previousTime, time, CIVIL_HMS_SIZE);
+    }
+
+    void clockTick(uint32_t epoch)
+    {
+        static CivilClock localClock, utcClock;
+        char localTime[CIVIL_HMS_SIZE], utcTime[CIVIL_HMS_SIZE];
+        formatHMS(localClock.at(timeZone.toLocal(epoch)), localTime);
+        formatHMS(utcClock.at(epoch), utcTime);
+        ScopedTimer timer(displayTimeHistogram);
+        displayTime(8, 5, localTime, previousLocalTime, TFT_GREEN);
+        displayTime(10, 107, utcTime, previousUTCtime, TFT_GOLD);
+        timebase.markFlip(epoch, virtualClock());
+        timebase.advance(virtualClock());
+    }
+
+    void buildReport(BannerText &text, int i)
+    {
+        const char *descriptions[] = {"clear sky", "light rain", "overcast clouds", "thunderstorm with heavy rain", "snow"};
+        text.clear();
+        text.appendf("%s     %s    %s     Temp: %.1f°C     RH: %d%%       %s       Sunrise: %s     Sunset: %s",
+                     "Lausanne", "CH", "16:10:26", 12.3 + i % 17, 40 + i % 60, descriptions[i % 5], "07:58:01", "18:40:12");
+    }
+}
+
+int main()
+{
+    tft.init();
+    tft.setRotation(1);
+    glyphs.build(&digital_7__mono_42pt7b);
+    segments.build();
+    CHECK(timeZone.set("CET-1CEST,M3.5.0,M10.5.0/3"));
+
+    const uint32_t epoch0 = 1774742400 - 86400; // 2026-03-28 00:00 UTC, a day before the spring change
+    const uint32_t DAYS = 2, WARM_UP_S = 60;
+    virtualUs = 1000000;
+    timebase.sync(epoch0, 1000000);
+
+    BannerText report;
+    buildReport(report, 0);
+    scrollText = report.c_str();
+    CHECK(ticker.render(scrollText.c_str(), &Orbitron_Medium10pt7b));
+
+    size_t tickAllocations = 0, reportAllocations = 0;
+    uint32_t ticksAllocating = 0, reports = 0;
+    int32_t textX = 310;
+    for (uint32_t s = 0; s < DAYS * 86400; s++)
+    {
+        virtualUs = timebase.boundaryUs(epoch0 + s) + 300;
+        size_t before = allocations;
+        clockTick(timebase.epochAt(virtualClock()));
+        {
+            ScopedTimer timer(bannerHistogram);
+            ticker.push(textX, 5, 205, TFT_DARKGREEN, TFT_BLACK);
+            if (--textX < -ticker.textWidth())
+                textX = 310;
+        }
+        if (s >= WARM_UP_S)
+        {
+            tickAllocations += allocations - before;
+            ticksAllocating += allocations != before;
+        }
+
+        if (s % 300 == 0)
+        {
+            before = allocations;
+            buildReport(report, s / 300);
+            scrollText = report.c_str();
+            CHECK(!scrollText.truncated());
+            CHECK(ticker.render(scrollText.c_str(), &Orbitron_Medium10pt7b));
+            reportAllocations += allocations - before;
+            reports++;
+        }
+    }
+
+    printf("%u days, %u ticks: %u ticks allocated (%zu allocations), %zu allocations in %u banner updates\n",
+           DAYS, DAYS * 86400, ticksAllocating, tickAllocations, reportAllocations, reports);
+    printf("flips %u, worst flip %u us\n", timebase.stats().flips, timebase.stats().maxFlipUs);
+    CHECK(tickAllocations == 0);
+    CHECK(reportAllocations == 0);
+    CHECK(timebase.stats().flips == DAYS * 86400);
+    CHECK(!strcmp(previousUTCtime, "23:59:59"));
+    CHECK(!strcmp(previousLocalTime, "01:59:59")); // CEST by then
+
+    return checkResult();
+}
@@ -0,0 +1,209 @@
+// test_splash_cache.cpp — The cached startup logo paints the same panel as the PNG, for less
+//
+// Every data/logo*.png is copied to a folder standing in for SPIFFS and drawn on the
+// emulator the way displayPNGfromSPIFFS() does it: fitted with setScale(), decoded in
+// bands and recorded into the SplashCache as it goes. The cache is then shown on a
+// cleared panel and must leave the GRAM identical. Time and bus bytes of both paths are
+// printed. A cache made from another logo, from a file of another size, a truncated
+// cache and recordings that fail before end() must all fall back without a wrong image.
+
+#include <sys/stat.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <TFT_eSPI.h>
+#include <PNGdec.h>
+#include "SplashCache.h"
+#include "check.h"
+
+TFT_eSPI tft;
+
+namespace
+{
+    const char ROOT[] = "build/spiffs";
+    const int BAND_LINES = 16; // pngBandLines of main.cpp
+
+    fs::FS flash(ROOT);
+    SplashCache splashCache(flash, "/splash.565");
+    PNG png;
+    fs::File pngFile;
+    int stopAfterRows = -1; // Rows the cache records before the decode fails, -1 for all
+
+    typedef std::vector<uint16_t> Screen;
+
+    Screen readScreen()
+    {
+        Screen s(320 * 240);
+        for (int y = 0; y < 240; y++)
+            for (int x = 0; x < 320; x++)
+                s[y * 320 + x] = tft_emulator.readScreen(x, y);
+        return s;
+    }
+
+    void copy(const std::string &from, const char *to)
+    {
+        FILE *in = fopen(from.c_str(), "rb");
+        fs::File out = flash.open(to, "w");
+        uint8_t buf[4096];
+        size_t n;
+        while (in && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+            out.write(buf, n);
+        if (in)
+            fclose(in);
+    }
+
+    // The callbacks of main.cpp
+    void *fileOpen(const char *filename, int32_t *size)
+    {
+        pngFile = flash.open(String("/") + filename, "r");
+        if (!pngFile)
+            return nullptr;
+        *size = pngFile.size();
+        return &pngFile;
+    }
+    void fileClose(void *handle) { ((fs::File *)handle)->close(); }
+    int32_t fileRead(PNGFILE *handle, uint8_t *buffer, int32_t length)
+    {
+        return ((fs::File *)handle->fHandle)->read(buffer, length);
+    }
+    int32_t fileSeek(PNGFILE *handle, int32_t position) { return ((fs::File *)handle->fHandle)->seek(position); }
+
+    void draw(PNGDRAW *pDraw)
+    {
+        tft.pushImage(pDraw->x, pDraw->y, pDraw->iWidth, pDraw->iLines, pDraw->pBand);
+        for (int i = 0; i < pDraw->iLines; i++)
+            if (stopAfterRows < 0 || pDraw->y + i < stopAfterRows)
+                splashCache.addLine(pDraw->pBand + i * pDraw->iWidth);
+    }
+
+    // displayPNGfromSPIFFS() with filename the startup logo; false if it could not be shown
+    bool displayPng(const char *filename)
+    {
+        int rc = png.open(filename, fileOpen, fileClose, fileRead, fileSeek, draw);
+        if (rc == PNG_SUCCESS)
+            rc = png.setScale(tft.width(), tft.height());
+        std::vector<uint16_t> band;
+        if (rc == PNG_SUCCESS)
+        {
+            band.resize(png.getOutputWidth() * BAND_LINES);
+            png.setBand(band.data(), BAND_LINES, PNG_RGB565_LITTLE_ENDIAN, 0xFFFFFFFF);
+            int x = (tft.width() - png.getOutputWidth()) / 2;
+            int y = (tft.height() - png.getOutputHeight()) / 2;
+            if (png.getOutputWidth() < tft.width() || png.getOutputHeight() < tft.height())
+                tft.fillScreen(TFT_BLACK);
+            splashCache.begin((std::string("/") + filename).c_str(), x, y, png.getOutputWidth(), png.getOutputHeight());
+
+            bool swap = tft.getSwapBytes();
+            tft.setSwapBytes(true);
+            tft.startWrite();
+            rc = png.decode(nullptr, 0);
+            tft.endWrite();
+            tft.setSwapBytes(swap);
+            if (rc != PNG_SUCCESS)
+                splashCache.abort();
+            else if (splashCache.recording())
+                splashCache.end();
+        }
+        png.close();
+        return rc == PNG_SUCCESS;
+    }
+
+    double microsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void clearPanel()
+    {
+        tft.fillScreen(TFT_BLACK);
+        tft_emulator.endFrame();
+    }
+}
+
+int main()
+{
+    mkdir(ROOT, 0755);
+    tft.init();
+    tft.setRotation(1);
+    const char *logos[] = {"logo1.png", "logo2.png", "logo3.png", "logo4.png", "logo5.png"};
+
+    for (const char *logo : logos)
+    {
+        std::string path = std::string("/") + logo;
+        copy(std::string("../data/") + logo, path.c_str());
+        splashCache.invalidate();
+
+        clearPanel();
+        auto start = std::chrono::steady_clock::now();
+        CHECK(displayPng(logo));
+        double pngUs = microsSince(start);
+        tft_emulator.endFrame();
+        ILI9341_Emulator::emu_stats_t pngBus = tft_emulator.lastFrameStats();
+        const Screen decoded = readScreen();
+
+        clearPanel();
+        start = std::chrono::steady_clock::now();
+        bool shown = splashCache.show(tft, path.c_str());
+        double cacheUs = microsSince(start);
+        tft_emulator.endFrame();
+        ILI9341_Emulator::emu_stats_t cacheBus = tft_emulator.lastFrameStats();
+        CHECK(shown);
+        CHECK(readScreen() == decoded);
+
+        fs::File source = flash.open(path), cache = flash.open("/splash.565");
+        printf("%s: %u byte PNG in %.0f us, %u bus bytes (%u us); %u byte cache in %.0f us, %u bus bytes (%u us)\n", logo,
+               (unsigned)source.size(), pngUs, pngBus.bytes, ILI9341_Emulator::busMicros(pngBus),
+               (unsigned)cache.size(), cacheUs, cacheBus.bytes, ILI9341_Emulator::busMicros(cacheBus));
+    }
+
+    // The cache now holds logo5.png
+    const Screen logo5 = readScreen();
+    CHECK(!splashCache.show(tft, "/logo4.png")); // Another source
+    CHECK(!splashCache.show(tft, "/missing.png"));
+
+    // The source rewritten with another size, as an older upload
+    {
+        fs::File f = flash.open("/logo5.png", "a");
+        uint8_t zero = 0;
+        f.write(&zero, 1);
+    }
+    CHECK(!splashCache.show(tft, "/logo5.png"));
+    copy("../data/logo5.png", "/logo5.png");
+    CHECK(splashCache.show(tft, "/logo5.png"));
+
+    // A cache file cut short
+    copy(std::string(ROOT) + "/splash.565", "/splash.full");
+    {
+        fs::File full = flash.open("/splash.full"), cut = flash.open("/splash.565", "w");
+        std::vector<uint8_t> bytes(full.size() - 1000);
+        full.read(bytes.data(), bytes.size());
+        cut.write(bytes.data(), bytes.size());
+    }
+    clearPanel();
+    CHECK(!splashCache.show(tft, "/logo5.png"));
+    flash.remove("/splash.565");
+    flash.rename("/splash.full", "/splash.565");
+
+    // Recordings that never reach a good end() leave the old cache: rows missing, a failed decode
+    stopAfterRows = 100;
+    CHECK(displayPng("logo1.png") && !splashCache.recording());
+    stopAfterRows = -1;
+    clearPanel();
+    CHECK(splashCache.show(tft, "/logo5.png") && readScreen() == logo5);
+    CHECK(!flash.exists("/splash.565.tmp"));
+
+    CHECK(splashCache.begin("/logo1.png", 0, 0, 320, 240));
+    std::vector<uint16_t> row(320, TFT_RED);
+    splashCache.addLine(row.data());
+    splashCache.abort();
+    CHECK(!splashCache.end());
+    clearPanel();
+    CHECK(splashCache.show(tft, "/logo5.png") && readScreen() == logo5);
+    CHECK(!flash.exists("/splash.565.tmp"));
+
+    // Invalidated before an upload rewrites the logo
+    splashCache.invalidate();
+    CHECK(!splashCache.show(tft, "/logo5.png"));
+
+    return checkResult();
+}
@@ -0,0 +1,162 @@
+// test_time_zone.cpp — TimeZone against glibc's localtime_r for every rule it handles
+//
+// Each zone is walked from 1970 to 2100 in 20 minute steps; where glibc's offset changes
+// the exact second is bisected and the three seconds on either side are compared too.
+// Offset, DST flag, abbreviation and the local wall clock must all match glibc, also for
+// random-order lookups that land on either side of the cached span. Invalid strings must
+// be rejected without losing the rule in use. Last, the per-tick cost next to glibc.
+
+#include <chrono>
+#include <time.h>
+#include "TimeZone.h"
+#include "CivilTime.h"
+#include "check.h"
+
+namespace
+{
+    const char *const ZONES[] = {
+        "CET-1CEST,M3.5.0,M10.5.0/3",            // Central Europe
+        "GMT0BST,M3.5.0/1,M10.5.0",              // UK
+        "IST-1GMT0,M10.5.0,M3.5.0/1",            // Ireland, negative DST
+        "EST5EDT,M3.2.0,M11.1.0",                // US Eastern
+        "PST8PDT,M3.2.0,M11.1.0",                // US Pacific
+        "AEST-10AEDT,M10.1.0,M4.1.0/3",          // Sydney, southern hemisphere
+        "NZST-12NZDT,M9.5.0,M4.1.0/3",           // New Zealand
+        "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0",  // Lord Howe, 30 minute DST
+        "<-02>2<-01>,M3.5.0/-1,M10.5.0/0",       // Greenland, negative rule time
+        "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",      // Greenland from 2023
+        "EST5EDT,0/0,J365/25",                   // DST all year
+        "<+0330>-3:30<+0430>,J79/24,J263/24",    // Iran (old), Julian days at 24:00
+        "CST6CDT,M4.1.0,M10.5.0",                // Mexico (old)
+        "<-04>4<-03>,M9.1.6/24,M4.1.6/24",       // Chile, 24:00
+        "IST-5:30", "<+0545>-5:45", "HST10", "UTC0", "<-00>0", "MSK-3", "JST-9",
+        "WET0WEST,M3.5.0/1,M10.5.0",
+        "EET-2EEST,M3.5.0/3,M10.5.0/4",
+        "<+13>-13", "<-12>12",
+        "ABC+3XYZ+1,95/1:30,300/-0:30",          // Zero-based days, explicit DST offset
+    };
+
+    const char *const INVALID[] = {
+        "", "C-1", "CET", "CET-1CEST,M3.5.0", "CET-1CEST,M13.5.0,M10.5.0", "CET-1CEST,M3.6.0,M10.5.0",
+        "CET-1CEST,M3.5.7,M10.5.0", "CET-1CEST,J0,J100", "CET-1CEST,366,1", "CET-25", "<+05-5",
+        "CET-1CEST,M3.5.0/168,M10.5.0", "CET-1 CEST", "CET-1CEST,M3.5.0,M10.5.0x", "AVERYVERYLONGNAMEZONE-1",
+    };
+
+    uint32_t compared = 0, mismatches = 0;
+
+    // TimeZone (as the TZ environment already selects rule) agrees with glibc at t
+    void compare(TimeZone &tz, const char *rule, int64_t t)
+    {
+        time_t tt = t;
+        struct tm lt;
+        localtime_r(&tt, &lt);
+        CivilTime local;
+        civilFromEpoch(tz.toLocal(t), local);
+        compared++;
+        if (tz.offsetAt(t) == lt.tm_gmtoff && tz.isDst(t) == (lt.tm_isdst > 0) && !strcmp(tz.abbreviation(t), lt.tm_zone) &&
+            local.year == lt.tm_year + 1900 && local.month == lt.tm_mon + 1 && local.day == lt.tm_mday &&
+            local.hour == lt.tm_hour && local.minute == lt.tm_min && local.second == lt.tm_sec)
+            return;
+        if (mismatches++ < 10)
+            printf("MISMATCH %s at %lld: ours %d %d %s, glibc %ld %d %s\n", rule, (long long)t, (int)tz.offsetAt(t),
+                   tz.isDst(t), tz.abbreviation(t), lt.tm_gmtoff, lt.tm_isdst, lt.tm_zone);
+    }
+
+    long glibcOffset(int64_t t)
+    {
+        time_t tt = t;
+        struct tm lt;
+        localtime_r(&tt, &lt);
+        return lt.tm_gmtoff;
+    }
+}
+
+int main()
+{
+    const int64_t FROM = 0, TO = 4102444800LL; // 1970 to 2100
+    const int64_t STEP = 1200;
+
+    for (const char *rule : ZONES)
+    {
+        setenv("TZ", rule, 1);
+        tzset();
+        TimeZone tz;
+        CHECK(tz.set(rule));
+        CHECK(!strcmp(tz.rule(), rule));
+
+        int transitions = 0;
+        long previous = glibcOffset(FROM);
+        for (int64_t t = FROM; t < TO; t += STEP)
+        {
+            long offset = glibcOffset(t);
+            if (offset != previous)
+            {
+                int64_t before = t - STEP, after = t;
+                while (after - before > 1)
+                {
+                    int64_t middle = (before + after) / 2;
+                    (glibcOffset(middle) == previous ? before : after) = middle;
+                }
+                for (int64_t e = after - 3; e <= after + 3; e++)
+                    compare(tz, rule, e);
+                transitions++;
+            }
+            previous = offset;
+            compare(tz, rule, t);
+        }
+
+        srand(1);
+        for (int i = 0; i < 200000; i++)
+            compare(tz, rule, ((int64_t)rand() << 15 ^ rand()) % TO);
+        printf("%-40s %4d transitions\n", rule, transitions);
+    }
+    printf("%u lookups compared with glibc\n", compared);
+    CHECK(mismatches == 0);
+
+    TimeZone tz;
+    CHECK(tz.set("CET-1CEST,M3.5.0,M10.5.0/3"));
+    for (const char *invalid : INVALID)
+        if (tz.set(invalid))
+        {
+            printf("accepted \"%s\"\n", invalid);
+            CHECK(false);
+        }
+    CHECK(!strcmp(tz.rule(), "CET-1CEST,M3.5.0,M10.5.0/3"));
+
+    // A year of clock ticks leaves the cached span only at the two transitions and the
+    // turn of the year
+    const int64_t YEAR_2026 = 1767225600LL;
+    int spans = 0;
+    int64_t until = -1;
+    for (int64_t t = YEAR_2026; t < YEAR_2026 + 365 * 86400LL; t++)
+    {
+        tz.offsetAt(t);
+        if (tz.validUntil() != until)
+        {
+            until = tz.validUntil();
+            spans++;
+        }
+    }
+    printf("one year of ticks, %d cached spans\n", spans);
+    CHECK(spans == 3);
+
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    const int N = 10000000;
+    const int64_t e0 = 1760000000;
+    volatile int64_t sink = 0;
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < N; i++)
+        sink += tz.toLocal(e0 + i);
+    Clock::time_point t1 = Clock::now();
+    for (int i = 0; i < N / 10; i++)
+        sink += glibcOffset(e0 + i);
+    Clock::time_point t2 = Clock::now();
+    double ours = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    double glibc = std::chrono::duration<double, std::nano>(t2 - t1).count() / (N / 10);
+    printf("per tick: TimeZone::toLocal %.2f ns, localtime_r %.1f ns\n", ours, glibc);
+    CHECK(ours < glibc);
+
+    return checkResult();
+}
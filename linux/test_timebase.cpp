@@ -0,0 +1,120 @@
+// test_timebase.cpp — NTP updates replayed on a drifting oscillator, the seconds stay on time
+//
+// The local clock runs 35 ppm fast, then 20 ppm slow, from a micros() value that wraps
+// 30 s in and every 71.6 minutes after. Every minute an NTP update gives the millis()
+// value at which a UTC second started, with up to 1 ms of noise; the UI task takes it up
+// to a second later and anchors it on micros() the way currentEpoch() in main.cpp does.
+// Three hours in, UTC steps by a second. The sync errors, the one step, the rate estimate
+// and every predicted second boundary are checked against the true oscillator. The
+// millisecond anchor alone is checked across the wrap first.
+
+#include <random>
+#include "Timebase.h"
+#include "check.h"
+
+namespace
+{
+    const uint64_t START_US = (1ULL << 32) - 30000000; // micros() wraps 30 s in
+
+    // The 64-bit count behind micros() and millis(), as esp_timer keeps it
+    uint64_t localUs = START_US;
+    unsigned long clockMicros() { return (uint32_t)localUs; }
+    uint32_t clockMillis() { return (uint32_t)(localUs / 1000); }
+
+    // currentEpoch() of main.cpp: the second started (millis() - millisAt) ms before now
+    uint32_t anchorUs(uint32_t millisAt)
+    {
+        uint32_t nowUs = clockMicros();
+        return nowUs - (clockMillis() - millisAt) * 1000UL;
+    }
+
+    // Local count at true time t microseconds from the start
+    uint64_t oscillator(uint64_t tUs, double ppm) { return START_US + tUs + (int64_t)(tUs * ppm / 1e6); }
+
+    struct Replay
+    {
+        uint32_t maxSyncErrorUs, steps, maxBoundaryErrorUs, wraps;
+        int32_t ratePpb;
+    };
+
+    // Hours of one-minute updates, a one second UTC step at stepAtS
+    Replay replay(double ppm, int hours, uint32_t stepAtS, std::mt19937 &random)
+    {
+        Timebase timebase(clockMicros);
+        const uint32_t EPOCH0 = 1780000000;
+        const uint32_t settleS = 1800; // Rate estimate converging, left out of the maxima
+        std::uniform_int_distribution<int> noiseUs(-1000, 1000), delayMs(0, 900);
+        Replay r = {0, 0, 0, 0, 0};
+        uint32_t stepS = 0;
+        uint32_t lastUs = clockMicros();
+
+        for (uint32_t s = 0; s < (uint32_t)hours * 3600; s++)
+        {
+            if (s == stepAtS)
+                stepS = 1;
+            const uint32_t epoch = EPOCH0 + s + stepS;
+            const uint64_t boundaryUs = oscillator((uint64_t)s * 1000000, ppm);
+
+            // Every predicted boundary once the first update is in, a step excepted
+            localUs = boundaryUs;
+            if (timebase.isSet() && s > settleS && (s < stepAtS || s > stepAtS + 60))
+            {
+                uint32_t error = abs((int32_t)(timebase.boundaryUs(epoch) - clockMicros()));
+                r.maxBoundaryErrorUs = max(r.maxBoundaryErrorUs, error);
+            }
+            r.wraps += clockMicros() < lastUs;
+            lastUs = clockMicros();
+
+            if (s % 60 != 0)
+                continue;
+            // The network task: second epoch started at this millis() value, give or take
+            uint32_t millisAt = (uint32_t)((boundaryUs + noiseUs(random)) / 1000);
+            // The UI task picks it up later
+            localUs = oscillator((uint64_t)s * 1000000 + delayMs(random) * 1000ULL, ppm);
+            timebase.sync(epoch, anchorUs(millisAt));
+            CHECK(timebase.epochAt(clockMicros()) == epoch);
+            if (s == settleS)
+                timebase.resetStats();
+        }
+        r.maxSyncErrorUs = timebase.stats().maxSyncErrorUs;
+        r.steps = timebase.stats().steps;
+        r.ratePpb = timebase.rateErrorPpb();
+        return r;
+    }
+}
+
+int main()
+{
+    std::mt19937 random(11);
+
+    // The anchor alone, on both sides of the micros() wrap: within a millisecond
+    uint32_t worstAnchorUs = 0;
+    std::uniform_int_distribution<uint64_t> around(START_US, START_US + 60000000);
+    std::uniform_int_distribution<int> laterUs(0, 2000000);
+    for (int i = 0; i < 100000; i++)
+    {
+        uint64_t boundary = around(random);
+        localUs = boundary;
+        uint32_t millisAt = clockMillis(), trueUs = clockMicros();
+        localUs += laterUs(random);
+        worstAnchorUs = max(worstAnchorUs, (uint32_t)abs((int32_t)(anchorUs(millisAt) - trueUs)));
+    }
+    printf("anchor: %u us worst\n", worstAnchorUs);
+    CHECK(worstAnchorUs < 1000);
+
+    const double drifts[] = {35, -20};
+    for (double ppm : drifts)
+    {
+        Replay r = replay(ppm, 6, 3 * 3600 + 30, random);
+        printf("%+.0f ppm: sync error %u us worst, boundaries %u us worst, %u step(s), rate %d ppb, %u wraps\n", ppm,
+               r.maxSyncErrorUs, r.maxBoundaryErrorUs, r.steps, (int)r.ratePpb, r.wraps);
+        CHECK(r.wraps == 6);
+        CHECK(r.steps == 1);
+        // Up to 2 ms of noise and anchor rounding, plus what the rate leaves over a minute
+        CHECK(r.maxSyncErrorUs < 3500);
+        CHECK(r.maxBoundaryErrorUs < 3500);
+        CHECK(abs(r.ratePpb - (int32_t)(ppm * 1000)) < 15000);
+    }
+
+    return checkResult();
+}
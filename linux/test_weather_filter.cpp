@@ -0,0 +1,128 @@
+// test_weather_filter.cpp — The filtered streaming parse of fetchWeatherReport() against
+// reading the whole reply into a String first, on recorded OpenWeather replies
+//
+// Peak memory is what the parse takes from the allocator, plus the payload copy for the
+// String path. Both paths must agree on every field the banner uses.
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <ArduinoJson.h>
+#include "check.h"
+
+// Tracks what is live at once, as the heap would see it
+struct PeakAllocator : ArduinoJson::Allocator
+{
+    size_t current = 0, peak = 0;
+
+    void *allocate(size_t n) override
+    {
+        size_t *p = (size_t *)malloc(n + sizeof(size_t));
+        *p = n;
+        grow(n);
+        return p + 1;
+    }
+    void deallocate(void *ptr) override
+    {
+        if (!ptr)
+            return;
+        size_t *p = (size_t *)ptr - 1;
+        current -= *p;
+        free(p);
+    }
+    void *reallocate(void *ptr, size_t n) override
+    {
+        if (!ptr)
+            return allocate(n);
+        size_t *p = (size_t *)ptr - 1;
+        current -= *p;
+        p = (size_t *)realloc(p, n + sizeof(size_t));
+        *p = n;
+        grow(n);
+        return p + 1;
+    }
+    void grow(size_t n)
+    {
+        current += n;
+        if (current > peak)
+            peak = current;
+    }
+};
+
+// The fields the banner shows, as one string to compare
+static std::string fields(const JsonDocument &doc)
+{
+    char b[256];
+    snprintf(b, sizeof(b), "%s|%s|%.2f|%d|%s|%ld|%ld|%ld", doc["name"].as<const char *>(), doc["sys"]["country"].as<const char *>(),
+             doc["main"]["temp"].as<float>(), doc["main"]["humidity"].as<int>(), doc["weather"][0]["description"].as<const char *>(),
+             doc["dt"].as<long>(), doc["sys"]["sunrise"].as<long>(), doc["sys"]["sunset"].as<long>());
+    return b;
+}
+
+int main()
+{
+    // As built in setup() in main.cpp
+    JsonDocument filter;
+    filter["name"] = true;
+    filter["dt"] = true;
+    filter["main"]["temp"] = true;
+    filter["main"]["humidity"] = true;
+    filter["weather"][0]["description"] = true;
+    filter["sys"]["country"] = true;
+    filter["sys"]["sunrise"] = true;
+    filter["sys"]["sunset"] = true;
+
+    const char *payloads[] = {"fixtures/weather_clear.json", "fixtures/weather_rain.json", "fixtures/weather_snow.json"};
+    const int ROUNDS = 20000;
+    for (const char *path : payloads)
+    {
+        std::ifstream in(path);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        const std::string body = ss.str();
+        CHECK(!body.empty());
+
+        // Before: http.getString(), then a full parse of the copy
+        std::string before;
+        size_t peakBefore = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            PeakAllocator allocator;
+            std::string payload(body.begin(), body.end());
+            JsonDocument doc(&allocator);
+            CHECK(!deserializeJson(doc, payload));
+            if (!r)
+                before = fields(doc);
+            peakBefore = std::max(peakBefore, allocator.peak + payload.capacity() + 1);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        // After: parse straight from the stream, keeping only the filtered fields
+        std::string after;
+        size_t peakAfter = 0, kept = 0;
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            PeakAllocator allocator;
+            std::istringstream stream(body);
+            JsonDocument doc(&allocator);
+            CHECK(!deserializeJson(doc, stream, DeserializationOption::Filter(filter)));
+            if (!r)
+            {
+                after = fields(doc);
+                kept = measureJson(doc);
+                CHECK(!doc["coord"] && !doc["wind"] && !doc["main"]["pressure"]);
+            }
+            peakAfter = std::max(peakAfter, allocator.peak);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+
+        auto us = [&](std::chrono::steady_clock::duration d) { return std::chrono::duration<double, std::micro>(d).count() / ROUNDS; };
+        printf("%-28s %4zu B reply, %3zu B kept | getString + parse: peak %5zu B, %5.2f us | filtered stream: peak %5zu B, %5.2f us\n",
+               path, body.size(), kept, peakBefore, us(t1 - t0), peakAfter, us(t2 - t1));
+        CHECK(before == after);
+        CHECK(peakAfter < peakBefore);
+    }
+
+    return checkResult();
+}
@@ -0,0 +1,141 @@
+// test_write_behind.cpp — A burst of picker changes costs one settings write
+//
+// The settings flush of main.cpp on a virtual millisecond clock: a change marks the
+// WriteBehind dirty, a task every 250 ms saves the record through a SettingsStore when
+// due(). A colour picker dragged for three seconds must end in exactly one write holding
+// the last value; one held in motion is still written after maxDelay; an explicit save,
+// a failed write and an idle minute are checked after.
+
+#include <vector>
+#include "SettingsStore.h"
+#include "WriteBehind.h"
+#include "check.h"
+
+namespace
+{
+    // Counts the writes, and can refuse them as a full flash would
+    class CountingMedium : public SettingsStore::Medium
+    {
+    public:
+        std::vector<uint8_t> bytes;
+        int writes = 0;
+        bool refuse = false;
+
+        size_t read(uint32_t offset, uint8_t *data, size_t length) override
+        {
+            size_t n = 0;
+            for (; n < length && offset + n < bytes.size(); n++)
+                data[n] = bytes[offset + n];
+            return n;
+        }
+
+        bool write(uint32_t offset, const uint8_t *data, size_t length) override
+        {
+            if (refuse)
+                return false;
+            writes++;
+            if (bytes.size() < offset + length)
+                bytes.resize(offset + length);
+            memcpy(&bytes[offset], data, length);
+            return true;
+        }
+    };
+
+    struct Record
+    {
+        uint16_t colour;
+    };
+
+    const uint32_t QUIET_MS = 2000, MAX_DELAY_MS = 10000, FLUSH_PERIOD_MS = 250; // As in main.cpp
+
+    CountingMedium medium;
+    SettingsStore store(medium);
+    WriteBehind writeBehind(QUIET_MS, MAX_DELAY_MS);
+    Record record = {0};
+    uint32_t nowMs = 1000;
+    uint32_t lastLatencyMs = 0; // Of the latest write
+
+    // settingsFlushStep() and saveSettings()
+    void flushStep()
+    {
+        if (!writeBehind.due(nowMs))
+            return;
+        if (store.save(&record, sizeof(record), 1))
+            lastLatencyMs = writeBehind.flushed(nowMs);
+        else
+            writeBehind.failed(nowMs);
+    }
+
+    // Let time pass with the flush task running on its period
+    void runFor(uint32_t ms)
+    {
+        for (uint32_t end = nowMs + ms; nowMs != end;)
+            if (++nowMs % FLUSH_PERIOD_MS == 0)
+                flushStep();
+    }
+}
+
+int main()
+{
+    // 100 changes 30 ms apart
+    const uint32_t CHANGES = 100;
+    for (uint32_t i = 0; i < CHANGES; i++)
+    {
+        record.colour = i;
+        writeBehind.markDirty(nowMs);
+        runFor(30);
+    }
+    CHECK(medium.writes == 0); // Still dragging
+    runFor(5000);
+    printf("%u changes -> %d write(s), latency %u ms\n", CHANGES, medium.writes, lastLatencyMs);
+    CHECK(medium.writes == 1);
+    CHECK(writeBehind.stats().changes == CHANGES && writeBehind.stats().flushes == 1);
+    CHECK(lastLatencyMs <= CHANGES * 30 + QUIET_MS + FLUSH_PERIOD_MS);
+    {
+        SettingsStore boot(medium);
+        Record loaded;
+        uint16_t version;
+        CHECK(boot.load(&loaded, sizeof(loaded), version) && loaded.colour == CHANGES - 1);
+    }
+
+    // Held in motion for 15 s: written once maxDelay has passed, then once after it stops
+    medium.writes = 0;
+    for (int i = 0; i < 600; i++)
+    {
+        writeBehind.markDirty(nowMs);
+        runFor(25);
+    }
+    CHECK(medium.writes == 1 && lastLatencyMs >= MAX_DELAY_MS && lastLatencyMs < MAX_DELAY_MS + FLUSH_PERIOD_MS);
+    runFor(5000);
+    CHECK(medium.writes == 2);
+
+    // An explicit save takes the pending change with it
+    medium.writes = 0;
+    writeBehind.markDirty(nowMs);
+    CHECK(store.save(&record, sizeof(record), 1));
+    writeBehind.flushed(nowMs);
+    CHECK(!writeBehind.dirty());
+    runFor(5000);
+    CHECK(medium.writes == 1);
+
+    // A failed write is tried again a quiet period later, the latency counts from the change
+    medium.writes = 0;
+    medium.refuse = true;
+    uint32_t changedMs = nowMs;
+    writeBehind.markDirty(nowMs);
+    runFor(QUIET_MS + FLUSH_PERIOD_MS);
+    CHECK(writeBehind.dirty() && medium.writes == 0);
+    medium.refuse = false;
+    runFor(QUIET_MS / 2);
+    CHECK(writeBehind.dirty()); // Not before the next quiet period
+    runFor(QUIET_MS);
+    CHECK(!writeBehind.dirty() && medium.writes == 1);
+    CHECK(lastLatencyMs >= 2 * QUIET_MS && lastLatencyMs <= nowMs - changedMs);
+
+    // Nothing changed, nothing written
+    medium.writes = 0;
+    runFor(60000);
+    CHECK(medium.writes == 0);
+
+    return checkResult();
+}
@@ -0,0 +1,73 @@
+# build_assets.py — Prepares data/ for the SPIFFS image
+#
+# Text-like assets (HTML, CSS, JS, fonts, icons) are stored gzip-compressed under their
+# own name, files that do not shrink (PNG is already deflated) are copied as they are.
+# Every file gets a strong ETag, a hash of the stored bytes, listed in /assets.txt as
+# "<path> <etag> <gzip|identity>"; the web server sends it and answers If-None-Match
+# with 304. Names stay the same because SPIFFS allows 31 characters per path.
+#
+# As a PlatformIO extra script (pre:) the prepared tree goes to $BUILD_DIR/data and the
+# filesystem image is built from there. It also runs on its own:
+#   python3 scripts/build_assets.py data out
+
+import gzip
+import hashlib
+import os
+import shutil
+import sys
+
+COMPRESS = (".html", ".htm", ".css", ".js", ".json", ".svg", ".ico", ".ttf", ".txt")
+MANIFEST = "assets.txt"
+
+
+def build(source, target):
+    os.makedirs(target, exist_ok=True)
+    lines = []
+    kept = {MANIFEST}
+    for root, dirs, files in os.walk(source):
+        dirs[:] = sorted(d for d in dirs if not d.startswith("."))
+        for name in sorted(files):
+            if name.startswith(".") or name == MANIFEST:
+                continue
+            src = os.path.join(root, name)
+            rel = os.path.relpath(src, source).replace(os.sep, "/")
+            with open(src, "rb") as f:
+                data = f.read()
+
+            encoding = "identity"
+            if name.lower().endswith(COMPRESS):
+                packed = gzip.compress(data, 9, mtime=0)  # mtime 0: same input, same bytes
+                if len(packed) < len(data) * 9 // 10:
+                    data, encoding = packed, "gzip"
+
+            dst = os.path.join(target, rel)
+            os.makedirs(os.path.dirname(dst), exist_ok=True)
+            if not os.path.exists(dst) or open(dst, "rb").read() != data:
+                with open(dst, "wb") as f:
+                    f.write(data)
+            kept.add(rel)
+            etag = hashlib.sha256(data).hexdigest()[:16]
+            lines.append("/%s \"%s\" %s\n" % (rel, etag, encoding))
+            print("  /%-28s %7d bytes  %s" % (rel, len(data), encoding))
+
+    with open(os.path.join(target, MANIFEST), "w") as f:
+        f.writelines(lines)
+
+    # Files removed from the source leave the image too
+    for root, dirs, files in os.walk(target):
+        for name in files:
+            rel = os.path.relpath(os.path.join(root, name), target).replace(os.sep, "/")
+            if rel not in kept:
+                os.remove(os.path.join(root, name))
+
+
+if __name__ == "__main__":
+    build(sys.argv[1], sys.argv[2])
+else:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+
+    source = env.subst("$PROJECT_DATA_DIR")  # noqa: F821
+    target = os.path.join(env.subst("$BUILD_DIR"), "data")  # noqa: F821
+    print("Preparing web assets: %s -> %s" % (source, target))
+    build(source, target)
+    env.Replace(PROJECT_DATA_DIR=target)  # noqa: F821
@@ -0,0 +1,153 @@
+// AssetCatalog.cpp — ETags and content encodings of the web assets in SPIFFS
+
+#include "AssetCatalog.h"
+#include "FixedString.h"
+
+uint8_t AssetCatalog::load(fs::File &file)
+{
+    _count = 0;
+    char line[MAX_PATH + MAX_ETAG + 16];
+    size_t n = 0;
+    uint8_t c;
+    while (file.read(&c, 1) == 1)
+    {
+        if (c == '\n')
+        {
+            line[n] = '\0';
+            parseLine(line);
+            n = 0;
+        }
+        else if (n < sizeof(line) - 1)
+            line[n++] = c;
+    }
+    if (n)
+    {
+        line[n] = '\0';
+        parseLine(line);
+    }
+    return _count;
+}
+
+// "<path> <etag> <encoding>", malformed lines and overflow are skipped
+bool AssetCatalog::parseLine(const char *line)
+{
+    if (_count == MAX_ASSETS)
+        return false;
+
+    const char *fields[3];
+    size_t lengths[3];
+    const char *p = line;
+    for (int i = 0; i < 3; i++)
+    {
+        while (*p == ' ')
+            p++;
+        fields[i] = p;
+        while (*p && *p != ' ' && *p != '\r')
+            p++;
+        lengths[i] = p - fields[i];
+        if (!lengths[i])
+            return false;
+    }
+    if (lengths[0] >= MAX_PATH || lengths[1] >= MAX_ETAG || fields[0][0] != '/')
+        return false;
+
+    Asset &a = _assets[_count];
+    memcpy(a.path, fields[0], lengths[0]);
+    a.path[lengths[0]] = '\0';
+    memcpy(a.etag, fields[1], lengths[1]);
+    a.etag[lengths[1]] = '\0';
+    a.gzip = lengths[2] == 4 && strncmp(fields[2], "gzip", 4) == 0;
+    _count++;
+    return true;
+}
+
+bool AssetCatalog::save(fs::File &file) const
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        FixedString<MAX_PATH + MAX_ETAG + 16> line;
+        line.appendf("%s %s %s\n", _assets[i].path, _assets[i].etag, _assets[i].gzip ? "gzip" : "identity");
+        if (file.write((const uint8_t *)line.c_str(), line.length()) != line.length())
+            return false;
+    }
+    return true;
+}
+
+const AssetCatalog::Asset *AssetCatalog::find(const char *path) const
+{
+    for (uint8_t i = 0; i < _count; i++)
+        if (strcmp(_assets[i].path, path) == 0)
+            return &_assets[i];
+    return nullptr;
+}
+
+bool AssetCatalog::forget(const char *path)
+{
+    const Asset *a = find(path);
+    if (!a)
+        return false;
+    uint8_t i = a - _assets;
+    memmove(&_assets[i], &_assets[i + 1], (_count - i - 1) * sizeof(Asset));
+    _count--;
+    return true;
+}
+
+bool AssetCatalog::matches(const char *ifNoneMatch, const char *etag)
+{
+    if (!ifNoneMatch || !*ifNoneMatch)
+        return false;
+
+    // Comma separated list of quoted tags, weak ones (W/"...") compare equal as well
+    size_t etagLength = strlen(etag);
+    const char *p = ifNoneMatch;
+    while (*p)
+    {
+        while (*p == ' ' || *p == ',')
+            p++;
+        if (*p == '*')
+            return true;
+        if (p[0] == 'W' && p[1] == '/')
+            p += 2;
+        const char *end = p;
+        while (*end && *end != ',')
+            end++;
+        const char *last = end;
+        while (last > p && last[-1] == ' ')
+            last--;
+        if ((size_t)(last - p) == etagLength && strncmp(p, etag, etagLength) == 0)
+            return true;
+        p = end;
+    }
+    return false;
+}
+
+bool AssetCatalog::acceptsGzip(const char *acceptEncoding)
+{
+    if (!acceptEncoding || !*acceptEncoding)
+        return true;
+
+    // "gzip, deflate, br" or "gzip;q=1.0, identity; q=0.5, *;q=0": gzip or * with q > 0
+    int8_t gzip = -1, any = -1; // -1 not listed, 0 refused, 1 accepted
+    const char *p = acceptEncoding;
+    while (*p)
+    {
+        while (*p == ' ' || *p == ',')
+            p++;
+        const char *name = p;
+        while (*p && *p != ',' && *p != ';' && *p != ' ')
+            p++;
+        size_t length = p - name;
+        bool accepted = true;
+        while (*p && *p != ',')
+        {
+            if (*p == 'q' && p[1] == '=')
+                accepted = atof(p + 2) > 0;
+            p++;
+        }
+        if ((length == 4 && !strncasecmp(name, "gzip", 4)) || (length == 6 && !strncasecmp(name, "x-gzip", 6)))
+            gzip = accepted;
+        else if (length == 1 && *name == '*')
+            any = accepted;
+    }
+    return gzip >= 0 ? gzip == 1 : any == 1;
+}
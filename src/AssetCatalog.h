@@ -0,0 +1,55 @@
+// AssetCatalog.h — ETags and content encodings of the web assets in SPIFFS
+//
+// scripts/build_assets.py stores the text-like files of data/ gzip-compressed under their
+// own names and lists every file in /assets.txt as "<path> <etag> <gzip|identity>", the
+// ETag being a hash of the stored bytes. The catalog loads that list once at boot; the
+// file handlers send the ETag, answer a matching If-None-Match with 304 and mark gzip
+// bodies with Content-Encoding (and Vary, caches keep them apart from identity ones). A
+// file rewritten on the device (an uploaded logo) is forgotten and the list saved again,
+// so no stale ETag outlives the old content.
+
+#ifndef ASSET_CATALOG_H
+#define ASSET_CATALOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+class AssetCatalog
+{
+public:
+    static const uint8_t MAX_ASSETS = 24;
+    static const size_t MAX_PATH = 32; // SPIFFS names, terminator included
+    static const size_t MAX_ETAG = 24; // Quoted, as sent
+
+    struct Asset
+    {
+        char path[MAX_PATH];
+        char etag[MAX_ETAG];
+        bool gzip; // Stored compressed, sent with Content-Encoding: gzip
+    };
+
+    AssetCatalog() : _count(0) {}
+
+    // Read the list written by build_assets.py, returns the number of assets
+    uint8_t load(fs::File &file);
+    bool save(fs::File &file) const;
+
+    const Asset *find(const char *path) const;
+    // Drop a file whose content changed, returns false if it was not listed
+    bool forget(const char *path);
+    uint8_t count() const { return _count; }
+
+    // If-None-Match header value against an ETag: "*" or any listed tag matches
+    static bool matches(const char *ifNoneMatch, const char *etag);
+    // Accept-Encoding header value: a gzip body may be sent unless the header lists
+    // codings and gzip is not one of them (or has q=0). No header accepts any coding.
+    static bool acceptsGzip(const char *acceptEncoding);
+
+private:
+    bool parseLine(const char *line);
+
+    Asset _assets[MAX_ASSETS];
+    uint8_t _count;
+};
+
+#endif // ASSET_CATALOG_H
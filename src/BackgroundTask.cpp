@@ -0,0 +1,79 @@
+// BackgroundTask.cpp — Thread started alongside loop()
+
+#include "BackgroundTask.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <time.h>
+#else
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+BackgroundTask::BackgroundTask() : _running(false)
+{
+}
+
+#if defined(__linux__)
+
+namespace
+{
+    struct ThreadStart
+    {
+        BackgroundTask::TaskBody body;
+        void *arg;
+    };
+
+    void *threadEntry(void *p)
+    {
+        ThreadStart start = *(ThreadStart *)p;
+        delete (ThreadStart *)p;
+        start.body(start.arg);
+        return nullptr;
+    }
+}
+
+// A plain thread: the name, stack size, priority and core only mean something to FreeRTOS
+bool BackgroundTask::start(const char *, TaskBody body, void *arg, uint32_t, uint8_t, int8_t)
+{
+    if (_running)
+        return false;
+
+    pthread_t thread;
+    ThreadStart *start = new ThreadStart{body, arg};
+    if (pthread_create(&thread, nullptr, threadEntry, start) != 0)
+    {
+        delete start;
+        return false;
+    }
+    pthread_detach(thread);
+    _running = true;
+    return true;
+}
+
+void BackgroundTask::sleepMs(uint32_t ms)
+{
+    struct timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, nullptr);
+}
+
+#else
+
+bool BackgroundTask::start(const char *name, TaskBody body, void *arg, uint32_t stackBytes, uint8_t priority, int8_t core)
+{
+    if (_running)
+        return false;
+
+    // FreeRTOS on the ESP32 counts the stack in bytes
+    if (xTaskCreatePinnedToCore(body, name, stackBytes, arg, priority, nullptr, core) != pdPASS)
+        return false;
+    _running = true;
+    return true;
+}
+
+void BackgroundTask::sleepMs(uint32_t ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms) ? pdMS_TO_TICKS(ms) : 1);
+}
+
+#endif
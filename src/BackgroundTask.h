@@ -0,0 +1,31 @@
+// BackgroundTask.h — Thread started alongside loop()
+//
+// On the ESP32 this is a FreeRTOS task pinned to a core (core 0 for networking, the
+// Arduino loop runs on core 1). In a Linux host build the same code runs as a pthread,
+// core and priority are ignored, so the hand-over between the two sides can be tested
+// with the usual thread tools.
+
+#ifndef BACKGROUND_TASK_H
+#define BACKGROUND_TASK_H
+
+#include <Arduino.h>
+
+class BackgroundTask
+{
+public:
+    typedef void (*TaskBody)(void *arg);
+
+    BackgroundTask();
+
+    // The body normally never returns; returns false if the task could not be created
+    bool start(const char *name, TaskBody body, void *arg, uint32_t stackBytes, uint8_t priority, int8_t core);
+    bool running() const { return _running; }
+
+    // Give up the CPU for at least ms milliseconds, call from inside the body
+    static void sleepMs(uint32_t ms);
+
+private:
+    bool _running;
+};
+
+#endif // BACKGROUND_TASK_H
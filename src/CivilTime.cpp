@@ -0,0 +1,135 @@
+// CivilTime.cpp — Allocation-free epoch to calendar date and HH:MM:SS conversion
+
+#include "CivilTime.h"
+
+namespace
+{
+    const uint8_t monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    // "00".."99", two characters per entry
+    const char twoDigits[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    inline void put2(char *p, uint8_t v)
+    {
+        p[0] = twoDigits[2 * v];
+        p[1] = twoDigits[2 * v + 1];
+    }
+
+    inline void put3(char *p, uint8_t a, uint8_t b, uint8_t c, char sep)
+    {
+        put2(p, a);
+        p[2] = sep;
+        put2(p + 3, b);
+        p[5] = sep;
+        put2(p + 6, c);
+        p[8] = '\0';
+    }
+}
+
+bool isLeapYear(int32_t year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+uint8_t daysInMonth(int32_t year, uint8_t month)
+{
+    return (month == 2 && isLeapYear(year)) ? 29 : monthDays[month - 1];
+}
+
+void civilFromEpoch(int64_t epoch, CivilTime &t)
+{
+    // Floor division so times before 1970 also land on the right day
+    int64_t days = epoch / 86400;
+    int32_t secs = (int32_t)(epoch - days * 86400);
+    if (secs < 0)
+    {
+        secs += 86400;
+        days--;
+    }
+    t.hour = secs / 3600;
+    t.minute = (secs / 60) % 60;
+    t.second = secs % 60;
+    t.weekday = (uint8_t)(((days % 7) + 11) % 7); // 1970-01-01 was a Thursday
+
+    // Days to civil date in the proleptic Gregorian calendar, eras of 400 years
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);                          // [0, 146096]
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);               // [0, 365], from March 1st
+    uint32_t mp = (5 * doy + 2) / 153;                                    // [0, 11], March is 0
+    t.day = doy - (153 * mp + 2) / 5 + 1;
+    t.month = mp < 10 ? mp + 3 : mp - 9;
+    t.year = (int16_t)(yoe + era * 400 + (t.month <= 2));
+}
+
+int64_t daysFromCivil(int32_t year, uint8_t month, uint8_t day)
+{
+    int32_t y = year - (month <= 2);
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t mp = month > 2 ? month - 3 : month + 9;      // March is 0
+    uint32_t yoe = (uint32_t)(y - era * 400);             // [0, 399]
+    uint32_t doy = (153 * mp + 2) / 5 + day - 1;          // [0, 365], from March 1st
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy; // [0, 146096]
+    return (int64_t)era * 146097 + doe - 719468;
+}
+
+void civilNextSecond(CivilTime &t)
+{
+    if (++t.second < 60)
+        return;
+    t.second = 0;
+    if (++t.minute < 60)
+        return;
+    t.minute = 0;
+    if (++t.hour < 24)
+        return;
+    t.hour = 0;
+    t.weekday = (t.weekday + 1) % 7;
+    if (++t.day <= daysInMonth(t.year, t.month))
+        return;
+    t.day = 1;
+    if (++t.month <= 12)
+        return;
+    t.month = 1;
+    t.year++;
+}
+
+void formatHMS(const CivilTime &t, char *buf)
+{
+    put3(buf, t.hour, t.minute, t.second, ':');
+}
+
+void formatDMY(const CivilTime &t, char *buf)
+{
+    put3(buf, t.day, t.month, (uint8_t)(((t.year % 100) + 100) % 100), ':');
+}
+
+CivilClock::CivilClock() : _epoch(0), _valid(false), _conversions(0)
+{
+    memset(&_time, 0, sizeof(_time));
+}
+
+const CivilTime &CivilClock::at(int64_t epoch)
+{
+    if (_valid && epoch == _epoch + 1)
+        civilNextSecond(_time);
+    else if (!_valid || epoch != _epoch)
+    {
+        civilFromEpoch(epoch, _time);
+        _conversions++;
+    }
+    _epoch = epoch;
+    _valid = true;
+    return _time;
+}
@@ -0,0 +1,60 @@
+// CivilTime.h — Allocation-free epoch to calendar date and HH:MM:SS conversion
+//
+// civilFromEpoch() does a full conversion with the days-from-civil arithmetic (no tables
+// of years, no libc time zone state). CivilClock keeps the last converted second and, for
+// the common case of the next second, only increments the fields with the days-per-month
+// table. Formatting writes into caller buffers through a two-digit lookup table, so the
+// clock path never touches the heap. Epochs are seconds since 1970, times are as given
+// (UTC unless the caller already added an offset).
+
+#ifndef CIVIL_TIME_H
+#define CIVIL_TIME_H
+
+#include <Arduino.h>
+
+struct CivilTime
+{
+    int16_t year;    // e.g. 2026
+    uint8_t month;   // 1-12
+    uint8_t day;     // 1-31
+    uint8_t hour;    // 0-23
+    uint8_t minute;  // 0-59
+    uint8_t second;  // 0-59
+    uint8_t weekday; // 0 is Sunday
+};
+
+// Buffer sizes including the terminator
+const size_t CIVIL_HMS_SIZE = 9; // "HH:MM:SS"
+const size_t CIVIL_DMY_SIZE = 9; // "DD:MM:YY"
+
+void civilFromEpoch(int64_t epoch, CivilTime &t);
+// Days since 1970-01-01 of a proleptic Gregorian date, the inverse of the date part above
+int64_t daysFromCivil(int32_t year, uint8_t month, uint8_t day);
+bool isLeapYear(int32_t year);
+uint8_t daysInMonth(int32_t year, uint8_t month);
+// Advance by one second, rolling over minutes, days, months and years
+void civilNextSecond(CivilTime &t);
+
+// Write "HH:MM:SS" and "DD:MM:YY", buf must hold the sizes above
+void formatHMS(const CivilTime &t, char *buf);
+void formatDMY(const CivilTime &t, char *buf);
+
+class CivilClock
+{
+public:
+    CivilClock();
+
+    // Calendar fields for epoch: incremental if it is the next second, else a full conversion
+    const CivilTime &at(int64_t epoch);
+
+    // Full conversions done so far (the rest were increments or repeats)
+    uint32_t conversions() const { return _conversions; }
+
+private:
+    int64_t _epoch;
+    bool _valid;
+    CivilTime _time;
+    uint32_t _conversions;
+};
+
+#endif // CIVIL_TIME_H
@@ -0,0 +1,168 @@
+// ClockGlyphCache.cpp — Pre-rendered glyphs for the 7-segment clock fonts
+
+#include "ClockGlyphCache.h"
+
+static const char cachedChars[ClockGlyphCache::GLYPH_COUNT + 1] = "0123456789:";
+
+ClockGlyphCache::ClockGlyphCache(TFT_eSPI *tft)
+    : _tft(tft), _font(nullptr), _cell()
+{
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++)
+        _glyph[i] = nullptr;
+}
+
+ClockGlyphCache::~ClockGlyphCache()
+{
+    release();
+}
+
+int8_t ClockGlyphCache::indexOf(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c == ':')
+        return 10;
+    return -1;
+}
+
+void ClockGlyphCache::release()
+{
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++)
+    {
+        if (_glyph[i])
+        {
+            _glyph[i]->deleteSprite();
+            delete _glyph[i];
+            _glyph[i] = nullptr;
+        }
+    }
+    _font = nullptr;
+}
+
+// Union of the glyph boxes of chars, relative to the pen position and a top-left datum
+bool ClockGlyphCache::bounds(const GFXfont *font, const char *chars, int16_t glyphAb, Cell &cell)
+{
+    uint16_t first = pgm_read_word(&font->first);
+    uint16_t last = pgm_read_word(&font->last);
+    GFXglyph *glyphs = (GFXglyph *)pgm_read_dword(&font->glyph);
+
+    int16_t x0 = INT16_MAX, y0 = INT16_MAX, x1 = INT16_MIN, y1 = INT16_MIN;
+    for (; *chars; chars++)
+    {
+        uint16_t c = (uint8_t)*chars;
+        if (c < first || c > last)
+            return false;
+        GFXglyph *g = &glyphs[c - first];
+        int16_t xo = (int8_t)pgm_read_byte(&g->xOffset);
+        int16_t yo = (int8_t)pgm_read_byte(&g->yOffset);
+        int16_t w = pgm_read_byte(&g->width);
+        int16_t h = pgm_read_byte(&g->height);
+        if (!w || !h)
+            continue;
+        x0 = min(x0, xo);
+        y0 = min(y0, yo);
+        x1 = max(x1, (int16_t)(xo + w));
+        y1 = max(y1, (int16_t)(yo + h));
+    }
+    if (x0 >= x1 || y0 >= y1)
+        return false;
+
+    cell = {x0, (int16_t)(glyphAb + y0), (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+    return true;
+}
+
+bool ClockGlyphCache::build(const GFXfont *font)
+{
+    release();
+    if (!font)
+        return false;
+
+    // Same baseline offset drawString() uses for a top-left datum (see TFT_eSPI::setFreeFont)
+    uint16_t glyphCount = pgm_read_word(&font->last) - pgm_read_word(&font->first) + 1;
+    GFXglyph *glyphs = (GFXglyph *)pgm_read_dword(&font->glyph);
+    int16_t glyphAb = 0;
+    for (uint16_t c = 0; c < glyphCount; c++)
+    {
+        int8_t ab = -(int8_t)pgm_read_byte(&glyphs[c].yOffset);
+        if (ab > glyphAb)
+            glyphAb = ab;
+    }
+
+    if (!bounds(font, "0123456789", glyphAb, _cell[0]) || !bounds(font, ":", glyphAb, _cell[1]))
+        return false;
+
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++)
+    {
+        const Cell &c = cell(cachedChars[i]);
+        _glyph[i] = new TFT_eSprite(_tft);
+        _glyph[i]->setColorDepth(1);
+        if (!_glyph[i]->createSprite(c.w, c.h))
+        {
+            release();
+            return false;
+        }
+        _glyph[i]->fillSprite(TFT_BLACK);
+        _glyph[i]->setFreeFont(font);
+        // Any non-zero colour sets a bit in a 1-bit sprite; fg == bg draws transparently
+        _glyph[i]->drawChar(-c.x, glyphAb - c.y, cachedChars[i], TFT_WHITE, TFT_WHITE, 1);
+    }
+
+    _font = font;
+    return true;
+}
+
+bool ClockGlyphCache::drawChar(char c, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour)
+{
+    int8_t i = indexOf(c);
+    if (i < 0 || !_glyph[i])
+        return false;
+
+    _glyph[i]->setBitmapColor(fgColour, bgColour);
+    _glyph[i]->pushSprite(x + cell(c).x, y + cell(c).y);
+    return true;
+}
+
+bool ClockGlyphCache::glyphPixel(char c, int16_t cx, int16_t cy) const
+{
+    int8_t i = indexOf(c);
+    const Cell &cc = cell(c);
+    if (i < 0 || !_glyph[i] || cx < 0 || cy < 0 || cx >= cc.w || cy >= cc.h)
+        return false;
+
+    // 1-bit sprite rows are padded to whole bytes, MSB first
+    const uint8_t *img = (const uint8_t *)_glyph[i]->getPointer();
+    uint16_t stride = (cc.w + 7) >> 3;
+    return img[cy * stride + (cx >> 3)] & (0x80 >> (cx & 7));
+}
+
+bool ClockGlyphCache::drawCellRegion(char c, int32_t x, int32_t y, int16_t rx, int16_t ry, int16_t rw, int16_t rh,
+                                     uint16_t fgColour, uint16_t bgColour)
+{
+    int8_t i = indexOf(c);
+    if (i < 0 || !_glyph[i])
+        return false;
+
+    // Clip the region to the cell
+    const Cell &cc = cell(c);
+    if (rx < 0) { rw += rx; rx = 0; }
+    if (ry < 0) { rh += ry; ry = 0; }
+    if (rx + rw > cc.w) rw = cc.w - rx;
+    if (ry + rh > cc.h) rh = cc.h - ry;
+    if (rw <= 0 || rh <= 0)
+        return true;
+
+    uint16_t lineBuf[rw];
+    bool swap = _tft->getSwapBytes();
+    _tft->setSwapBytes(true); // Line buffer holds native RGB565 values
+    _tft->startWrite();
+    _tft->setAddrWindow(x + cc.x + rx, y + cc.y + ry, rw, rh);
+    for (int16_t cy = ry; cy < ry + rh; cy++)
+    {
+        for (int16_t cx = 0; cx < rw; cx++)
+            lineBuf[cx] = glyphPixel(c, rx + cx, cy) ? fgColour : bgColour;
+        _tft->pushPixels(lineBuf, rw);
+    }
+    _tft->endWrite();
+    _tft->setSwapBytes(swap);
+    return true;
+}
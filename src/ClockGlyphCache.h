@@ -0,0 +1,62 @@
+// ClockGlyphCache.h — Pre-rendered '0'-'9' and ':' glyphs for the 7-segment clock fonts
+//
+// Each glyph is rasterised once into a 1-bit sprite covering its character cell: the
+// union of the ten digit boxes for '0'-'9', the colon's own box for ':'. Drawing a
+// character is then a single opaque windowed push of that cell in the requested
+// colours, which also erases whatever digit was there before. The colon gets a cell of
+// its own because the clock sets it 30 px after a digit, closer than the digit cell is
+// wide; a cell shared by all eleven glyphs would blank the digit's right edge. Colour
+// is applied at push time, so a colour change from the web page needs no
+// re-rasterisation; only a font change rebuilds the cache.
+
+#ifndef CLOCK_GLYPH_CACHE_H
+#define CLOCK_GLYPH_CACHE_H
+
+#include <TFT_eSPI.h>
+
+class ClockGlyphCache
+{
+public:
+    static const uint8_t GLYPH_COUNT = 11; // '0'..'9' and ':'
+
+    // Character cell, relative to the drawString() x,y
+    struct Cell
+    {
+        int16_t x, y, w, h;
+    };
+
+    explicit ClockGlyphCache(TFT_eSPI *tft);
+    ~ClockGlyphCache();
+
+    // Rasterise the glyphs of a GFX free font, returns false if sprites could not be allocated
+    bool build(const GFXfont *font);
+    void release();
+
+    // Font the cache currently holds (nullptr when empty)
+    const GFXfont *font() const { return _font; }
+
+    // Draw a cached character at the same x,y a top-left datum drawString() would use.
+    // Returns false if the character is not cached (caller should fall back to drawString).
+    bool drawChar(char c, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour);
+
+    // Push only part of a cached cell (rectangle in cell coordinates) in one window
+    bool drawCellRegion(char c, int32_t x, int32_t y, int16_t rx, int16_t ry, int16_t rw, int16_t rh,
+                        uint16_t fgColour, uint16_t bgColour);
+
+    // True if the cached glyph lights the cell pixel cx,cy
+    bool glyphPixel(char c, int16_t cx, int16_t cy) const;
+
+    // Cell of a character: the colon's for ':', the digit cell for anything else
+    const Cell &cell(char c) const { return _cell[c == ':']; }
+
+private:
+    static int8_t indexOf(char c);
+    static bool bounds(const GFXfont *font, const char *chars, int16_t glyphAb, Cell &cell);
+
+    TFT_eSPI *_tft;
+    TFT_eSprite *_glyph[GLYPH_COUNT];
+    const GFXfont *_font;
+    Cell _cell[2]; // Digits, colon
+};
+
+#endif // CLOCK_GLYPH_CACHE_H
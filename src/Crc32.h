@@ -0,0 +1,15 @@
+// Crc32.h — The standard CRC-32 of PNG and zlib, four bits at a time
+//
+// PngChecker checks every chunk of an upload with it and SettingsStore seals its slots.
+// The table is 16 entries (64 bytes) instead of zlib's 1 kB; both callers feed short
+// buffers, so the halved speed does not show.
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <Arduino.h>
+
+// crc is the running value, 0 to start; crc32Update(0, "123456789", 9) is 0xcbf43926
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t length);
+
+#endif // CRC32_H
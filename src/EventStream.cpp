@@ -0,0 +1,152 @@
+// EventStream.cpp — Server-Sent Events to the web page over long-lived connections
+
+#include "EventStream.h"
+
+#include <errno.h>
+#if defined(__linux__)
+#include <sys/socket.h>
+#define EVENT_SEND_FLAGS (MSG_DONTWAIT | MSG_NOSIGNAL)
+#else
+#include <lwip/sockets.h>
+#define EVENT_SEND_FLAGS MSG_DONTWAIT
+#endif
+
+namespace
+{
+    const char RESPONSE_HEADERS[] = "HTTP/1.1 200 OK\r\n"
+                                    "Content-Type: text/event-stream\r\n"
+                                    "Cache-Control: no-cache\r\n"
+                                    "Connection: keep-alive\r\n"
+                                    "\r\n"
+                                    "retry: 3000\n\n"; // EventSource reconnect delay, ms
+    const char HEARTBEAT[] = ":\n\n";
+}
+
+EventStream::EventStream() : _clients(0), _stats()
+{
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+        _slots[i].open = false;
+}
+
+bool EventStream::add(WiFiClient &client)
+{
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+    {
+        Client &c = _slots[i];
+        if (c.open)
+            continue;
+        c.open = true;
+        c.client = client;
+        c.head = c.tail = 0;
+        c.lastProgressMs = c.lastQueuedMs = millis();
+        enqueue(c, RESPONSE_HEADERS, sizeof(RESPONSE_HEADERS) - 1);
+        _clients++;
+        _stats.accepted++;
+        return true;
+    }
+    return false;
+}
+
+bool EventStream::enqueue(Client &c, const char *data, size_t length)
+{
+    if (QUEUE_BYTES - (c.tail - c.head) < length)
+        return false;
+    if (QUEUE_BYTES - c.tail < length)
+    {
+        // Move what is waiting to the front, the queue is small
+        memmove(c.queue, c.queue + c.head, c.tail - c.head);
+        c.tail -= c.head;
+        c.head = 0;
+    }
+    if (c.head == c.tail)
+        c.lastProgressMs = millis(); // The idle timeout runs from the first waiting byte
+    memcpy(c.queue + c.tail, data, length);
+    c.tail += length;
+    c.lastQueuedMs = millis();
+    return true;
+}
+
+void EventStream::broadcast(const char *event, const char *data)
+{
+    if (!_clients)
+        return;
+
+    // "event: name\n" then "data: line\n" per line, a blank line ends the event
+    size_t n = snprintf(_event, MAX_EVENT, "event: %s\n", event);
+    const char *line = data;
+    while (n < MAX_EVENT)
+    {
+        const char *end = strchr(line, '\n');
+        size_t length = end ? (size_t)(end - line) : strlen(line);
+        if (n + 6 + length + 2 > MAX_EVENT)
+            return; // Too long to send whole, never sent cut
+        memcpy(_event + n, "data: ", 6);
+        memcpy(_event + n + 6, line, length);
+        n += 6 + length;
+        _event[n++] = '\n';
+        if (!end)
+            break;
+        line = end + 1;
+    }
+    _event[n++] = '\n';
+
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+    {
+        Client &c = _slots[i];
+        if (c.open && !enqueue(c, _event, n))
+            close(c); // Too slow to keep up, it reconnects and starts from fresh state
+    }
+    _stats.events++;
+}
+
+void EventStream::service()
+{
+    if (!_clients)
+        return;
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+    {
+        Client &c = _slots[i];
+        if (!c.open)
+            continue;
+        if (c.head == c.tail && now - c.lastQueuedMs >= HEARTBEAT_MS)
+            enqueue(c, HEARTBEAT, sizeof(HEARTBEAT) - 1);
+        if (c.head != c.tail)
+            sendSome(c);
+    }
+}
+
+void EventStream::sendSome(Client &c)
+{
+    int fd = c.client.fd();
+    if (fd < 0)
+    {
+        close(c);
+        return;
+    }
+    ssize_t n = send(fd, c.queue + c.head, c.tail - c.head, EVENT_SEND_FLAGS);
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+    {
+        close(c); // Tab closed or connection lost
+        return;
+    }
+    if (n > 0)
+    {
+        c.head += n;
+        if (c.head == c.tail)
+            c.head = c.tail = 0;
+        c.lastProgressMs = millis();
+        _stats.bytes += n;
+    }
+    else if (millis() - c.lastProgressMs > IDLE_TIMEOUT_MS)
+        close(c);
+}
+
+void EventStream::close(Client &c)
+{
+    c.client.stop();
+    c.client = WiFiClient();
+    c.open = false;
+    _clients--;
+    _stats.dropped++;
+}
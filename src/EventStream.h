@@ -0,0 +1,75 @@
+// EventStream.h — Server-Sent Events to the web page over long-lived connections
+//
+// The page used to learn about the clock by fetching: a new connection that the
+// synchronous WebServer had to accept, answer and close for every question. Here a page
+// opens /events once and the device pushes what changes (time ticks, banner text,
+// settings) as text/event-stream. The request handler passes the connection over, as
+// for HttpStreamer; broadcast() formats an event once and appends it to the queue of
+// every client, service() moves queued bytes to the sockets without waiting
+// (MSG_DONTWAIT) and sends a comment line when a client had nothing for a while, which
+// is how a closed tab is noticed.
+//
+// The cost per client is bounded: MAX_CLIENTS slots, each with a QUEUE_BYTES queue and no
+// heap. A client whose queue cannot take the next event, or that takes no bytes for
+// IDLE_TIMEOUT_MS, is dropped; the browser's EventSource connects again by itself.
+
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+class EventStream
+{
+public:
+    static const uint8_t MAX_CLIENTS = 4;
+    static const size_t QUEUE_BYTES = 1024;         // Per client
+    static const size_t MAX_EVENT = 768;            // Formatted, event and data lines
+    static const uint32_t HEARTBEAT_MS = 15000;     // Comment line after this long without an event
+    static const uint32_t IDLE_TIMEOUT_MS = 10000;  // Queued bytes not taken for this long drops the client
+
+    struct Stats
+    {
+        uint32_t accepted; // Connections taken over
+        uint32_t dropped;  // Slow, idle or closed clients removed
+        uint32_t events;   // broadcast() calls while a client was connected
+        uint64_t bytes;    // Sent to sockets, headers included
+    };
+
+    EventStream();
+
+    // Take over a client that sent GET /events: the response headers are queued here.
+    // Returns false when every slot is busy; the caller still owns the client then.
+    bool add(WiFiClient &client);
+
+    // Queue "event: <event>" and one "data:" line per line of data to every client
+    void broadcast(const char *event, const char *data);
+
+    // Send queued bytes and heartbeats, call every scheduler slice
+    void service();
+
+    uint8_t clients() const { return _clients; }
+    const Stats &stats() const { return _stats; }
+
+private:
+    struct Client
+    {
+        bool open;
+        WiFiClient client;
+        uint8_t queue[QUEUE_BYTES];
+        size_t head, tail;       // Bytes [head, tail) are waiting
+        uint32_t lastProgressMs; // millis() of the last byte the socket took
+        uint32_t lastQueuedMs;   // millis() of the last event or heartbeat queued
+    };
+
+    bool enqueue(Client &c, const char *data, size_t length);
+    void sendSome(Client &c);
+    void close(Client &c);
+
+    Client _slots[MAX_CLIENTS];
+    uint8_t _clients;
+    Stats _stats;
+    char _event[MAX_EVENT]; // One formatted event, copied to each queue
+};
+
+#endif // EVENT_STREAM_H
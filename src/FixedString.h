@@ -0,0 +1,103 @@
+// FixedString.h — Fixed-capacity string for the paths that run all day
+//
+// The characters live inside the object (a global, a stack frame or a mailbox slot), so
+// building, copying and formatting never touch the heap. Text that does not fit is cut
+// at the capacity and truncated() reports it; the buffer is always terminated. N counts
+// the terminator, a FixedString<320> holds 319 characters.
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+template <size_t N>
+class FixedString
+{
+    static_assert(N >= 2, "FixedString needs room for a character and the terminator");
+
+public:
+    FixedString() { clear(); }
+    FixedString(const char *text)
+    {
+        clear();
+        append(text);
+    }
+
+    FixedString &operator=(const char *text)
+    {
+        clear();
+        return append(text);
+    }
+
+    void clear()
+    {
+        _buf[0] = '\0';
+        _len = 0;
+        _truncated = false;
+    }
+
+    FixedString &append(const char *text)
+    {
+        if (!text)
+            return *this;
+        size_t n = strlen(text);
+        if (n > N - 1 - _len)
+        {
+            n = N - 1 - _len;
+            _truncated = true;
+        }
+        memcpy(_buf + _len, text, n);
+        _len += n;
+        _buf[_len] = '\0';
+        return *this;
+    }
+
+    FixedString &append(char c)
+    {
+        if (_len == N - 1)
+            _truncated = true;
+        else
+        {
+            _buf[_len++] = c;
+            _buf[_len] = '\0';
+        }
+        return *this;
+    }
+
+    // printf-style append
+    __attribute__((format(printf, 2, 3))) FixedString &appendf(const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(_buf + _len, N - _len, format, args);
+        va_end(args);
+        if (n < 0)
+            _buf[_len] = '\0';
+        else if ((size_t)n > N - 1 - _len)
+        {
+            _len = N - 1;
+            _truncated = true;
+        }
+        else
+            _len += n;
+        return *this;
+    }
+
+    FixedString &operator+=(const char *text) { return append(text); }
+    FixedString &operator+=(char c) { return append(c); }
+
+    const char *c_str() const { return _buf; }
+    size_t length() const { return _len; }
+    bool isEmpty() const { return _len == 0; }
+    bool truncated() const { return _truncated; }
+    static size_t capacity() { return N - 1; }
+
+private:
+    char _buf[N];
+    size_t _len;
+    bool _truncated;
+};
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,58 @@
+// HeapMonitor.cpp — Free heap and largest free block over the device's uptime
+
+#include "HeapMonitor.h"
+
+#if !defined(__linux__)
+#include <esp_heap_caps.h>
+#endif
+
+namespace
+{
+    void keepLowest(HeapMonitor::Sample &low, const HeapMonitor::Sample &s)
+    {
+        if (s.freeBytes < low.freeBytes)
+            low.freeBytes = s.freeBytes;
+        if (s.largestBlock < low.largestBlock)
+            low.largestBlock = s.largestBlock;
+    }
+
+    const HeapMonitor::Sample none = {UINT32_MAX, UINT32_MAX};
+}
+
+HeapMonitor::HeapMonitor(uint32_t intervalS, Sampler sampler)
+    : _sampler(sampler), _intervalS(intervalS ? intervalS : 1), _samples(0), _slotSamples(0),
+      _current({0, 0}), _lowest(none), _slot(none), _head(0), _count(0)
+{
+}
+
+#if !defined(__linux__)
+void HeapMonitor::espSampler(Sample &sample)
+{
+    sample.freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    sample.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+#endif
+
+void HeapMonitor::sample()
+{
+    _sampler(_current);
+    _samples++;
+    keepLowest(_lowest, _current);
+    keepLowest(_slot, _current);
+
+    if (++_slotSamples < _intervalS)
+        return;
+    _history[_head] = _slot;
+    _head = (_head + 1) % HISTORY;
+    if (_count < HISTORY)
+        _count++;
+    _slot = none;
+    _slotSamples = 0;
+}
+
+uint8_t HeapMonitor::fragmentation() const
+{
+    if (!_current.freeBytes || _current.largestBlock >= _current.freeBytes)
+        return 0;
+    return (uint8_t)((uint64_t)(_current.freeBytes - _current.largestBlock) * 100 / _current.freeBytes);
+}
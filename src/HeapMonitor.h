@@ -0,0 +1,58 @@
+// HeapMonitor.h — Free heap and largest free block over the device's uptime
+//
+// A TLS handshake needs one contiguous block of several kB, so a heap can have plenty
+// of free memory and still fail once it is fragmented. sample() is called once per
+// second: it keeps the current values, the all-time lows and a ring of history slots,
+// each holding the lowest free heap and largest block seen in its interval. On the
+// ESP32 the numbers come from heap_caps for 8-bit capable memory; a host build passes
+// its own sampler.
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+
+class HeapMonitor
+{
+public:
+    struct Sample
+    {
+        uint32_t freeBytes;    // Free heap
+        uint32_t largestBlock; // Largest single allocation possible
+    };
+    typedef void (*Sampler)(Sample &sample);
+
+    static const uint8_t HISTORY = 96;
+
+#if defined(__linux__)
+    HeapMonitor(uint32_t intervalS, Sampler sampler);
+#else
+    explicit HeapMonitor(uint32_t intervalS = 900, Sampler sampler = espSampler);
+    static void espSampler(Sample &sample);
+#endif
+
+    // Take a sample, call once per second
+    void sample();
+
+    const Sample &current() const { return _current; }
+    const Sample &lowest() const { return _lowest; }
+    // Free heap minus largest block as a share of free heap, in percent
+    uint8_t fragmentation() const;
+
+    // Completed history slots, 0 is the oldest
+    uint8_t historyCount() const { return _count; }
+    const Sample &history(uint8_t i) const { return _history[(_head + HISTORY - _count + i) % HISTORY]; }
+    uint32_t intervalS() const { return _intervalS; }
+    uint32_t samples() const { return _samples; }
+
+private:
+    Sampler _sampler;
+    uint32_t _intervalS;
+    uint32_t _samples;
+    uint32_t _slotSamples; // Samples in the slot being filled
+    Sample _current, _lowest, _slot;
+    Sample _history[HISTORY];
+    uint8_t _head, _count;
+};
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,239 @@
+// HttpStreamer.cpp — Files sent to web clients in small pieces between scheduler slices
+
+#include "HttpStreamer.h"
+
+#include <errno.h>
+#if defined(__linux__)
+#include <sys/select.h>
+#include <sys/socket.h>
+#define STREAM_SEND_FLAGS (MSG_DONTWAIT | MSG_NOSIGNAL)
+#else
+#include <lwip/sockets.h>
+#define STREAM_SEND_FLAGS MSG_DONTWAIT
+#endif
+
+uint8_t HttpStreamer::_buffer[HttpStreamer::SLICE_BYTES];
+
+namespace
+{
+    // True when the socket has room in its send buffer, never waits
+    bool writable(int fd)
+    {
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(fd, &set);
+        struct timeval zero = {0, 0};
+        return select(fd + 1, nullptr, &set, nullptr, &zero) > 0;
+    }
+
+    bool endsWith(const char *s, const char *suffix)
+    {
+        size_t n = strlen(s), m = strlen(suffix);
+        return n >= m && strcasecmp(s + n - m, suffix) == 0;
+    }
+}
+
+HttpStreamer::HttpStreamer() : _active(0), _next(0), _stats()
+{
+    for (uint8_t i = 0; i < MAX_STREAMS; i++)
+        _streams[i].open = false;
+}
+
+bool HttpStreamer::start(WiFiClient &client, fs::File &file)
+{
+    for (uint8_t i = 0; i < MAX_STREAMS; i++)
+    {
+        Stream &s = _streams[i];
+        if (s.open)
+            continue;
+        s.open = true;
+        s.client = client;
+        s.file = file;
+        s.remaining = file.size() - file.position();
+        s.lastProgressMs = millis();
+        _active++;
+        _stats.started++;
+        return true;
+    }
+    return false;
+}
+
+void HttpStreamer::service()
+{
+    if (!_active)
+        return;
+
+    size_t budget = SLICE_BYTES;
+    for (uint8_t n = 0; n < MAX_STREAMS && budget; n++)
+    {
+        uint8_t i = (_next + n) % MAX_STREAMS;
+        Stream &s = _streams[i];
+        if (!s.open)
+            continue;
+        budget -= sendSome(s, budget);
+        if (!budget)
+            _next = (i + 1) % MAX_STREAMS; // Whoever comes next starts the next slice
+    }
+}
+
+size_t HttpStreamer::sendSome(Stream &s, size_t budget)
+{
+    size_t sent = 0;
+    int fd = s.client.fd();
+    if (fd < 0)
+    {
+        close(s, false);
+        return 0;
+    }
+
+    if (writable(fd))
+    {
+        // Read a piece, send what the socket takes and read the rest again next time
+        size_t want = s.remaining < budget ? s.remaining : budget;
+        uint32_t position = s.file.position();
+        size_t got = s.file.read(_buffer, want);
+        if (!got)
+        {
+            close(s, false); // File shorter than its Content-Length
+            return 0;
+        }
+        ssize_t n = send(fd, _buffer, got, STREAM_SEND_FLAGS);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            close(s, false);
+            return 0;
+        }
+        if (n < 0)
+            n = 0;
+        if ((size_t)n < got)
+            s.file.seek(position + n);
+        if (n > 0)
+        {
+            sent = n;
+            s.remaining -= n;
+            s.lastProgressMs = millis();
+            _stats.bytes += n;
+        }
+    }
+
+    if (!s.remaining)
+        close(s, true);
+    else if (!sent && millis() - s.lastProgressMs > IDLE_TIMEOUT_MS)
+        close(s, false);
+    return sent;
+}
+
+void HttpStreamer::close(Stream &s, bool completed)
+{
+    s.file.close();
+    s.file = fs::File();
+    s.client.stop(); // Last reference, the socket sends what it holds and then closes
+    s.client = WiFiClient();
+    s.open = false;
+    _active--;
+    if (completed)
+        _stats.completed++;
+    else
+        _stats.dropped++;
+}
+
+const char *HttpStreamer::contentType(const char *path)
+{
+    static const struct
+    {
+        const char *suffix, *type;
+    } types[] = {
+        {".html", "text/html"},
+        {".htm", "text/html"},
+        {".css", "text/css"},
+        {".js", "application/javascript"},
+        {".json", "application/json"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".ico", "image/x-icon"},
+        {".svg", "image/svg+xml"},
+        {".ttf", "font/ttf"},
+        {".woff", "font/woff"},
+        {".woff2", "font/woff2"},
+        {".txt", "text/plain"},
+    };
+    for (const auto &t : types)
+        if (endsWith(path, t.suffix))
+            return t.type;
+    return "application/octet-stream";
+}
+
+#if !defined(__linux__)
+StreamedFileHandler::StreamedFileHandler(HttpStreamer &streamer, const AssetCatalog &catalog, fs::FS &fs,
+                                         const char *uri, const char *path)
+    : _streamer(streamer), _catalog(catalog), _fs(fs), _uri(uri), _path(path)
+{
+    // "/fonts" serves every file below it, "/index.html" (a name with an extension) one
+    // file. Decided from the name so a missing file never turns into a prefix for all URIs.
+    const char *name = strrchr(path, '/');
+    _isFile = strchr(name ? name : path, '.') != nullptr;
+}
+
+bool StreamedFileHandler::canHandle(HTTPMethod requestMethod, String requestUri)
+{
+    if (requestMethod != HTTP_GET)
+        return false;
+    if (_isFile)
+        return requestUri == _uri;
+    return requestUri.startsWith(_uri + "/");
+}
+
+bool StreamedFileHandler::handle(WebServer &server, HTTPMethod requestMethod, String requestUri)
+{
+    if (!canHandle(requestMethod, requestUri))
+        return false;
+
+    String path = _isFile ? _path : _path + requestUri.substring(_uri.length());
+    if (!_fs.exists(path))
+        return false; // 404 from the server
+
+    // The browser's copy is current: a few header bytes instead of the file
+    const AssetCatalog::Asset *asset = _catalog.find(path.c_str());
+    if (asset && asset->gzip)
+        server.sendHeader("Vary", "Accept-Encoding"); // Caches must not hand this body to other clients
+    if (asset && AssetCatalog::matches(server.header("If-None-Match").c_str(), asset->etag))
+    {
+        server.sendHeader("ETag", asset->etag);
+        server.sendHeader("Cache-Control", "no-cache");
+        server.send(304);
+        return true;
+    }
+
+    // Only the compressed copy is on flash, a client that refuses gzip cannot be served
+    if (asset && asset->gzip && !AssetCatalog::acceptsGzip(server.header("Accept-Encoding").c_str()))
+    {
+        server.send(406, "text/plain", "Stored gzip-compressed only");
+        return true;
+    }
+
+    if (!_streamer.hasRoom())
+    {
+        server.sendHeader("Retry-After", "1");
+        server.send(503, "text/plain", "Busy");
+        return true;
+    }
+    fs::File file = _fs.open(path, "r");
+    if (!file || file.isDirectory())
+        return false;
+
+    if (asset)
+    {
+        server.sendHeader("ETag", asset->etag);
+        server.sendHeader("Cache-Control", "no-cache"); // Always revalidated, logos can be replaced
+        if (asset->gzip)
+            server.sendHeader("Content-Encoding", "gzip");
+    }
+    server.setContentLength(file.size());
+    server.send(200, HttpStreamer::contentType(path.c_str()), "");
+
+    // The streamer keeps the connection, the server lets go of it and takes the next one
+    _streamer.start(server.client(), file);
+    server.client().stop();
+    return true;
+}
+#endif
@@ -0,0 +1,100 @@
+// HttpStreamer.h — Files sent to web clients in small pieces between scheduler slices
+//
+// WebServer::streamFile() writes the whole file before it returns, so a 200 kB logo holds
+// loop() for as long as the browser needs to receive it over Wi-Fi, and the clock and
+// banner stop meanwhile. Here a request handler only sends the headers, then hands the
+// connection and the open file over and returns. service(), run as a scheduler task,
+// moves at most SLICE_BYTES per call and only what the sockets take without waiting
+// (MSG_DONTWAIT). Each file is read again from where its client got to, so all streams
+// share one buffer. A client that stops reading is dropped after IDLE_TIMEOUT_MS.
+
+#ifndef HTTP_STREAMER_H
+#define HTTP_STREAMER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <WiFiClient.h>
+#include "AssetCatalog.h"
+#if !defined(__linux__)
+#include <WebServer.h>
+#endif
+
+class HttpStreamer
+{
+public:
+    static const uint8_t MAX_STREAMS = 8;
+    static const size_t SLICE_BYTES = 2048;       // Per service() call, all streams together
+    static const uint32_t IDLE_TIMEOUT_MS = 10000; // No progress for this long drops the client
+
+    struct Stats
+    {
+        uint32_t started;   // Streams handed over
+        uint32_t completed; // Files sent to the end
+        uint32_t dropped;   // Socket errors and idle timeouts
+        uint64_t bytes;     // Body bytes sent
+    };
+
+    HttpStreamer();
+
+    bool hasRoom() const { return _active < MAX_STREAMS; }
+    uint8_t active() const { return _active; }
+    const Stats &stats() const { return _stats; }
+
+    // Take over a client whose headers were sent, the file is sent from its position.
+    // Returns false when every slot is busy; the caller still owns both then.
+    bool start(WiFiClient &client, fs::File &file);
+
+    // Send the next pieces, call every scheduler slice
+    void service();
+
+    // Content-Type from the file name, e.g. "text/html" for "/index.html"
+    static const char *contentType(const char *path);
+
+private:
+    struct Stream
+    {
+        bool open;
+        WiFiClient client;
+        fs::File file;
+        uint32_t remaining;      // Body bytes still to send
+        uint32_t lastProgressMs; // millis() of the last byte the socket took
+    };
+
+    // Send up to budget bytes, closes the stream when it is done or dead, returns bytes sent
+    size_t sendSome(Stream &s, size_t budget);
+    void close(Stream &s, bool completed);
+
+    Stream _streams[MAX_STREAMS];
+    uint8_t _active;
+    uint8_t _next; // Round robin start, no stream waits behind a fast one for ever
+    Stats _stats;
+
+    static uint8_t _buffer[SLICE_BYTES];
+};
+
+#if !defined(__linux__)
+// serveStatic() with the body sent by an HttpStreamer: one file ("/index.html"), or every
+// file below a directory ("/fonts"). Files in the catalog get their ETag, a 304 when the
+// browser already has them and Content-Encoding: gzip with Vary: Accept-Encoding when
+// stored compressed. There is no uncompressed copy: a client whose Accept-Encoding rules
+// gzip out gets 406 (browsers always accept it, curl without --compressed does not).
+// Answers 503 while all streams are busy. The server must collect the If-None-Match and
+// Accept-Encoding headers.
+class StreamedFileHandler : public RequestHandler
+{
+public:
+    StreamedFileHandler(HttpStreamer &streamer, const AssetCatalog &catalog, fs::FS &fs, const char *uri, const char *path);
+
+    bool canHandle(HTTPMethod requestMethod, String requestUri) override;
+    bool handle(WebServer &server, HTTPMethod requestMethod, String requestUri) override;
+
+private:
+    HttpStreamer &_streamer;
+    const AssetCatalog &_catalog;
+    fs::FS &_fs;
+    String _uri, _path;
+    bool _isFile;
+};
+#endif
+
+#endif // HTTP_STREAMER_H
@@ -0,0 +1,125 @@
+// JsonArena.h — Static memory for the JsonDocuments of the web request handlers
+//
+// ArduinoJson 7 has no fixed-size documents any more: a StaticJsonDocument<N> is only a
+// JsonDocument, and every document takes its memory pools and copied strings from the
+// heap. The handlers build a document for nearly every request, so the heap saw a
+// burst of blocks per page load. A JsonDocument constructed with a JsonArena takes them
+// from a buffer inside the arena instead, one after another. A freed block is given
+// back when it is the newest one, and the whole buffer once nothing is left in use, so
+// a handler's document always starts on an empty arena. Documents may nest (one built
+// while another is alive), they then share the buffer as a stack. What does not fit
+// comes from the heap as before and is counted in fallbacks(). There is no locking: all
+// documents of one arena must be built on the same task.
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <ArduinoJson.h>
+#include <stdlib.h>
+#include <string.h>
+
+template <size_t N>
+class JsonArena : public ArduinoJson::Allocator
+{
+public:
+    JsonArena() : _used(0), _last(NONE), _live(0), _peak(0), _fallbacks(0) {}
+
+    void *allocate(size_t size) override
+    {
+        size_t need = HEADER + align(size);
+        if (need > N - _used)
+        {
+            _fallbacks++;
+            return malloc(size);
+        }
+        Block *block = (Block *)(_buffer + _used);
+        block->size = size;
+        block->previous = _last;
+        _last = _used;
+        _used += need;
+        _live++;
+        if (_used > _peak)
+            _peak = _used;
+        return block + 1;
+    }
+
+    void deallocate(void *ptr) override
+    {
+        if (!owns(ptr))
+        {
+            free(ptr);
+            return;
+        }
+        Block *block = (Block *)ptr - 1;
+        if ((uint8_t *)block == _buffer + _last)
+        {
+            _used = _last;
+            _last = block->previous;
+        }
+        if (--_live == 0)
+        {
+            _used = 0;
+            _last = NONE;
+        }
+    }
+
+    void *reallocate(void *ptr, size_t newSize) override
+    {
+        if (!ptr)
+            return allocate(newSize);
+        if (!owns(ptr))
+            return realloc(ptr, newSize);
+        Block *block = (Block *)ptr - 1;
+        if (newSize <= block->size)
+        {
+            // Shrinking keeps the block where it is (deserializeJson() shrinks its pool
+            // after the strings were added), the newest one gives the rest back
+            block->size = newSize;
+            if ((uint8_t *)block == _buffer + _last)
+                _used = _last + HEADER + align(newSize);
+            return ptr;
+        }
+        if ((uint8_t *)block == _buffer + _last && HEADER + align(newSize) <= N - _last)
+        {
+            // The newest block grows in place
+            block->size = newSize;
+            _used = _last + HEADER + align(newSize);
+            if (_used > _peak)
+                _peak = _used;
+            return ptr;
+        }
+        void *moved = allocate(newSize);
+        if (moved)
+        {
+            memcpy(moved, ptr, block->size < newSize ? block->size : newSize);
+            deallocate(ptr);
+        }
+        return moved;
+    }
+
+    // Most bytes in use at once, headers included, and blocks that went to the heap
+    size_t peak() const { return _peak; }
+    uint32_t fallbacks() const { return _fallbacks; }
+    size_t capacity() const { return N; }
+
+private:
+    struct Block
+    {
+        size_t size;     // As requested
+        size_t previous; // Offset of the block before, NONE for the first
+    };
+    static const size_t HEADER = sizeof(Block);
+    static const size_t NONE = (size_t)-1;
+
+    static size_t align(size_t size) { return (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1); }
+    bool owns(const void *ptr) const { return ptr >= _buffer && ptr < _buffer + N; }
+
+    alignas(sizeof(void *)) uint8_t _buffer[N];
+    size_t _used;  // Bytes from the start of the buffer, the next block goes here
+    size_t _last;  // Offset of the newest block
+    size_t _live;  // Blocks handed out and not freed
+    size_t _peak;
+    uint32_t _fallbacks;
+};
+
+#endif // JSON_ARENA_H
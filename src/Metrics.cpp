@@ -0,0 +1,120 @@
+// Metrics.cpp — Latency histograms and the Prometheus text format for /metrics
+
+#include "Metrics.h"
+
+const uint32_t Histogram::BOUNDS_US[Histogram::BUCKETS] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 5000000};
+
+Histogram::Histogram() : _seq(0), _buckets(), _count(0), _sumUs(0)
+{
+}
+
+void Histogram::record(uint32_t us)
+{
+    uint8_t i = 0;
+    while (i < BUCKETS && us > BOUNDS_US[i])
+        i++;
+
+    uint32_t seq = _seq.load(std::memory_order_relaxed);
+    _seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _buckets[i]++;
+    _count++;
+    _sumUs += us;
+    _seq.store(seq + 2, std::memory_order_release);
+}
+
+void Histogram::snapshot(Snapshot &out) const
+{
+    for (;;)
+    {
+        uint32_t seq = _seq.load(std::memory_order_acquire);
+        if (seq & 1)
+            continue; // The writer is half way through, it never stops there for long
+        memcpy(out.buckets, _buckets, sizeof(out.buckets));
+        out.count = _count;
+        out.sumUs = _sumUs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_seq.load(std::memory_order_relaxed) == seq)
+            return;
+    }
+}
+
+void MetricsWriter::beginLine()
+{
+    if (_buf.length() + LINE_MAX > _buf.capacity())
+        flush();
+}
+
+void MetricsWriter::flush()
+{
+    if (_buf.isEmpty())
+        return;
+    _sink(_buf.c_str(), _buf.length());
+    _buf.clear();
+}
+
+void MetricsWriter::describe(const char *name, const char *type, const char *help)
+{
+    beginLine();
+    _buf.appendf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// name, suffix and {labels}, up to the space before the value
+void MetricsWriter::sampleName(const char *name, const char *suffix, const char *labels)
+{
+    beginLine();
+    _buf.append(name).append(suffix);
+    if (labels)
+        _buf.append('{').append(labels).append('}');
+    _buf.append(' ');
+}
+
+void MetricsWriter::value(const char *name, const char *labels, uint64_t v)
+{
+    sampleName(name, "", labels);
+    _buf.appendf("%llu\n", (unsigned long long)v);
+}
+
+void MetricsWriter::seconds(const char *name, const char *labels, int64_t us)
+{
+    sampleName(name, "", labels);
+    writeSeconds(us);
+    _buf.append('\n');
+}
+
+// Exact decimal seconds from µs, no floating point
+void MetricsWriter::writeSeconds(int64_t us)
+{
+    uint64_t magnitude = us < 0 ? -(uint64_t)us : (uint64_t)us;
+    _buf.appendf("%s%llu.%06llu", us < 0 ? "-" : "", (unsigned long long)(magnitude / 1000000),
+                 (unsigned long long)(magnitude % 1000000));
+}
+
+void MetricsWriter::histogram(const char *name, const char *labels, const Histogram &histogram)
+{
+    Histogram::Snapshot s;
+    histogram.snapshot(s);
+
+    uint64_t cumulative = 0;
+    for (uint8_t i = 0; i <= Histogram::BUCKETS; i++)
+    {
+        cumulative += s.buckets[i];
+        beginLine();
+        _buf.append(name).append("_bucket{");
+        if (labels)
+            _buf.append(labels).append(',');
+        _buf.append("le=\"");
+        if (i < Histogram::BUCKETS)
+            writeSeconds(Histogram::BOUNDS_US[i]);
+        else
+            _buf.append("+Inf");
+        _buf.appendf("\"} %llu\n", (unsigned long long)cumulative);
+    }
+
+    sampleName(name, "_sum", labels);
+    writeSeconds(s.sumUs);
+    _buf.append('\n');
+    sampleName(name, "_count", labels);
+    _buf.appendf("%llu\n", (unsigned long long)s.count);
+}
@@ -0,0 +1,93 @@
+// Metrics.h — Latency histograms and the Prometheus text format for /metrics
+//
+// A Histogram counts durations into fixed buckets (50 µs to 5 s, roughly 1-2.5-5 steps)
+// and keeps their count and sum. record() is a short bucket search and a few adds, cheap
+// enough to stay on in production. Each histogram has exactly one writer, which may run
+// on the other core than the /metrics handler: the writer bumps a sequence counter
+// around its update and snapshot() retries until it has read a quiet, even sequence, so
+// buckets, count and sum always belong together and the writer never waits.
+//
+// MetricsWriter formats the exposition text into a fixed buffer and hands it to a sink
+// (e.g. WebServer::sendContent) whenever the buffer fills, so a large reply never needs
+// more memory than one chunk.
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "FixedString.h"
+
+class Histogram
+{
+public:
+    static const uint8_t BUCKETS = 15; // Finite upper bounds, +Inf is the count
+    static const uint32_t BOUNDS_US[BUCKETS];
+
+    struct Snapshot
+    {
+        uint64_t buckets[BUCKETS + 1]; // Per bucket, not cumulative, the last one is +Inf
+        uint64_t count;
+        uint64_t sumUs;
+    };
+
+    Histogram();
+
+    // Writer side, one task only
+    void record(uint32_t us);
+
+    // Any task or core
+    void snapshot(Snapshot &out) const;
+
+private:
+    std::atomic<uint32_t> _seq; // Odd while record() is updating
+    uint64_t _buckets[BUCKETS + 1];
+    uint64_t _count;
+    uint64_t _sumUs;
+};
+
+// Times a scope into a histogram
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram &histogram) : _histogram(histogram), _startUs(micros()) {}
+    ~ScopedTimer() { _histogram.record(micros() - _startUs); }
+
+private:
+    Histogram &_histogram;
+    uint32_t _startUs;
+};
+
+class MetricsWriter
+{
+public:
+    typedef void (*Sink)(const char *text, size_t length);
+
+    explicit MetricsWriter(Sink sink) : _sink(sink) {}
+
+    // # HELP and # TYPE lines, once per metric name
+    void describe(const char *name, const char *type, const char *help);
+
+    // One sample, labels is the text inside {} or nullptr
+    void value(const char *name, const char *labels, uint64_t v);
+    // One sample of a duration kept in µs, written in seconds as Prometheus expects
+    void seconds(const char *name, const char *labels, int64_t us);
+
+    // _bucket (cumulative, le in seconds), _sum (seconds) and _count samples
+    void histogram(const char *name, const char *labels, const Histogram &histogram);
+
+    // Send what is left in the buffer
+    void flush();
+
+private:
+    static const size_t LINE_MAX = 256; // Room kept free before each line, longer lines are cut
+
+    void beginLine();
+    void sampleName(const char *name, const char *suffix, const char *labels);
+    void writeSeconds(int64_t us);
+
+    Sink _sink;
+    FixedString<1024> _buf;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,318 @@
+// PngUpload.cpp — A PNG received in pieces, checked as it streams and swapped in only when whole
+
+#include "PngUpload.h"
+#include "Crc32.h"
+#include <PNGdec.h> // PNG_MAX_BUFFERED_PIXELS
+
+namespace
+{
+    const uint8_t SIGNATURE_BYTES[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    const uint32_t IHDR = 0x49484452;
+    const uint32_t IDAT = 0x49444154;
+    const uint32_t IEND = 0x49454e44;
+    const uint32_t MAX_LENGTH = 0x7fffffff; // PNG limit for a chunk
+
+    uint32_t bigEndian(const uint8_t *p)
+    {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+
+    bool isLetter(uint8_t c)
+    {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    }
+}
+
+const uint32_t PngChecker::MAX_ROW_BYTES = PNG_MAX_BUFFERED_PIXELS;
+
+uint32_t PngChecker::rowBytes(uint32_t width, uint8_t depth, uint8_t colourType)
+{
+    // Samples per pixel by colour type: grey, -, RGB, palette, grey + alpha, -, RGBA
+    static const uint8_t SAMPLES[7] = {1, 0, 3, 1, 2, 0, 4};
+    uint8_t samples = colourType < sizeof(SAMPLES) ? SAMPLES[colourType] : 0;
+    return (uint32_t)(((uint64_t)samples * depth * width + 7) / 8);
+}
+
+void PngChecker::reset()
+{
+    _state = SIGNATURE;
+    _result = OK;
+    _have = 0;
+    _length = _left = _type = _crc = 0;
+    _chunks = 0;
+    _width = _height = 0;
+    _idat = false;
+}
+
+bool PngChecker::fail(Result result)
+{
+    if (_result == OK)
+        _result = result;
+    return false;
+}
+
+bool PngChecker::update(const uint8_t *data, size_t length)
+{
+    while (length && _result == OK)
+    {
+        size_t n;
+        switch (_state)
+        {
+        case SIGNATURE:
+            n = min(length, (size_t)(8 - _have));
+            if (memcmp(data, SIGNATURE_BYTES + _have, n) != 0)
+                return fail(NOT_PNG);
+            _have += n;
+            if (_have == 8)
+            {
+                _state = LENGTH;
+                _have = 0;
+            }
+            break;
+
+        case LENGTH:
+        case TYPE:
+        case CRC:
+            n = min(length, (size_t)(4 - _have));
+            memcpy(_field + _have, data, n);
+            _have += n;
+            if (_have == 4)
+            {
+                _have = 0;
+                if (_state == LENGTH)
+                {
+                    _length = bigEndian(_field);
+                    if (_length > MAX_LENGTH)
+                        return fail(BAD_CHUNK);
+                    _state = TYPE;
+                }
+                else if (_state == TYPE)
+                {
+                    if (!endOfHeader())
+                        return false;
+                }
+                else if (!endOfChunk())
+                    return false;
+            }
+            break;
+
+        case DATA:
+            n = min(length, (size_t)_left);
+            _crc = crc32Update(_crc, data, n);
+            if (_type == IHDR) // 13 bytes, checked by endOfHeader()
+                memcpy(_ihdr + (_length - _left), data, n);
+            _left -= n;
+            if (!_left)
+                _state = CRC;
+            break;
+
+        case END:
+        default:
+            return fail(BAD_CHUNK); // Bytes after IEND
+        }
+        data += n;
+        length -= n;
+    }
+    return _result == OK;
+}
+
+bool PngChecker::endOfHeader()
+{
+    for (uint8_t i = 0; i < 4; i++)
+        if (!isLetter(_field[i]))
+            return fail(BAD_CHUNK);
+    _type = bigEndian(_field);
+    if ((_chunks == 0) != (_type == IHDR))
+        return fail(BAD_CHUNK); // IHDR first and only once
+    if ((_type == IHDR && _length != sizeof(_ihdr)) || (_type == IEND && (_length != 0 || !_idat)))
+        return fail(BAD_CHUNK);
+    _crc = crc32Update(0, _field, 4); // The CRC covers type and data
+    _left = _length;
+    _state = _left ? DATA : CRC;
+    return true;
+}
+
+bool PngChecker::endOfChunk()
+{
+    if (bigEndian(_field) != _crc)
+        return fail(BAD_CRC);
+    _chunks++;
+    if (_type == IHDR)
+    {
+        _width = bigEndian(_ihdr);
+        _height = bigEndian(_ihdr + 4);
+        uint8_t depth = _ihdr[8], colourType = _ihdr[9], interlace = _ihdr[12];
+        if (!_width || !_height || _width > MAX_LENGTH || _height > MAX_LENGTH)
+            return fail(BAD_CHUNK);
+        if (depth > 8 || interlace || !rowBytes(1, depth, colourType))
+            return fail(UNSUPPORTED);
+        if (rowBytes(_width, depth, colourType) >= MAX_ROW_BYTES) // png.inl, PNGParseInfo()
+            return fail(TOO_WIDE);
+    }
+    else if (_type == IDAT)
+        _idat = true;
+    _state = (_type == IEND) ? END : LENGTH;
+    return true;
+}
+
+bool PngChecker::finish()
+{
+    if (_result == OK && _state != END)
+        fail(TRUNCATED);
+    return _result == OK;
+}
+
+const char *PngChecker::describe(Result result)
+{
+    switch (result)
+    {
+    case OK:
+        return "OK";
+    case NOT_PNG:
+        return "Not a PNG file";
+    case BAD_CHUNK:
+        return "Malformed PNG chunk";
+    case BAD_CRC:
+        return "Chunk CRC mismatch";
+    case UNSUPPORTED:
+        return "Interlaced or 16-bit PNGs are not supported";
+    case TOO_WIDE:
+        return "PNG too wide for the decoder";
+    case TRUNCATED:
+        return "Upload incomplete";
+    }
+    return "Invalid PNG";
+}
+
+PngUpload::PngUpload(fs::FS &fs, const char *path)
+    : _fs(fs), _path(path), _tmpPath(String(path) + ".tmp"), _bakPath(String(path) + ".bak"), _error(NONE), _bytes(0),
+      _startMs(0), _elapsedMs(0)
+{
+}
+
+bool PngUpload::begin()
+{
+    abort();
+    _checker.reset();
+    _error = NONE;
+    _bytes = 0;
+    _elapsedMs = 0;
+    _startMs = millis();
+    _file = _fs.open(_tmpPath, "w");
+    if (!_file)
+        return fail(OPEN_FAILED);
+    return true;
+}
+
+bool PngUpload::fail(Error error)
+{
+    if (_error == NONE)
+        _error = error;
+    abort();
+    return false;
+}
+
+bool PngUpload::write(const uint8_t *data, size_t length)
+{
+    if (_error != NONE || !_file)
+        return false;
+    if (!_checker.update(data, length))
+        return fail(INVALID);
+    if (_file.write(data, length) != length)
+        return fail(WRITE_FAILED);
+    _bytes += length;
+    return true;
+}
+
+bool PngUpload::end()
+{
+    if (_error != NONE || !_file)
+        return false;
+    if (!_checker.finish())
+        return fail(INVALID);
+    _file.close();
+    _elapsedMs = millis() - _startMs;
+
+    // The old file is only deleted once the new one has its name
+    bool hadOld = _fs.exists(_path);
+    if (hadOld)
+    {
+        _fs.remove(_bakPath);
+        if (!_fs.rename(_path, _bakPath))
+            return fail(RENAME_FAILED);
+    }
+    if (!_fs.rename(_tmpPath, _path))
+    {
+        if (hadOld)
+            _fs.rename(_bakPath, _path);
+        return fail(RENAME_FAILED);
+    }
+    if (hadOld)
+        _fs.remove(_bakPath);
+    return true;
+}
+
+void PngUpload::abort()
+{
+    // Also after end() closed the file: a failed swap leaves the temporary file behind
+    if (_file)
+        _file.close();
+    if (_fs.exists(_tmpPath))
+        _fs.remove(_tmpPath);
+}
+
+bool PngUpload::recover()
+{
+    bool restored = false;
+    if (!_fs.exists(_path))
+    {
+        // The temporary file was complete if it still checks out (end() had swapped the
+        // old one out), else the backup is the last good logo
+        PngChecker checker;
+        bool complete = false;
+        fs::File file = _fs.open(_tmpPath, "r");
+        if (file)
+        {
+            uint8_t buf[256];
+            size_t n;
+            while ((n = file.read(buf, sizeof(buf))) > 0 && checker.update(buf, n))
+                ;
+            file.close();
+            complete = checker.finish();
+        }
+        if (complete)
+            restored = _fs.rename(_tmpPath, _path);
+        if (!restored && _fs.exists(_bakPath))
+            restored = _fs.rename(_bakPath, _path);
+    }
+    if (_fs.exists(_tmpPath))
+        _fs.remove(_tmpPath);
+    if (_fs.exists(_bakPath))
+        _fs.remove(_bakPath);
+    return restored;
+}
+
+const char *PngUpload::errorText() const
+{
+    switch (_error)
+    {
+    case NONE:
+        return "OK";
+    case OPEN_FAILED:
+        return "Cannot create the file";
+    case WRITE_FAILED:
+        return "Not enough flash space";
+    case INVALID:
+        return PngChecker::describe(_checker.result());
+    case RENAME_FAILED:
+        return "Cannot replace the logo";
+    }
+    return "Upload failed";
+}
+
+uint32_t PngUpload::kilobytesPerSecond() const
+{
+    if (!_elapsedMs)
+        return 0;
+    return (uint32_t)((uint64_t)_bytes * 1000 / 1024 / _elapsedMs);
+}
@@ -0,0 +1,127 @@
+// PngUpload.h — A PNG received in pieces, checked as it streams and swapped in only when whole
+//
+// PngChecker follows the PNG structure byte by byte without keeping any of it: the
+// 8-byte signature, then chunks of length, type, data and CRC. The CRC of every chunk
+// is computed on the fly, IHDR must come first and IEND last, and an image the decoder
+// cannot show (interlaced, 16 bits per channel, a row longer than PNGdec buffers) is
+// refused as soon as IHDR arrives. A broken upload is therefore known before its last
+// byte is written.
+//
+// PngUpload writes the checked bytes through one open handle to a temporary file. Only
+// end() after a complete, valid stream replaces the target. SPIFFS cannot rename over a
+// file, so the old one is first renamed to <path>.bak, the temporary one takes its name,
+// and only then is the backup deleted. On any failure the temporary file is deleted and
+// the old logo stays, or is renamed back, in place. recover() at boot finishes a swap
+// that a reset interrupted: a missing target comes back from the checked temporary file
+// or the backup.
+
+#ifndef PNG_UPLOAD_H
+#define PNG_UPLOAD_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+class PngChecker
+{
+public:
+    enum Result
+    {
+        OK,
+        NOT_PNG,     // Signature wrong
+        BAD_CHUNK,   // Length too large, IHDR not first or malformed, data after IEND
+        BAD_CRC,     // A chunk's CRC does not match its type and data
+        UNSUPPORTED, // Interlaced, 16 bits per channel or an unknown colour type
+        TOO_WIDE,    // A row takes PNG_MAX_BUFFERED_PIXELS bytes or more, PNGdec refuses it
+        TRUNCATED,   // finish() before IEND
+    };
+
+    PngChecker() { reset(); }
+    void reset();
+
+    // Feed the next bytes, returns false once the stream is known to be bad
+    bool update(const uint8_t *data, size_t length);
+    // After the last byte: true when IEND was seen and everything checked out
+    bool finish();
+
+    Result result() const { return _result; }
+    static const char *describe(Result result);
+
+    // From IHDR, 0 until it has been read
+    uint32_t width() const { return _width; }
+    uint32_t height() const { return _height; }
+
+    // Bytes per row of pixels as PNGdec computes them, the limit it applies at open
+    static uint32_t rowBytes(uint32_t width, uint8_t depth, uint8_t colourType);
+    static const uint32_t MAX_ROW_BYTES;
+
+private:
+    enum State
+    {
+        SIGNATURE,
+        LENGTH,
+        TYPE,
+        DATA,
+        CRC,
+        END, // After IEND
+    };
+
+    bool fail(Result result);
+    bool endOfHeader(); // A chunk's length and type are in
+    bool endOfChunk();  // Its CRC is in
+
+    State _state;
+    Result _result;
+    uint8_t _field[4]; // Length, type or CRC being collected
+    uint8_t _have;     // Bytes of the signature or of _field so far
+    uint8_t _ihdr[13];
+    uint32_t _length, _left, _type, _crc;
+    uint32_t _chunks;
+    uint32_t _width, _height;
+    bool _idat;
+};
+
+class PngUpload
+{
+public:
+    enum Error
+    {
+        NONE,
+        OPEN_FAILED,   // Temporary file could not be created
+        WRITE_FAILED,  // Flash full
+        INVALID,       // See checker().result()
+        RENAME_FAILED, // Valid, but could not be put in place
+    };
+
+    PngUpload(fs::FS &fs, const char *path);
+
+    bool begin();                                // Start a new upload, drops an unfinished one
+    bool write(const uint8_t *data, size_t length); // False from the first problem on, later data is ignored
+    bool end();                                  // Replace the target when the upload is complete and valid
+    void abort();                                // Give up, the target is untouched
+
+    // At boot: restore a target a reset left missing and delete leftover .tmp and .bak
+    // files. Returns true when the target was restored.
+    bool recover();
+
+    Error error() const { return _error; }
+    const char *errorText() const; // For the reply, e.g. "Chunk CRC mismatch"
+    const PngChecker &checker() const { return _checker; }
+
+    uint32_t bytes() const { return _bytes; }
+    uint32_t elapsedMs() const { return _elapsedMs; }
+    uint32_t kilobytesPerSecond() const; // After end()
+
+private:
+    bool fail(Error error);
+
+    fs::FS &_fs;
+    const char *_path;
+    String _tmpPath, _bakPath;
+    fs::File _file;
+    PngChecker _checker;
+    Error _error;
+    uint32_t _bytes;
+    uint32_t _startMs, _elapsedMs;
+};
+
+#endif // PNG_UPLOAD_H
@@ -0,0 +1,84 @@
+// SegmentClock.cpp — Segment-level differential renderer for the 7-segment clock digits
+
+#include "SegmentClock.h"
+
+SegmentClock::SegmentClock(ClockGlyphCache *glyphs)
+    : _glyphs(glyphs), _font(nullptr), _count(0), _pixels(0), _windows(0)
+{
+}
+
+bool SegmentClock::build()
+{
+    _font = nullptr;
+    _count = 0;
+    if (!_glyphs->font())
+        return false;
+
+    const ClockGlyphCache::Cell &cell = _glyphs->cell('0');
+    for (int16_t cy = 0; cy < cell.h; cy++)
+    {
+        for (int16_t cx = 0; cx < cell.w; cx++)
+        {
+            uint16_t digits = 0;
+            for (uint8_t d = 0; d < 10; d++)
+                if (_glyphs->glyphPixel('0' + d, cx, cy))
+                    digits |= 1 << d;
+            if (!digits)
+                continue;
+
+            uint8_t s = 0;
+            while (s < _count && _seg[s].digits != digits)
+                s++;
+            if (s == _count)
+            {
+                // Not a segment font after all, leave it to whole-cell drawing
+                if (_count == MAX_SEGMENTS)
+                {
+                    _count = 0;
+                    return false;
+                }
+                _seg[s] = {digits, cx, cy, cx, cy};
+                _count++;
+            }
+            else
+            {
+                _seg[s].x0 = min(_seg[s].x0, cx);
+                _seg[s].y0 = min(_seg[s].y0, cy);
+                _seg[s].x1 = max(_seg[s].x1, cx);
+                _seg[s].y1 = max(_seg[s].y1, cy);
+            }
+        }
+    }
+
+    _font = _glyphs->font();
+    return true;
+}
+
+bool SegmentClock::drawTransition(char from, char to, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour)
+{
+    bool digits = from >= '0' && from <= '9' && to >= '0' && to <= '9';
+    if (!digits || _font != _glyphs->font())
+    {
+        if (!_glyphs->drawChar(to, x, y, fgColour, bgColour))
+            return false;
+        _pixels += (uint32_t)_glyphs->cell(to).w * _glyphs->cell(to).h;
+        _windows++;
+        return true;
+    }
+
+    uint16_t changed = (1 << (from - '0')) ^ (1 << (to - '0'));
+    for (uint8_t s = 0; s < _count; s++)
+    {
+        // Lit in exactly one of the two digits
+        uint16_t lit = _seg[s].digits & changed;
+        if (!lit || lit == changed)
+            continue;
+
+        int16_t w = _seg[s].x1 - _seg[s].x0 + 1;
+        int16_t h = _seg[s].y1 - _seg[s].y0 + 1;
+        _glyphs->drawCellRegion(to, x, y, _seg[s].x0, _seg[s].y0, w, h, fgColour, bgColour);
+        _pixels += (uint32_t)w * h;
+        _windows++;
+    }
+    return true;
+}
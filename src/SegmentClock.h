@@ -0,0 +1,52 @@
+// SegmentClock.h — Segment-level differential renderer for the 7-segment clock digits
+//
+// The segment geometry is derived from the cached glyph bitmaps of whichever font is
+// active (normal or italic): every cell pixel is classified by the set of digits that
+// light it. Pixels with the same digit set form one segment (the seven bars plus the
+// small join areas between them). Going from one digit to another only repaints the
+// bounding boxes of segments lit in exactly one of the two digits, in the new glyph's
+// pixels, so unchanged segments are never touched.
+
+#ifndef SEGMENT_CLOCK_H
+#define SEGMENT_CLOCK_H
+
+#include "ClockGlyphCache.h"
+
+class SegmentClock
+{
+public:
+    static const uint8_t MAX_SEGMENTS = 32;
+
+    explicit SegmentClock(ClockGlyphCache *glyphs);
+
+    // Derive the segments from the glyph cache, call after every cache rebuild
+    bool build();
+
+    // Font the segment model was derived from (nullptr when not built)
+    const GFXfont *font() const { return _font; }
+    uint8_t segmentCount() const { return _count; }
+
+    // Repaint only the segments that differ between two digits. Falls back to a full
+    // cell push when either character is not a digit. Returns false if nothing cached.
+    bool drawTransition(char from, char to, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour);
+
+    // Pixels and address windows written since the last resetCounters()
+    uint32_t pixelsWritten() const { return _pixels; }
+    uint32_t windowsWritten() const { return _windows; }
+    void resetCounters() { _pixels = 0; _windows = 0; }
+
+private:
+    struct Segment
+    {
+        uint16_t digits; // Bit n set if digit n lights this segment
+        int16_t x0, y0, x1, y1;
+    };
+
+    ClockGlyphCache *_glyphs;
+    const GFXfont *_font;
+    Segment _seg[MAX_SEGMENTS];
+    uint8_t _count;
+    uint32_t _pixels, _windows;
+};
+
+#endif // SEGMENT_CLOCK_H
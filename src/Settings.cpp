@@ -0,0 +1,64 @@
+// Settings.cpp — The saved settings record and what a change to it takes to show
+
+#include "Settings.h"
+
+namespace
+{
+    template <size_t N>
+    bool differs(const char (&a)[N], const char (&b)[N])
+    {
+        return strncmp(a, b, N) != 0;
+    }
+}
+
+uint16_t settingsChanges(const SettingsRecord &before, const SettingsRecord &after)
+{
+    uint16_t changes = 0;
+    if (before.doubleFrame != after.doubleFrame)
+        changes |= CHANGE_LOCAL_FACE | CHANGE_UTC_FACE;
+    if (before.localFrameColour != after.localFrameColour || differs(before.localTimeLabel, after.localTimeLabel))
+        changes |= CHANGE_LOCAL_FACE;
+    if (before.utcFrameColour != after.utcFrameColour || differs(before.utcTimeLabel, after.utcTimeLabel))
+        changes |= CHANGE_UTC_FACE;
+    if (before.localTimeColour != after.localTimeColour)
+        changes |= CHANGE_LOCAL_DIGITS;
+    if (before.utcTimeColour != after.utcTimeColour)
+        changes |= CHANGE_UTC_DIGITS;
+    if (before.italicClockFonts != after.italicClockFonts)
+        changes |= CHANGE_CLOCK_FONT;
+    if (before.bannerSpeed != after.bannerSpeed)
+        changes |= CHANGE_BANNER_SPEED;
+    if (differs(before.timeZone, after.timeZone))
+        changes |= CHANGE_TIME_ZONE | CHANGE_WEATHER;
+    if (before.latitude != after.latitude || before.longitude != after.longitude)
+        changes |= CHANGE_WEATHER;
+    if (differs(before.startupLogo, after.startupLogo))
+        changes |= CHANGE_STARTUP_LOGO;
+    return changes;
+}
+
+const char *settingsChangeName(uint16_t change)
+{
+    switch (change)
+    {
+    case CHANGE_LOCAL_FACE:
+        return "local face";
+    case CHANGE_UTC_FACE:
+        return "UTC face";
+    case CHANGE_LOCAL_DIGITS:
+        return "local digits";
+    case CHANGE_UTC_DIGITS:
+        return "UTC digits";
+    case CHANGE_CLOCK_FONT:
+        return "clock font";
+    case CHANGE_BANNER_SPEED:
+        return "banner speed";
+    case CHANGE_TIME_ZONE:
+        return "time zone";
+    case CHANGE_WEATHER:
+        return "weather";
+    case CHANGE_STARTUP_LOGO:
+        return "startup logo";
+    }
+    return "?";
+}
@@ -0,0 +1,52 @@
+// Settings.h — The saved settings record and what a change to it takes to show
+//
+// SettingsRecord is the layout SettingsStore keeps on flash. Fields are only ever
+// appended, SETTINGS_VERSION goes up when an existing one changes meaning.
+//
+// settingsChanges() compares two records and returns the work the device has to do for
+// the difference, one bit per action: a frame colour redraws that face only, a digit
+// colour repaints those digits, a new position or time zone asks for fresh weather, a
+// new startup logo is shown once. So a change from the web page is applied while the
+// clock runs. Fields that are read where they are used (banner colour, screensaver)
+// need no action. Wi-Fi credentials come from config.h and are not settings, nothing
+// here needs a restart.
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+#include "TimeZone.h"
+
+const uint16_t SETTINGS_VERSION = 1;
+
+struct SettingsRecord
+{
+    float latitude, longitude;
+    uint16_t localTimeColour, utcTimeColour, localFrameColour, utcFrameColour, bannerColour;
+    uint8_t doubleFrame, italicClockFonts, bannerScreenSaver;
+    int32_t bannerSpeed;
+    uint32_t screenSaverTimeout; // ms
+    char localTimeLabel[32], utcTimeLabel[32], startupLogo[32];
+    char timeZone[TimeZone::MAX_RULE];
+};
+
+enum SettingsChange : uint16_t
+{
+    CHANGE_LOCAL_FACE = 1 << 0,   // Frame or label: clear and redraw the local face
+    CHANGE_UTC_FACE = 1 << 1,     // Same for the UTC face
+    CHANGE_LOCAL_DIGITS = 1 << 2, // Digit colour: repaint the local digits
+    CHANGE_UTC_DIGITS = 1 << 3,
+    CHANGE_CLOCK_FONT = 1 << 4,   // Rebuild the glyph cache, both faces
+    CHANGE_BANNER_SPEED = 1 << 5, // New banner task period
+    CHANGE_TIME_ZONE = 1 << 6,    // Parse the new rule
+    CHANGE_WEATHER = 1 << 7,      // Position or time zone (sunrise, sunset): fetch again
+    CHANGE_STARTUP_LOGO = 1 << 8, // Show it (which caches it for the next boot), then the clock
+};
+const uint8_t SETTINGS_CHANGE_COUNT = 9;
+
+uint16_t settingsChanges(const SettingsRecord &before, const SettingsRecord &after);
+
+// Short name of one change bit, e.g. "local face", for the log
+const char *settingsChangeName(uint16_t change);
+
+#endif // SETTINGS_H
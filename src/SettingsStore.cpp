@@ -0,0 +1,116 @@
+// SettingsStore.cpp — A binary settings record in two slots, the newest intact one wins
+
+#include "SettingsStore.h"
+#include "Crc32.h"
+
+namespace
+{
+    const uint32_t MAGIC = 0x53544348; // "HCTS" little endian
+}
+
+size_t SettingsStore::FileMedium::read(uint32_t offset, uint8_t *data, size_t length)
+{
+    fs::File file = _fs.open(_path, "r");
+    if (!file)
+        return 0;
+    size_t n = 0;
+    if (file.seek(offset))
+        n = file.read(data, length);
+    file.close();
+    return n;
+}
+
+bool SettingsStore::FileMedium::write(uint32_t offset, const uint8_t *data, size_t length)
+{
+    fs::File file = _fs.exists(_path) ? _fs.open(_path, "r+") : _fs.open(_path, "w");
+    if (!file)
+        return false;
+    // A new file is padded up to the slot, SPIFFS cannot seek past the end
+    bool ok = true;
+    uint8_t zero[16] = {0};
+    for (size_t size = file.size(); ok && size < offset; size += sizeof(zero))
+    {
+        file.seek(size);
+        size_t n = min(sizeof(zero), (size_t)(offset - size));
+        ok = file.write(zero, n) == n;
+    }
+    ok = ok && file.seek(offset) && file.write(data, length) == length;
+    file.close();
+    return ok;
+}
+
+SettingsStore::SettingsStore(Medium &medium)
+    : _medium(medium), _slot(-1), _sequence(0), _writes(0)
+{
+    static_assert(sizeof(Header) == HEADER_SIZE, "Slot header layout");
+}
+
+uint32_t SettingsStore::checksum(const Header &h, const uint8_t *record)
+{
+    uint32_t crc = crc32Update(0, (const uint8_t *)&h, offsetof(Header, crc));
+    return crc32Update(crc, record, h.length);
+}
+
+bool SettingsStore::valid(const uint8_t *slot)
+{
+    Header h;
+    memcpy(&h, slot, sizeof(h));
+    return h.magic == MAGIC && h.length <= MAX_RECORD && h.crc == checksum(h, slot + sizeof(h));
+}
+
+bool SettingsStore::load(void *record, size_t size, uint16_t &version)
+{
+    uint8_t *slots = (uint8_t *)malloc(2 * SLOT_SIZE);
+    if (!slots)
+        return false;
+    size_t n = _medium.read(0, slots, 2 * SLOT_SIZE);
+    memset(slots + n, 0, 2 * SLOT_SIZE - n); // Never written reads as empty
+
+    Header h[2];
+    bool ok[2];
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        memcpy(&h[i], slots + i * SLOT_SIZE, sizeof(Header));
+        ok[i] = valid(slots + i * SLOT_SIZE);
+    }
+    // Sequence numbers compare across the wrap, a save is never 2^31 ahead
+    _slot = -1;
+    if (ok[0] && ok[1])
+        _slot = (int32_t)(h[1].sequence - h[0].sequence) > 0 ? 1 : 0;
+    else if (ok[0] || ok[1])
+        _slot = ok[0] ? 0 : 1;
+
+    if (_slot >= 0)
+    {
+        const Header &cur = h[_slot];
+        memcpy(record, slots + _slot * SLOT_SIZE + sizeof(Header), min(size, (size_t)cur.length));
+        version = cur.version;
+        _sequence = cur.sequence;
+    }
+    free(slots);
+    return _slot >= 0;
+}
+
+bool SettingsStore::save(const void *record, size_t size, uint16_t version)
+{
+    if (size > MAX_RECORD)
+        return false;
+    uint8_t slot[SLOT_SIZE];
+    Header h;
+    h.magic = MAGIC;
+    h.version = version;
+    h.length = size;
+    h.sequence = _sequence + 1;
+    memcpy(slot + sizeof(h), record, size);
+    h.crc = checksum(h, slot + sizeof(h));
+    memcpy(slot, &h, sizeof(h));
+
+    // Only header and record, the rest of the slot keeps whatever it held
+    int8_t target = _slot < 0 ? 0 : 1 - _slot;
+    if (!_medium.write(target * SLOT_SIZE, slot, sizeof(h) + size))
+        return false;
+    _slot = target;
+    _sequence = h.sequence;
+    _writes++;
+    return true;
+}
@@ -0,0 +1,86 @@
+// SettingsStore.h — A binary settings record in two slots, the newest intact one wins
+//
+// The settings used to be rewritten as a JSON file on every change; power lost during the
+// write left a truncated file and the next boot quietly fell back to the defaults. Here
+// the record is kept twice. A save goes to the slot that does not hold the current
+// record, as one write of header and data, with a sequence number one higher and a
+// CRC-32 over both. load() reads the two slots in one go and takes the valid slot with
+// the higher sequence, so a torn write is seen as a bad CRC and the previous record is
+// still there.
+//
+// The header carries the schema version and the length of the data. The caller lays out
+// its record append-only: a shorter record from an older firmware fills the front of the
+// struct and the new fields keep the defaults already in it; the version says which
+// conversions the caller still has to make. The slots live on a Medium, a file on the
+// device and a simulated flash in a host test.
+
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+class SettingsStore
+{
+public:
+    static const size_t SLOT_SIZE = 512;
+    static const size_t HEADER_SIZE = 16;
+    static const size_t MAX_RECORD = SLOT_SIZE - HEADER_SIZE;
+
+    // Where the two slots are kept, SLOT_SIZE bytes each from offset 0
+    class Medium
+    {
+    public:
+        virtual ~Medium() {}
+        // Bytes read, fewer when the medium ends early (never written)
+        virtual size_t read(uint32_t offset, uint8_t *data, size_t length) = 0;
+        virtual bool write(uint32_t offset, const uint8_t *data, size_t length) = 0;
+    };
+
+    // The slots in one file, overwritten in place
+    class FileMedium : public Medium
+    {
+    public:
+        FileMedium(fs::FS &fs, const char *path) : _fs(fs), _path(path) {}
+        size_t read(uint32_t offset, uint8_t *data, size_t length) override;
+        bool write(uint32_t offset, const uint8_t *data, size_t length) override;
+
+    private:
+        fs::FS &_fs;
+        const char *_path;
+    };
+
+    explicit SettingsStore(Medium &medium);
+
+    // Copy the newest valid record into record, at most size bytes; bytes it does not
+    // cover are left alone. version is the schema it was saved with. False when neither
+    // slot holds a valid record (first boot, or both damaged).
+    bool load(void *record, size_t size, uint16_t &version);
+
+    // Write record to the spare slot, the current one is untouched until this succeeded
+    bool save(const void *record, size_t size, uint16_t version);
+
+    uint32_t sequence() const { return _sequence; } // Of the current record, 0 before any
+    int8_t slot() const { return _slot; }           // Holding the current record, -1 if none
+    uint32_t writes() const { return _writes; }     // Saves since boot
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t length; // Record bytes after the header
+        uint32_t sequence;
+        uint32_t crc; // Over the header up to here and the record
+    };
+
+    static uint32_t checksum(const Header &h, const uint8_t *record);
+    static bool valid(const uint8_t *slot);
+
+    Medium &_medium;
+    int8_t _slot;
+    uint32_t _sequence;
+    uint32_t _writes;
+};
+
+#endif // SETTINGS_STORE_H
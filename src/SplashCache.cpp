@@ -0,0 +1,232 @@
+// SplashCache.cpp — The startup logo pre-decoded to RLE RGB565 on flash
+
+#include "SplashCache.h"
+
+namespace
+{
+    const char MAGIC[4] = {'S', '5', '6', '5'};
+    const uint16_t REPEAT = 0x8000;
+    const uint16_t MIN_REPEAT = 3; // Shorter runs cost less as part of a literal
+
+    // Encoded row: worst case one literal token and every pixel
+    const size_t LINE_BYTES = 2 + 2 * SplashCache::MAX_WIDTH;
+
+    void put16(uint8_t *&p, uint16_t v)
+    {
+        memcpy(p, &v, 2);
+        p += 2;
+    }
+}
+
+SplashCache::SplashCache(fs::FS &fs, const char *path)
+    : _fs(fs), _path(path), _line(nullptr), _rows(0), _failed(false)
+{
+}
+
+bool SplashCache::sourceSize(const char *source, uint32_t &size)
+{
+    fs::File file = _fs.open(source, "r");
+    if (!file)
+        return false;
+    size = file.size();
+    file.close();
+    return true;
+}
+
+bool SplashCache::show(TFT_eSPI &tft, const char *source)
+{
+    uint32_t size;
+    if (!sourceSize(source, size))
+        return false;
+
+    fs::File file = _fs.open(_path, "r");
+    if (!file)
+        return false;
+    Header h;
+    if (file.read((uint8_t *)&h, sizeof(h)) != sizeof(h) || memcmp(h.magic, MAGIC, 4) != 0 ||
+        strncmp(h.source, source, MAX_SOURCE) != 0 || h.sourceSize != size ||
+        file.size() != sizeof(h) + h.dataBytes || h.width > MAX_WIDTH)
+    {
+        file.close();
+        return false;
+    }
+
+    uint8_t *buf = (uint8_t *)malloc(READ_BUFFER);
+    if (!buf)
+    {
+        file.close();
+        return false;
+    }
+
+    bool swap = tft.getSwapBytes();
+    tft.setSwapBytes(true); // Runs hold native RGB565 values
+    tft.startWrite();
+    tft.setAddrWindow(h.x, h.y, h.width, h.height);
+
+    // Tokens may straddle a read, the unread tail moves to the front before each refill
+    uint32_t left = h.dataBytes, pixels = (uint32_t)h.width * h.height;
+    size_t have = 0, pos = 0;
+    bool ok = true;
+    while (pixels && ok)
+    {
+        if (have - pos < LINE_BYTES && left)
+        {
+            memmove(buf, buf + pos, have - pos);
+            have -= pos;
+            pos = 0;
+            size_t n = file.read(buf + have, min((size_t)left, READ_BUFFER - have));
+            if (!n)
+                break;
+            have += n;
+            left -= n;
+        }
+        if (have - pos < 2)
+            break;
+
+        uint16_t token, count;
+        memcpy(&token, buf + pos, 2);
+        count = token & ~REPEAT;
+        size_t bytes = (token & REPEAT) ? 4 : 2 + 2 * (size_t)count;
+        if (!count || count > pixels || have - pos < bytes)
+        {
+            ok = false;
+            break;
+        }
+        if (token & REPEAT)
+        {
+            uint16_t colour;
+            memcpy(&colour, buf + pos + 2, 2);
+            tft.pushBlock(colour, count);
+        }
+        else
+            tft.pushPixels(buf + pos + 2, count); // Token is 2 bytes, pixels stay aligned
+        pos += bytes;
+        pixels -= count;
+    }
+
+    tft.endWrite();
+    tft.setSwapBytes(swap);
+    free(buf);
+    file.close();
+    return ok && !pixels;
+}
+
+bool SplashCache::begin(const char *source, int16_t x, int16_t y, uint16_t width, uint16_t height)
+{
+    abort();
+    if (width == 0 || width > MAX_WIDTH || strlen(source) >= MAX_SOURCE)
+        return false;
+
+    memset(&_header, 0, sizeof(_header));
+    memcpy(_header.magic, MAGIC, 4);
+    _header.x = x;
+    _header.y = y;
+    _header.width = width;
+    _header.height = height;
+    strlcpy(_header.source, source, sizeof(_header.source));
+    if (!sourceSize(source, _header.sourceSize))
+        return false;
+
+    _line = (uint8_t *)malloc(LINE_BYTES);
+    if (!_line)
+        return false;
+    _file = _fs.open(String(_path) + ".tmp", "w");
+    if (!_file)
+    {
+        abort();
+        return false;
+    }
+    // Placeholder, the real header (with the data size) is written by end()
+    _file.write((const uint8_t *)&_header, sizeof(_header));
+    _rows = 0;
+    _failed = false;
+    return true;
+}
+
+// Runs of MIN_REPEAT or more identical pixels become repeats, the rest literals
+size_t SplashCache::encodeLine(const uint16_t *pixels)
+{
+    uint8_t *p = _line;
+    uint16_t width = _header.width;
+    uint16_t literal = 0; // Pixels waiting to go out as a literal, ending at x
+    uint16_t x = 0;
+    while (x < width)
+    {
+        uint16_t run = 1;
+        while (x + run < width && pixels[x + run] == pixels[x])
+            run++;
+        if (run >= MIN_REPEAT)
+        {
+            if (literal)
+            {
+                put16(p, literal);
+                memcpy(p, pixels + x - literal, 2 * literal);
+                p += 2 * literal;
+                literal = 0;
+            }
+            put16(p, run | REPEAT);
+            put16(p, pixels[x]);
+        }
+        else
+            literal += run;
+        x += run;
+    }
+    if (literal)
+    {
+        put16(p, literal);
+        memcpy(p, pixels + x - literal, 2 * literal);
+        p += 2 * literal;
+    }
+    return p - _line;
+}
+
+void SplashCache::addLine(const uint16_t *pixels)
+{
+    if (!_line || _failed || _rows >= _header.height)
+        return;
+    size_t n = encodeLine(pixels);
+    if (_file.write(_line, n) != n)
+        _failed = true; // Flash full, end() keeps the old cache
+    _header.dataBytes += n;
+    _rows++;
+}
+
+bool SplashCache::end()
+{
+    if (!_line)
+        return false;
+    bool ok = !_failed && _rows == _header.height;
+    if (ok)
+    {
+        ok = _file.seek(0) && _file.write((const uint8_t *)&_header, sizeof(_header)) == sizeof(_header);
+    }
+    _file.close();
+    free(_line);
+    _line = nullptr;
+
+    String tmp = String(_path) + ".tmp";
+    if (!ok)
+    {
+        _fs.remove(tmp);
+        return false;
+    }
+    _fs.remove(_path);
+    return _fs.rename(tmp, _path);
+}
+
+void SplashCache::abort()
+{
+    if (!_line)
+        return;
+    _file.close();
+    free(_line);
+    _line = nullptr;
+    _fs.remove(String(_path) + ".tmp");
+}
+
+void SplashCache::invalidate()
+{
+    abort();
+    if (_fs.exists(_path))
+        _fs.remove(_path);
+}
@@ -0,0 +1,65 @@
+// SplashCache.h — The startup logo pre-decoded to RLE RGB565 on flash
+//
+// Decoding a PNG at boot means inflating it through 2 KB file reads and pushing it a line
+// at a time. The cache keeps the decoded logo instead: while the PNG is decoded anyway
+// (the first boot after a new logo is chosen, or an upload) each line is recorded, and
+// later boots stream the file to the panel in one address window. Lines are stored as
+// runs, a repeat (count | 0x8000, colour) or a literal (count, pixels...), so flat areas
+// become a single pushBlock() and a logo with large plain regions takes about half the
+// bytes of raw RGB565. The header names the source file and its size, a cache made from
+// another logo (or an older upload of different size) is not shown. A new cache is
+// written to a temporary file and renamed, an interrupted recording leaves the old one.
+
+#ifndef SPLASH_CACHE_H
+#define SPLASH_CACHE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <TFT_eSPI.h>
+
+class SplashCache
+{
+public:
+    static const uint16_t MAX_WIDTH = 480;
+    static const size_t MAX_SOURCE = 32; // SPIFFS path of the PNG, terminator included
+    static const size_t READ_BUFFER = 4096;
+
+    SplashCache(fs::FS &fs, const char *path);
+
+    // Draw the cached image if it was made from source (as it is now), false otherwise
+    bool show(TFT_eSPI &tft, const char *source);
+
+    // Record a new image: begin(), one addLine() per row top to bottom, then end()
+    bool begin(const char *source, int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void addLine(const uint16_t *pixels); // Native RGB565, width pixels
+    bool end();                           // Replaces the cache if every row arrived
+    void abort();
+    bool recording() const { return _line != nullptr; }
+
+    // Forget the cached image, e.g. when its source is about to be rewritten
+    void invalidate();
+
+private:
+    struct Header
+    {
+        char magic[4]; // "S565"
+        int16_t x, y;
+        uint16_t width, height;
+        uint32_t sourceSize;
+        uint32_t dataBytes;
+        char source[MAX_SOURCE];
+    };
+
+    bool sourceSize(const char *source, uint32_t &size);
+    size_t encodeLine(const uint16_t *pixels);
+
+    fs::FS &_fs;
+    const char *_path;
+    Header _header;
+    fs::File _file;
+    uint8_t *_line; // Encoded row while recording
+    uint16_t _rows;
+    bool _failed;
+};
+
+#endif // SPLASH_CACHE_H
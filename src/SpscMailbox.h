@@ -0,0 +1,63 @@
+// SpscMailbox.h — Lock-free single-producer/single-consumer mailbox
+//
+// A fixed ring of N slots (N - 1 usable) passed between exactly one producer and one
+// consumer, e.g. the network task on core 0 and the UI loop on core 1. Items are copied
+// in and out, so T should be a plain struct (no String or other heap owners). The
+// producer publishes a slot with a release store of the head index and the consumer
+// frees it with a release store of the tail index; neither side ever blocks.
+
+#ifndef SPSC_MAILBOX_H
+#define SPSC_MAILBOX_H
+
+#include <atomic>
+#include <stdint.h>
+
+template <typename T, uint32_t N>
+class SpscMailbox
+{
+    static_assert(N >= 2, "SpscMailbox needs at least two slots");
+
+public:
+    SpscMailbox() : _head(0), _tail(0) {}
+
+    // Producer side, returns false (item dropped) when the mailbox is full
+    bool push(const T &item)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t next = (head + 1) % N;
+        if (next == _tail.load(std::memory_order_acquire))
+            return false;
+        _slots[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, returns false when there is nothing to take
+    bool pop(T &item)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        item = _slots[tail];
+        _tail.store((tail + 1) % N, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, keep only the newest item
+    bool popLatest(T &item)
+    {
+        bool any = false;
+        while (pop(item))
+            any = true;
+        return any;
+    }
+
+    bool empty() const { return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire); }
+
+private:
+    T _slots[N];
+    std::atomic<uint32_t> _head; // Next slot the producer writes
+    std::atomic<uint32_t> _tail; // Next slot the consumer reads
+};
+
+#endif // SPSC_MAILBOX_H
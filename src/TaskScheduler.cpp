@@ -0,0 +1,148 @@
+// TaskScheduler.cpp — Cooperative deadline scheduler for loop()
+
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(ClockFunction clock)
+    : _clock(clock), _count(0), _running(-1)
+{
+}
+
+int8_t TaskScheduler::addTask(const char *name, TaskFunction function, uint32_t periodUs, uint8_t priority, uint32_t deadlineUs)
+{
+    if (_count == MAX_TASKS || !function)
+        return -1;
+
+    Task &t = _tasks[_count];
+    t.name = name;
+    t.function = function;
+    t.period = periodUs;
+    t.deadline = deadlineUs;
+    t.release = _clock();
+    t.priority = priority;
+    t.enabled = true;
+    t.rescheduled = false;
+    memset(&t.stats, 0, sizeof(t.stats));
+    return _count++;
+}
+
+void TaskScheduler::setPeriod(int8_t id, uint32_t periodUs)
+{
+    if (id < 0 || id >= _count)
+        return;
+    _tasks[id].period = periodUs;
+}
+
+void TaskScheduler::setNextRelease(int8_t id, uint32_t releaseUs)
+{
+    if (id < 0 || id >= _count)
+        return;
+    _tasks[id].release = releaseUs;
+    // Keep the new release if the task moves itself while it runs
+    if (id == _running)
+        _tasks[id].rescheduled = true;
+}
+
+void TaskScheduler::setEnabled(int8_t id, bool enabled)
+{
+    if (id < 0 || id >= _count)
+        return;
+    if (enabled && !_tasks[id].enabled)
+        _tasks[id].release = _clock(); // Resume now, not with a backlog of old releases
+    _tasks[id].enabled = enabled;
+}
+
+void TaskScheduler::resetStats()
+{
+    for (uint8_t i = 0; i < _count; i++)
+        memset(&_tasks[i].stats, 0, sizeof(TaskStats));
+}
+
+bool TaskScheduler::runOnce()
+{
+    uint32_t now = _clock();
+
+    // Highest priority due task, ties go to the earliest deadline
+    int8_t pick = -1;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        const Task &t = _tasks[i];
+        if (!t.enabled || !reached(now, t.release))
+            continue;
+        if (pick < 0 || t.priority > _tasks[pick].priority ||
+            (t.priority == _tasks[pick].priority && (int32_t)(deadlineOf(t) - deadlineOf(_tasks[pick])) < 0))
+            pick = i;
+    }
+    if (pick < 0)
+        return false;
+
+    Task &t = _tasks[pick];
+
+    // A release a whole period old can no longer be met, run the latest one instead
+    if (t.period && now - t.release >= t.period)
+    {
+        uint32_t behind = (now - t.release) / t.period;
+        t.release += behind * t.period;
+        t.stats.skipped += behind;
+    }
+
+    uint32_t release = t.release;
+    uint32_t deadline = deadlineOf(t);
+    uint32_t startDelay = now - release;
+    if (startDelay > t.stats.maxStartDelayUs)
+        t.stats.maxStartDelayUs = startDelay;
+
+    _running = pick;
+    t.rescheduled = false;
+    t.function();
+    _running = -1;
+
+    uint32_t end = _clock();
+    uint32_t runTime = end - now;
+    t.stats.runs++;
+    t.stats.lastRunUs = runTime;
+    t.stats.totalRunUs += runTime;
+    if (runTime > t.stats.maxRunUs)
+        t.stats.maxRunUs = runTime;
+    if (!reached(deadline, end))
+    {
+        t.stats.misses++;
+        if (end - deadline > t.stats.maxLatenessUs)
+            t.stats.maxLatenessUs = end - deadline;
+    }
+
+    if (!t.rescheduled)
+    {
+        if (t.period)
+        {
+            t.release = release + t.period;
+            // Overran its own period: resume on the grid after now, so a task slower than
+            // its period leaves gaps for lower priorities instead of running back to back
+            if (reached(end, t.release))
+            {
+                uint32_t behind = (end - t.release) / t.period + 1;
+                t.release += behind * t.period;
+                t.stats.skipped += behind;
+            }
+        }
+        else
+            t.enabled = false; // One shot
+    }
+    return true;
+}
+
+uint32_t TaskScheduler::idleTime() const
+{
+    uint32_t now = _clock();
+    uint32_t idle = UINT32_MAX;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        const Task &t = _tasks[i];
+        if (!t.enabled)
+            continue;
+        if (reached(now, t.release))
+            return 0;
+        if (t.release - now < idle)
+            idle = t.release - now;
+    }
+    return idle;
+}
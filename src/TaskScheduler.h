@@ -0,0 +1,82 @@
+// TaskScheduler.h — Cooperative deadline scheduler for loop()
+//
+// Periodic tasks are released on a fixed time grid (each release is the previous one
+// plus the period, so slow runs do not make the schedule drift) and a task can be
+// re-aligned to an external boundary such as the NTP second. Each runOnce() call runs at
+// most one due task: the highest priority first, then the earliest deadline. Releases a
+// whole period or more behind, or overrun by the task itself, are skipped rather than
+// run back to back. Run time, lateness and deadline misses are recorded per task. Time
+// comes from a microsecond clock function (micros() by default) so the scheduler can be
+// driven from a virtual clock.
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+
+class TaskScheduler
+{
+public:
+    typedef void (*TaskFunction)();
+    typedef unsigned long (*ClockFunction)();
+
+    static const uint8_t MAX_TASKS = 12; // main.cpp adds 10, a slot is 64 bytes on the ESP32
+
+    struct TaskStats
+    {
+        uint32_t runs;            // Completed runs
+        uint32_t misses;          // Runs that finished after release + deadline
+        uint32_t skipped;         // Releases dropped because the task was a whole period late
+        uint32_t lastRunUs;       // Duration of the last run
+        uint32_t maxRunUs;        // Longest run
+        uint64_t totalRunUs;      // Sum of all run durations
+        uint32_t maxLatenessUs;   // Worst finish time past the deadline
+        uint32_t maxStartDelayUs; // Worst start time past the release
+    };
+
+    explicit TaskScheduler(ClockFunction clock = micros);
+
+    // Add a periodic task, returns its id or -1 when full. Higher priority runs first.
+    // A deadline of 0 means the next release (the period). The first release is now.
+    int8_t addTask(const char *name, TaskFunction function, uint32_t periodUs, uint8_t priority, uint32_t deadlineUs = 0);
+
+    // Change the period, the next release keeps its place on the grid
+    void setPeriod(int8_t id, uint32_t periodUs);
+    // Move the next release to an absolute clock time, the grid follows from there
+    void setNextRelease(int8_t id, uint32_t releaseUs);
+    void setEnabled(int8_t id, bool enabled);
+
+    // Run the most urgent due task, returns false if nothing was due
+    bool runOnce();
+
+    // Microseconds until the next release (0 if a task is already due)
+    uint32_t idleTime() const;
+
+    uint8_t taskCount() const { return _count; }
+    const char *taskName(int8_t id) const { return _tasks[id].name; }
+    uint32_t taskPeriod(int8_t id) const { return _tasks[id].period; }
+    const TaskStats &taskStats(int8_t id) const { return _tasks[id].stats; }
+    void resetStats();
+
+private:
+    struct Task
+    {
+        const char *name;
+        TaskFunction function;
+        uint32_t period, deadline, release;
+        uint8_t priority;
+        bool enabled, rescheduled;
+        TaskStats stats;
+    };
+
+    // Signed difference so the comparisons survive the 32-bit clock wrapping
+    static bool reached(uint32_t now, uint32_t t) { return (int32_t)(now - t) >= 0; }
+    uint32_t deadlineOf(const Task &t) const { return t.release + (t.deadline ? t.deadline : t.period); }
+
+    ClockFunction _clock;
+    Task _tasks[MAX_TASKS];
+    uint8_t _count;
+    int8_t _running;
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,109 @@
+// TickerStrip.cpp — Pre-rendered scrolling banner text
+
+#include "TickerStrip.h"
+
+TickerStrip::TickerStrip(TFT_eSPI *tft, int16_t viewWidth, int16_t height)
+    : _tft(tft), _strip(tft), _viewWidth(viewWidth), _height(height), _textWidth(0), _capacity(0), _ready(false)
+{
+}
+
+TickerStrip::~TickerStrip()
+{
+    release();
+}
+
+void TickerStrip::release()
+{
+    _strip.deleteSprite();
+    _textWidth = 0;
+    _capacity = 0;
+    _ready = false;
+}
+
+bool TickerStrip::render(const char *text, const GFXfont *font)
+{
+    _ready = false;
+    _strip.setColorDepth(1);
+    _strip.setFreeFont(font);
+    int16_t width = _strip.textWidth(text);
+    if (width <= 0)
+        return false;
+
+    // The strip only grows, in whole steps: a new text of a similar length reuses the
+    // same block instead of freeing and allocating a slightly different size each time
+    if (width > _capacity)
+    {
+        int16_t capacity = (width + CAPACITY_STEP - 1) / CAPACITY_STEP * CAPACITY_STEP;
+        release();
+        _strip.setColorDepth(1);
+        if (!_strip.createSprite(capacity, _height))
+            return false;
+        _capacity = capacity;
+    }
+
+    // Any non-zero colour sets a bit in a 1-bit sprite
+    _strip.fillSprite(TFT_BLACK);
+    _strip.setFreeFont(font);
+    _strip.setTextColor(TFT_WHITE);
+    _strip.setTextDatum(TL_DATUM);
+    _strip.drawString(text, 0, 0);
+
+    _textWidth = width;
+    _ready = true;
+    return true;
+}
+
+void TickerStrip::push(int32_t textX, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour)
+{
+    if (!_ready)
+        return;
+
+    const uint8_t *img = (const uint8_t *)_strip.getPointer();
+    uint16_t stride = (_capacity + 7) >> 3;
+
+    // View columns covered by the text, the rest is background
+    int32_t c0 = max((int32_t)0, textX);
+    int32_t c1 = min((int32_t)_viewWidth, textX + _textWidth);
+
+    uint16_t lineBuf[_viewWidth];
+    bool swap = _tft->getSwapBytes();
+    _tft->setSwapBytes(true); // Line buffer holds native RGB565 values
+    _tft->startWrite();
+    _tft->setAddrWindow(x, y, _viewWidth, _height);
+    for (int16_t row = 0; row < _height; row++)
+    {
+        const uint8_t *line = img + row * stride;
+        int32_t c = 0;
+        for (; c < c0; c++)
+            lineBuf[c] = bgColour;
+        for (; c < c1; c++)
+        {
+            int32_t sc = c - textX;
+            lineBuf[c] = (line[sc >> 3] & (0x80 >> (sc & 7))) ? fgColour : bgColour;
+        }
+        for (; c < _viewWidth; c++)
+            lineBuf[c] = bgColour;
+        _tft->pushPixels(lineBuf, _viewWidth);
+    }
+    _tft->endWrite();
+    _tft->setSwapBytes(swap);
+}
+
+void TickerStrip::pushColumn(int32_t textCol, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour)
+{
+    const uint8_t *img = (const uint8_t *)_strip.getPointer();
+    uint16_t stride = (_capacity + 7) >> 3;
+    bool inText = _ready && textCol >= 0 && textCol < _textWidth;
+
+    uint16_t colBuf[_height];
+    for (int16_t row = 0; row < _height; row++)
+        colBuf[row] = (inText && (img[row * stride + (textCol >> 3)] & (0x80 >> (textCol & 7)))) ? fgColour : bgColour;
+
+    bool swap = _tft->getSwapBytes();
+    _tft->setSwapBytes(true); // Column buffer holds native RGB565 values
+    _tft->startWrite();
+    _tft->setAddrWindow(x, y, 1, _height);
+    _tft->pushPixels(colBuf, _height);
+    _tft->endWrite();
+    _tft->setSwapBytes(swap);
+}
@@ -0,0 +1,46 @@
+// TickerStrip.h — Pre-rendered scrolling banner text
+//
+// The banner text is rendered once into a 1-bit off-screen strip at least as wide as the text.
+// Each scroll step then expands the visible window of that strip straight into a line
+// buffer and pushes it in one address window: no glyph rendering, no sprite fill and
+// no text width measurement per frame. Colours are applied at push time.
+
+#ifndef TICKER_STRIP_H
+#define TICKER_STRIP_H
+
+#include <TFT_eSPI.h>
+
+class TickerStrip
+{
+public:
+    static const int16_t CAPACITY_STEP = 512; // Strip width granularity in pixels
+
+    TickerStrip(TFT_eSPI *tft, int16_t viewWidth, int16_t height);
+    ~TickerStrip();
+
+    // Render new text, returns false if the strip could not be allocated
+    bool render(const char *text, const GFXfont *font);
+    void release();
+    bool ready() const { return _ready; }
+
+    // Rendered text width in pixels, the scroll wraps after -textWidth()
+    int16_t textWidth() const { return _textWidth; }
+    int16_t viewWidth() const { return _viewWidth; }
+
+    // Push the view with the text starting at textX within it (same meaning as the
+    // x given to drawString() in a view-sized sprite)
+    void push(int32_t textX, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour);
+
+    // Push a single text column as a 1 pixel wide window, background past either end.
+    // Used with hardware scrolling where only the incoming column is drawn.
+    void pushColumn(int32_t textCol, int32_t x, int32_t y, uint16_t fgColour, uint16_t bgColour);
+
+private:
+    TFT_eSPI *_tft;
+    TFT_eSprite _strip;
+    int16_t _viewWidth, _height, _textWidth;
+    int16_t _capacity; // Allocated strip width
+    bool _ready;
+};
+
+#endif // TICKER_STRIP_H
@@ -0,0 +1,241 @@
+// TimeZone.cpp — POSIX TZ rules without libc
+
+#include "TimeZone.h"
+#include "CivilTime.h"
+
+namespace
+{
+    const int64_t SPAN_NONE = INT64_MIN;
+    const int32_t defaultRuleTime = 2 * 3600; // Transitions at 02:00 unless the rule says
+
+    bool isDigit(char c) { return c >= '0' && c <= '9'; }
+    bool isAlpha(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+
+    const char *parseNumber(const char *p, int32_t &value, int32_t maxValue)
+    {
+        if (!isDigit(*p))
+            return nullptr;
+        value = 0;
+        while (isDigit(*p))
+        {
+            value = value * 10 + (*p++ - '0');
+            if (value > maxValue)
+                return nullptr;
+        }
+        return p;
+    }
+
+    int64_t yearStartUtc(int32_t year) { return daysFromCivil(year, 1, 1) * 86400; }
+}
+
+TimeZone::TimeZone()
+{
+    set("UTC0");
+}
+
+// std or dst name: three or more letters, or anything alphanumeric, '+' or '-' in <>
+const char *TimeZone::parseName(const char *p, char *name)
+{
+    size_t n = 0;
+    if (*p == '<')
+    {
+        p++;
+        while (isAlpha(*p) || isDigit(*p) || *p == '+' || *p == '-')
+        {
+            if (n == MAX_ABBREV - 1)
+                return nullptr;
+            name[n++] = *p++;
+        }
+        if (*p++ != '>')
+            return nullptr;
+    }
+    else
+    {
+        while (isAlpha(*p))
+        {
+            if (n == MAX_ABBREV - 1)
+                return nullptr;
+            name[n++] = *p++;
+        }
+    }
+    if (n < 3)
+        return nullptr;
+    name[n] = '\0';
+    return p;
+}
+
+// [+|-]hh[:mm[:ss]]
+const char *TimeZone::parseTime(const char *p, int32_t &seconds, int32_t maxHours)
+{
+    int32_t sign = 1;
+    if (*p == '+' || *p == '-')
+        sign = (*p++ == '-') ? -1 : 1;
+
+    int32_t h, m = 0, s = 0;
+    if (!(p = parseNumber(p, h, maxHours)))
+        return nullptr;
+    if (*p == ':')
+    {
+        if (!(p = parseNumber(p + 1, m, 59)))
+            return nullptr;
+        if (*p == ':' && !(p = parseNumber(p + 1, s, 59)))
+            return nullptr;
+    }
+    seconds = sign * (h * 3600 + m * 60 + s);
+    return p;
+}
+
+// Jn, n or Mm.w.d, then an optional /time
+const char *TimeZone::parseRule(const char *p, Rule &rule)
+{
+    int32_t v;
+    if (*p == 'J')
+    {
+        if (!(p = parseNumber(p + 1, v, 365)) || v < 1)
+            return nullptr;
+        rule.kind = 'J';
+        rule.day = v;
+    }
+    else if (*p == 'M')
+    {
+        int32_t month, week, weekday;
+        if (!(p = parseNumber(p + 1, month, 12)) || month < 1 || *p != '.')
+            return nullptr;
+        if (!(p = parseNumber(p + 1, week, 5)) || week < 1 || *p != '.')
+            return nullptr;
+        if (!(p = parseNumber(p + 1, weekday, 6)))
+            return nullptr;
+        rule.kind = 'M';
+        rule.month = month;
+        rule.week = week;
+        rule.weekday = weekday;
+    }
+    else
+    {
+        if (!(p = parseNumber(p, v, 365)))
+            return nullptr;
+        rule.kind = 'D';
+        rule.day = v;
+    }
+
+    rule.time = defaultRuleTime;
+    if (*p == '/' && !(p = parseTime(p + 1, rule.time, 167)))
+        return nullptr;
+    return p;
+}
+
+bool TimeZone::set(const char *rule)
+{
+    if (!rule || strlen(rule) >= MAX_RULE)
+        return false;
+
+    char stdName[MAX_ABBREV], dstName[MAX_ABBREV] = "";
+    int32_t stdOffset, dstOffset;
+    Rule start = {'M', 0, 3, 2, 0, defaultRuleTime};
+    Rule end = {'M', 0, 11, 1, 0, defaultRuleTime};
+    bool hasDst = false;
+
+    // POSIX offsets count west of UTC, keep seconds east
+    const char *p = parseName(rule, stdName);
+    if (!p || !(p = parseTime(p, stdOffset, 24)))
+        return false;
+    stdOffset = -stdOffset;
+
+    if (*p)
+    {
+        if (!(p = parseName(p, dstName)))
+            return false;
+        hasDst = true;
+        dstOffset = stdOffset + 3600;
+        if (*p && *p != ',')
+        {
+            if (!(p = parseTime(p, dstOffset, 24)))
+                return false;
+            dstOffset = -dstOffset;
+        }
+        if (*p == ',')
+        {
+            if (!(p = parseRule(p + 1, start)) || *p != ',' || !(p = parseRule(p + 1, end)))
+                return false;
+        }
+        if (*p)
+            return false;
+    }
+    else
+        dstOffset = stdOffset;
+
+    strlcpy(_rule, rule, sizeof(_rule));
+    strlcpy(_stdName, stdName, sizeof(_stdName));
+    strlcpy(_dstName, hasDst ? dstName : stdName, sizeof(_dstName));
+    _stdOffset = stdOffset;
+    _dstOffset = dstOffset;
+    _hasDst = hasDst;
+    _start = start;
+    _end = end;
+
+    // Forget the cached span, the next lookup recomputes it
+    _from = SPAN_NONE;
+    _until = SPAN_NONE;
+    _offset = stdOffset;
+    _dst = false;
+    return true;
+}
+
+// UTC instant at which a rule fires in a year, offsetBefore is the UTC offset it ends
+int64_t TimeZone::transition(const Rule &rule, int32_t year, int32_t offsetBefore)
+{
+    int64_t day;
+    if (rule.kind == 'J')
+        day = daysFromCivil(year, 1, 1) + rule.day - 1 + (isLeapYear(year) && rule.day >= 60);
+    else if (rule.kind == 'D')
+        day = daysFromCivil(year, 1, 1) + rule.day;
+    else
+    {
+        // Week 1-4 is the nth given weekday of the month, week 5 the last one
+        int64_t first = daysFromCivil(year, rule.month, 1);
+        int32_t firstWeekday = (int32_t)(((first % 7) + 11) % 7); // 1970-01-01 was a Thursday
+        int32_t mday = 1 + (rule.weekday - firstWeekday + 7) % 7 + (rule.week - 1) * 7;
+        while (mday > daysInMonth(year, rule.month))
+            mday -= 7;
+        day = first + mday - 1;
+    }
+    return day * 86400 + rule.time - offsetBefore;
+}
+
+int32_t TimeZone::recompute(int64_t utc)
+{
+    if (!_hasDst)
+    {
+        _from = INT64_MIN;
+        _until = INT64_MAX;
+        _offset = _stdOffset;
+        _dst = false;
+        return _offset;
+    }
+
+    // Both transitions of the UTC year, the span ends at the nearest boundary around utc
+    CivilTime civil;
+    civilFromEpoch(utc, civil);
+    int64_t bounds[4] = {yearStartUtc(civil.year), 0, 0, yearStartUtc(civil.year + 1)};
+    int64_t start = transition(_start, civil.year, _stdOffset);
+    int64_t end = transition(_end, civil.year, _dstOffset);
+    bounds[1] = start;
+    bounds[2] = end;
+
+    if (start > end) // Southern hemisphere, DST over the new year
+        _dst = utc < end || utc >= start;
+    else
+        _dst = utc >= start && utc < end;
+    _offset = _dst ? _dstOffset : _stdOffset;
+
+    _from = bounds[0];
+    _until = bounds[3];
+    for (int i = 1; i < 3; i++)
+    {
+        if (bounds[i] <= utc && bounds[i] > _from)
+            _from = bounds[i];
+        if (bounds[i] > utc && bounds[i] < _until)
+            _until = bounds[i];
+    }
+    return _offset;
+}
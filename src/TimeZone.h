@@ -0,0 +1,75 @@
+// TimeZone.h — POSIX TZ rules (e.g. "CET-1CEST,M3.5.0,M10.5.0/3") without libc
+//
+// The rule is parsed once. The UTC offset is then cached together with the span it is
+// valid for, bounded by the next DST transition (or the turn of the UTC year, where the
+// rules are evaluated again). While the clock stays inside that span a lookup is one
+// range check; leaving it recomputes the two transitions of the year. DST is decided as
+// glibc does: per UTC year, with the southern hemisphere case where DST starts after it
+// ends. Without a rule part a DST zone uses the US rules "M3.2.0,M11.1.0".
+// Offsets follow POSIX: "CET-1" is one hour east of UTC, offsetAt() returns +3600.
+
+#ifndef TIME_ZONE_H
+#define TIME_ZONE_H
+
+#include <Arduino.h>
+
+class TimeZone
+{
+public:
+    static const size_t MAX_RULE = 64;  // Longest accepted TZ string, terminator included
+    static const size_t MAX_ABBREV = 16;
+
+    TimeZone();
+
+    // Parse a POSIX TZ string, returns false (and keeps the current rule) if it is invalid
+    bool set(const char *rule);
+    const char *rule() const { return _rule; }
+    bool hasDst() const { return _hasDst; }
+
+    // Seconds east of UTC at a UTC epoch
+    int32_t offsetAt(int64_t utc)
+    {
+        if (utc >= _from && utc < _until)
+            return _offset;
+        return recompute(utc);
+    }
+    int64_t toLocal(int64_t utc) { return utc + offsetAt(utc); }
+    bool isDst(int64_t utc)
+    {
+        offsetAt(utc);
+        return _dst;
+    }
+    const char *abbreviation(int64_t utc) { return isDst(utc) ? _dstName : _stdName; }
+
+    // First UTC second at which the cached offset has to be looked at again
+    int64_t validUntil() const { return _until; }
+
+private:
+    struct Rule
+    {
+        char kind;    // 'J' (1-365, no Feb 29), 'D' (0-365), 'M' (month.week.weekday)
+        uint16_t day; // J and D
+        uint8_t month, week, weekday;
+        int32_t time; // Local seconds after midnight, may be negative or past 24 h
+    };
+
+    static const char *parseName(const char *p, char *name);
+    static const char *parseTime(const char *p, int32_t &seconds, int32_t maxHours);
+    static const char *parseRule(const char *p, Rule &rule);
+    static int64_t transition(const Rule &rule, int32_t year, int32_t offsetBefore);
+
+    int32_t recompute(int64_t utc);
+
+    char _rule[MAX_RULE];
+    char _stdName[MAX_ABBREV], _dstName[MAX_ABBREV];
+    int32_t _stdOffset, _dstOffset; // Seconds east of UTC
+    bool _hasDst;
+    Rule _start, _end;
+
+    // Cached offset and the UTC span [_from, _until) it holds for
+    int64_t _from, _until;
+    int32_t _offset;
+    bool _dst;
+};
+
+#endif // TIME_ZONE_H
@@ -0,0 +1,97 @@
+// Timebase.cpp — UTC seconds predicted on the local microsecond clock
+
+#include "Timebase.h"
+
+namespace
+{
+    const int32_t stepThresholdUs = 100000; // Sync errors beyond this are time steps, not drift
+    const uint32_t minRateSpan = 16;        // Seconds between updates before the rate is trusted
+    const int32_t rateGainShift = 2;        // Take a quarter of each rate measurement
+    const int32_t maxRatePpb = 500000;      // Crystal tolerance is far below 500 ppm
+    const uint32_t rebaseAfter = 600;       // Keep the anchor within the 32-bit clock range
+
+    uint32_t absUs(int32_t us) { return us < 0 ? -(int64_t)us : us; }
+}
+
+Timebase::Timebase(ClockFunction clock)
+    : _clock(clock), _set(false), _anchorEpoch(0), _anchorUs(0), _lastSyncEpoch(0), _ppb(0)
+{
+    resetStats();
+}
+
+void Timebase::resetStats()
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void Timebase::sync(uint32_t epoch, uint32_t startUs)
+{
+    if (_set)
+    {
+        int32_t error = (int32_t)(boundaryUs(epoch) - startUs);
+        _stats.syncs++;
+        _stats.lastSyncErrorUs = error;
+        if (absUs(error) > (uint32_t)stepThresholdUs)
+            _stats.steps++;
+        else
+        {
+            if (absUs(error) > _stats.maxSyncErrorUs)
+                _stats.maxSyncErrorUs = absUs(error);
+            // A late prediction means our model of the second is too long in local time
+            uint32_t span = epoch - _lastSyncEpoch;
+            if (span >= minRateSpan)
+            {
+                int64_t measured = (int64_t)error * 1000 / span;
+                int64_t ppb = _ppb - (measured >> rateGainShift);
+                _ppb = ppb > maxRatePpb ? maxRatePpb : ppb < -maxRatePpb ? -maxRatePpb : (int32_t)ppb;
+            }
+        }
+    }
+    else
+        _stats.syncs++;
+
+    _anchorEpoch = epoch;
+    _anchorUs = startUs;
+    _lastSyncEpoch = epoch;
+    _set = true;
+}
+
+uint32_t Timebase::boundaryUs(uint32_t epoch) const
+{
+    return _anchorUs + (uint32_t)secondsToUs((int32_t)(epoch - _anchorEpoch));
+}
+
+uint32_t Timebase::epochAt(uint32_t nowUs) const
+{
+    // Estimate from the nominal second, then settle on the exact boundary
+    int32_t elapsed = (int32_t)(nowUs - _anchorUs);
+    int64_t second = secondsToUs(1);
+    int64_t n = elapsed >= 0 ? elapsed / second : -((-(int64_t)elapsed + second - 1) / second);
+    uint32_t epoch = _anchorEpoch + (int32_t)n;
+    while ((int32_t)(nowUs - boundaryUs(epoch + 1)) >= 0)
+        epoch++;
+    while ((int32_t)(nowUs - boundaryUs(epoch)) < 0)
+        epoch--;
+    return epoch;
+}
+
+void Timebase::markFlip(uint32_t epoch, uint32_t flipUs)
+{
+    int32_t error = (int32_t)(flipUs - boundaryUs(epoch));
+    _stats.flips++;
+    _stats.lastFlipUs = error;
+    _stats.totalFlipUs += absUs(error);
+    if (absUs(error) > _stats.maxFlipUs)
+        _stats.maxFlipUs = absUs(error);
+    advance(flipUs);
+}
+
+void Timebase::advance(uint32_t nowUs)
+{
+    // Move the anchor forward in whole seconds, the rate correction carries over
+    uint32_t epoch = epochAt(nowUs);
+    if (epoch - _anchorEpoch < rebaseAfter)
+        return;
+    _anchorUs = boundaryUs(epoch);
+    _anchorEpoch = epoch;
+}
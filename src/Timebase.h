@@ -0,0 +1,70 @@
+// Timebase.h — UTC seconds predicted on the local microsecond clock
+//
+// Each NTP update says at which clock value a UTC second started. From that anchor the
+// timebase predicts every following second boundary in microseconds, corrected for the
+// measured rate error of the local oscillator, so the clock redraw can be released right
+// on the boundary. Two errors are tracked: the flip error (digits on the panel minus the
+// predicted boundary) and the sync error (predicted boundary minus the one the next NTP
+// update reports). Time comes from a microsecond clock function (micros() by default) so
+// the timebase can be driven from a virtual clock.
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <Arduino.h>
+
+class Timebase
+{
+public:
+    typedef unsigned long (*ClockFunction)();
+
+    struct Stats
+    {
+        uint32_t flips;          // Seconds drawn
+        int32_t lastFlipUs;      // Last draw time minus its boundary
+        uint32_t maxFlipUs;      // Worst absolute flip error
+        uint64_t totalFlipUs;    // Sum of absolute flip errors
+        uint32_t syncs;          // NTP updates applied
+        int32_t lastSyncErrorUs; // Predicted minus reported boundary at the last update
+        uint32_t maxSyncErrorUs; // Worst absolute sync error, steps excluded
+        uint32_t steps;          // Updates too far off to be drift, taken as a time step
+    };
+
+    explicit Timebase(ClockFunction clock = micros);
+
+    // UTC second epoch started at clock value startUs
+    void sync(uint32_t epoch, uint32_t startUs);
+    bool isSet() const { return _set; }
+
+    // UTC second at clock value nowUs
+    uint32_t epochAt(uint32_t nowUs) const;
+    uint32_t epoch() const { return epochAt(_clock()); }
+    // Clock value at which UTC second epoch starts
+    uint32_t boundaryUs(uint32_t epoch) const;
+    // Clock value of the next second boundary after nowUs
+    uint32_t nextBoundaryUs(uint32_t nowUs) const { return boundaryUs(epochAt(nowUs) + 1); }
+
+    // Record that second epoch reached the display at clock value flipUs
+    void markFlip(uint32_t epoch, uint32_t flipUs);
+    // Keep the anchor close to nowUs, call at least every half hour (markFlip does)
+    void advance(uint32_t nowUs);
+
+    // Local clock rate error, parts per billion (positive: the local clock runs fast)
+    int32_t rateErrorPpb() const { return _ppb; }
+    const Stats &stats() const { return _stats; }
+    void resetStats();
+
+private:
+    // Local microseconds in n true seconds
+    int64_t secondsToUs(int64_t n) const { return n * 1000000LL + n * _ppb / 1000; }
+
+    ClockFunction _clock;
+    bool _set;
+    uint32_t _anchorEpoch;   // A UTC second...
+    uint32_t _anchorUs;      // ...and the clock value at which it started
+    uint32_t _lastSyncEpoch; // Epoch of the previous NTP update, for the rate estimate
+    int32_t _ppb;
+    Stats _stats;
+};
+
+#endif // TIMEBASE_H
@@ -0,0 +1,40 @@
+// WriteBehind.cpp — Changes held in RAM and written once they stop coming
+
+#include "WriteBehind.h"
+
+WriteBehind::WriteBehind(uint32_t quietMs, uint32_t maxDelayMs)
+    : _quietMs(quietMs), _maxDelayMs(maxDelayMs), _dirty(false), _firstMs(0), _lastMs(0), _oldestMs(0), _stats()
+{
+}
+
+void WriteBehind::markDirty(uint32_t nowMs)
+{
+    if (!_dirty)
+        _firstMs = _oldestMs = nowMs;
+    _dirty = true;
+    _lastMs = nowMs;
+    _stats.changes++;
+}
+
+bool WriteBehind::due(uint32_t nowMs) const
+{
+    return _dirty && (nowMs - _lastMs >= _quietMs || nowMs - _firstMs >= _maxDelayMs);
+}
+
+uint32_t WriteBehind::flushed(uint32_t nowMs)
+{
+    if (!_dirty)
+        return 0;
+    _dirty = false;
+    uint32_t latencyMs = nowMs - _oldestMs;
+    _stats.flushes++;
+    if (latencyMs > _stats.maxLatencyMs)
+        _stats.maxLatencyMs = latencyMs;
+    return latencyMs;
+}
+
+void WriteBehind::failed(uint32_t nowMs)
+{
+    if (_dirty)
+        _firstMs = _lastMs = nowMs; // _oldestMs still dates the first change
+}
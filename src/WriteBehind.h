@@ -0,0 +1,48 @@
+// WriteBehind.h — Changes held in RAM and written once they stop coming
+//
+// Dragging the colour picker on the web page sends a change every few tens of ms; saving
+// each one rewrote the settings on flash, held loop() during the write and wore the
+// sectors. Here a change only marks the data dirty. due() turns true once no change has
+// come for the quiet period, or when the first unsaved change is maxDelay old (a picker
+// held in motion still gets saved). The owner then writes and reports flushed(), which
+// returns how long the oldest change waited. An explicit save is a write like any other
+// and clears the pending one. Times are millis() values passed in, so a host test can
+// drive the clock.
+
+#ifndef WRITE_BEHIND_H
+#define WRITE_BEHIND_H
+
+#include <Arduino.h>
+
+class WriteBehind
+{
+public:
+    struct Stats
+    {
+        uint32_t changes;      // markDirty() calls
+        uint32_t flushes;      // Writes that covered at least one change
+        uint32_t maxLatencyMs; // Longest wait from a change to its write
+    };
+
+    WriteBehind(uint32_t quietMs, uint32_t maxDelayMs);
+
+    void markDirty(uint32_t nowMs);
+    bool dirty() const { return _dirty; }
+    bool due(uint32_t nowMs) const;
+
+    // The data is on flash: ms since the oldest change it covers, 0 if nothing was pending
+    uint32_t flushed(uint32_t nowMs);
+    // The write failed, try again after another quiet period
+    void failed(uint32_t nowMs);
+
+    const Stats &stats() const { return _stats; }
+
+private:
+    uint32_t _quietMs, _maxDelayMs;
+    bool _dirty;
+    uint32_t _firstMs, _lastMs; // Oldest and newest change since the last write attempt
+    uint32_t _oldestMs;         // First change not on flash yet, kept across failed writes
+    Stats _stats;
+};
+
+#endif // WRITE_BEHIND_H
@@ -34,6 +34,27 @@
 #include <SPIFFS.h>
 #include <WebServer.h>
 #include <XPT2046_Touchscreen.h>
+#include <ClockGlyphCache.h>
+#include <SegmentClock.h>
+#include <TickerStrip.h>
+#include <TaskScheduler.h>
+#include <SpscMailbox.h>
+#include <BackgroundTask.h>
+#include <Timebase.h>
+#include <CivilTime.h>
+#include <TimeZone.h>
+#include <FixedString.h>
+#include <HeapMonitor.h>
+#include <Metrics.h>
+#include <HttpStreamer.h>
+#include <AssetCatalog.h>
+#include <SplashCache.h>
+#include <PngUpload.h>
+#include <SettingsStore.h>
+#include <Settings.h>
+#include <WriteBehind.h>
+#include <EventStream.h>
+#include <JsonArena.h>
 #ifdef MYCONFIG_H_EXISTS
     #include <myconfig.h>  // Only include myconfig.h if it exists
 #else
@@ -61,10 +82,14 @@ String SSID = WIFI_SSID; // Wi-Fi credentials
 String WiFiPassword = WIFI_PASSWORD;
 String apiKey = WEATHER_API_KEY; // API Key
 
-int tOffset = 2; // e.g. 2 = CEST
+String timeZoneRule = "CET-1CEST,M3.5.0,M10.5.0/3"; // POSIX TZ of the local clock
+TimeZone timeZone;                                   // UI side, parsed from timeZoneRule
 
 // Create web server
 WebServer server(80); // HTTP server on port 80
+HttpStreamer httpStreamer; // Sends page and image bodies a slice at a time
+AssetCatalog assetCatalog; // ETags and gzip flags of the files in data/, from /assets.txt
+EventStream eventStream;   // /events: time ticks, banner text and settings pushed to open pages
 
 // Configurable Settings (replace all previous #defines)
 float latitude = 46.4667118;
@@ -81,18 +106,21 @@ String utcTimeLabel = "  UTC Time  ";
 String startupLogo = "logo1.png";
 bool italicClockFonts = false;
 unsigned long screenSaverTimeout = 1000 * 60 * 60; // 60 minute
+bool bannerScreenSaver = false;                    // Screensaver scrolls the weather banner in hardware
+
+// The settings above as saved on flash, a SettingsRecord
+SettingsStore::FileMedium settingsFile(SPIFFS, "/settings.bin"); // Both slots, 1 kB
+SettingsStore settingsStore(settingsFile);
+WriteBehind settingsWriteBehind(2000, 10000); // Picker changes saved 2 s after the last, 10 s at most
+bool configBroadcastPending = false;          // Open pages get the settings with the next flush
 
-volatile bool refreshDigits = false;
 const String weatherAPI = "https://api.openweathermap.org/data/2.5/weather"; // OpenWeather API endpoint
 
 int retriesBeforeReboot = 5;
 
 // Global variables for previous time tracking
-String previousLocalTime = "";
-String previousUTCtime = "";
-int refreshDigitsCounter = 0;
-volatile bool refreshFrames = false;
-int refreshFramesCounter = 0;
+char previousLocalTime[CIVIL_HMS_SIZE] = ""; // Digits on the panel, cleared to force a redraw
+char previousUTCtime[CIVIL_HMS_SIZE] = "";
 
 // TFT Display Setup
 TFT_eSPI tft = TFT_eSPI();                   // Create TFT display object
@@ -100,40 +128,141 @@ TFT_eSprite stext2 = TFT_eSprite(&tft);      // Sprite object for "Hello World"
 TFT_eSprite progressBar = TFT_eSprite(&tft); // Create sprite for OTA progress bar
 
 TFT_eSprite labelSprite = TFT_eSprite(&tft); // Global sprite
+ClockGlyphCache clockGlyphs(&tft);           // Pre-rendered clock digits
+SegmentClock segmentClock(&clockGlyphs);     // Repaints only the digit segments that change
+TickerStrip tickerStrip(&tft, 310, 30);      // Pre-rendered weather banner, same size as stext2
 // Bouncing text state
 int ballX = 50, ballY = 50;
 int dx = 1, dy = 1;
 
 // Scrolling Text
 int textX;                                                                                      // Variable for text position (to start at the rightmost side)
-String scrollText = "Sorry, No Weather Info At This Moment!!!            Have you enterred your API key?"; // Text to scroll
-// Timing variables
-unsigned long previousMillisForScroller = 0; // Store last time the action was performed
+typedef FixedString<320> BannerText; // Banner text, UTF-8, never on the heap
+BannerText scrollText = "Sorry, No Weather Info At This Moment!!!            Have you enterred your API key?"; // Text to scroll
+// Cooperative scheduler, loop() only runs the next due task
+TaskScheduler scheduler;
+int8_t clockTask = -1;
+int8_t bannerTask = -1;
+Timebase timebase; // NTP seconds predicted on micros(), the clock ticks on each boundary
+bool screenSaver = false;
+// A newly chosen startup logo is shown for a while, decoded by the screensaver step rather
+// than in the request handler; the clock and banner leave the panel alone meanwhile
+unsigned long logoPreviewMs = 0;    // Requested and not drawn yet, 0 for none
+unsigned long logoPreviewUntil = 0; // millis() when the clock comes back
+bool logoPreviewShown = false;
+HeapMonitor heapMonitor; // Free heap and largest block, one sample per second
+SplashCache splashCache(SPIFFS, "/splash.565"); // Startup logo decoded, rebuilt by any decode of startupLogo
+PngUpload logoUpload(SPIFFS, "/logo4.png");     // Web upload of a custom startup logo
+uint32_t bootSplashUs = 0;                      // Startup logo on the panel, measured at boot
+bool bootSplashCached = false;
+
+// 📈 /metrics: every histogram has one writer, the network task ones are read across cores
+Histogram loopHistogram;         // loop() iterations that ran a task
+Histogram displayTimeHistogram;  // Both displayTime() calls of a clock tick
+Histogram bannerHistogram;       // One banner step
+Histogram handleClientHistogram; // server.handleClient()
+Histogram weatherFetchHistogram; // fetchWeatherReport(), network task
+Histogram httpLatencyHistogram;  // http.GET() until the response headers, network task
+Histogram ntpUpdateHistogram;    // timeClient.update(), network task
+Histogram settingsWriteHistogram; // One settings record to flash
+Histogram settingsFlushHistogram; // From a settings change until it is on flash
+Histogram eventsHistogram;        // eventStream.service()
+std::atomic<int32_t> ntpOffsetMs(0); // Last NTP offset and round trip, network task
+std::atomic<uint32_t> ntpDelayMs(0);
+
+// Hardware scrolled banner. The ILI9341 scrolls whole panel lines, which are screen columns
+// in landscape, so everything between the fixed margins moves with the text. The frame edges
+// are the same in every column there, the clock faces are not: this runs as a screensaver.
+const uint16_t bannerScrollMargin = 8; // Fixed columns either side, covers the frame corners
+int32_t bannerScrollColumn = 0;        // Text column entering at the right edge
 
 // NTP Client Setup
 WiFiUDP ntpUDP;
 NTPClient timeClient(ntpUDP, "pool.ntp.org", 0, 60000); // UTC offset and update interval
 
+// Network task (core 0) ↔ UI loop (core 1) hand-over. The network task owns HTTPClient
+// and timeClient, the UI only ever sees copies arriving through these mailboxes.
+struct WeatherRequest
+{
+    float latitude, longitude;
+    char timeZone[TimeZone::MAX_RULE]; // POSIX TZ for sunrise and sunset
+};
+struct WeatherReport
+{
+    bool ok;
+    BannerText text;
+};
+struct TimeSync
+{
+    unsigned long epoch;    // UTC seconds at millisAt
+    unsigned long millisAt; // millis() at which epoch started
+};
+SpscMailbox<WeatherRequest, 4> weatherRequests; // UI → network
+SpscMailbox<WeatherReport, 2> weatherReports;   // network → UI
+SpscMailbox<TimeSync, 2> timeSyncs;             // network → UI
+BackgroundTask networkTask;
+JsonDocument weatherFilter;  // Built once in setup(), read-only afterwards
+JsonArena<4608> jsonArena;   // Memory of the request handlers' documents, all on the loop task
+
 // WiFi Reconnect Logic
 int retryCount = 0;
 
 // Function Prototypes
 void connectWiFi();
-void fetchWeatherData();
-String formatLocalTime(long epochTime);
-String convertEpochToTimeString(long epochTime);
-void displayTime(int x, int y, String time, String &previousTime, int yOffset, uint16_t fontColor);
-String convertTimestampToDate(long timestamp);
+void buildWeatherFilter();
+bool fetchWeatherReport(const WeatherRequest &request, WeatherReport &report);
+void networkLoop(void *arg);
+void requestWeather();
+void serviceMailboxes();
+unsigned long currentEpoch();
+void displayTime(int x, int y, const char *time, char *previousTime, int yOffset, uint16_t fontColor);
 void loadSettings();
-void handleRoot();
+bool importLegacySettings();
+void settingsToRecord(SettingsRecord &r);
+void settingsFromRecord(SettingsRecord &r);
+void settingsToJson(JsonDocument &doc);
+void settingsFromJson(const JsonDocument &doc);
+void applySettings(const SettingsRecord &before);
+void markSettingsDirty();
+void configToJson(JsonDocument &doc);
+void settingsFlushStep();
+void broadcastConfig();
 void handleSave();
 void drawOrredrawStaticElements();
 void mountAndListSPIFFS(uint8_t levels = 255, bool listContent = true);
 void handlePNGUpload();
+const GFXfont *clockFont();
+void rebuildClockGlyphs();
+void setScrollText(const char *text);
+void drawClockFrames();
+void drawClockFrame(int y, uint16_t colour);
+void redrawClockFace(bool utc);
+void exitScreenSaver();
+void startBannerScreenSaver();
+void stepBannerScreenSaver();
+void serviceNetwork();
+void streamStep();
+void eventsStep();
+void clockTick();
+void bannerStep();
+void weatherUpdate();
+void screenSaverStep();
+void previewStartupLogo(unsigned long durationMs);
+bool logoPreviewStep();
+uint32_t bannerPeriodUs();
+int8_t addTaskOrHalt(const char *name, TaskScheduler::TaskFunction function, uint32_t periodUs, uint8_t priority,
+               uint32_t deadlineUs = 0);
+void heapStep();
+void sendJson(const JsonDocument &doc);
+void sendMetrics();
+void serveAsset(const char *uri, const char *path);
+void loadAssetCatalog();
+void saveAssetCatalog();
 
 // PNG Decoder Setup
 PNG png;
 fs::File pngFile; // Global File handle (required for PNGdec callbacks)
+const int pngBandLines = 16; // Rows per panel write, 10 kB of RGB565 at 320 wide, fewer when memory is short
 
 // Callback functions for PNGdec
 void *fileOpen(const char *filename, int32_t *size);
@@ -151,6 +280,8 @@ void setup()
 
     // 🔧 Mount SPIFFS
     mountAndListSPIFFS();
+    if (logoUpload.recover()) // A reset in the middle of replacing it
+        Serial.println("♻️ Restored /logo4.png after an interrupted upload");
 
     // Start the SPI for the touchscreen and init the touchscreen
     touchscreenSPI.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
@@ -163,6 +294,8 @@ void setup()
 
     // Load saved settings first
     loadSettings();
+    if (!timeZone.set(timeZoneRule.c_str()))
+        Serial.printf("⚠️ Invalid time zone \"%s\", local time shows UTC\n", timeZoneRule.c_str());
     // saveSettings();
     //  bannerSpeed=40;
     //   Initialize TFT display
@@ -171,8 +304,18 @@ void setup()
     tft.fillScreen(TFT_BLACK);
     Serial.println("TFT Display initialized!");
 
-    // Display PNG from SPIFFS
-    displayPNGfromSPIFFS(startupLogo.c_str(), 0);
+    // Startup logo: the decoded copy when it is current, else the PNG (which records a new copy)
+    uint32_t splashStartUs = micros();
+    String logoPath = "/" + startupLogo;
+    bootSplashCached = splashCache.show(tft, logoPath.c_str());
+    if (!bootSplashCached)
+        displayPNGfromSPIFFS(startupLogo.c_str(), 0);
+    bootSplashUs = micros() - splashStartUs;
+    Serial.printf("🖼️ Startup logo %s in %lu ms\n", bootSplashCached ? "from splash cache" : "decoded from PNG",
+                  (unsigned long)(bootSplashUs / 1000));
+
+    // Rasterise the clock digits once
+    rebuildClockGlyphs();
 
     // Connect to Wi-Fi
     connectWiFi();
@@ -185,8 +328,12 @@ void setup()
     String type = (ArduinoOTA.getCommand() == U_FLASH) ? "Firmware" : "Filesystem";
 
     Serial.println("🛠️ OTA Update Start: " + type);
+    if (settingsWriteBehind.dirty())
+        saveSettings(); // The restart after the update must not lose a colour change
 
-    // Clear TFT and display OTA message
+    // Clear TFT and display OTA message, on an unscrolled panel
+    if (screenSaver)
+        exitScreenSaver();
     tft.fillScreen(TFT_BLACK);
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
     tft.setFreeFont(&Orbitron_Light_32);
@@ -397,42 +544,67 @@ void setup()
     }
 
     // Start Web Server
-    server.on("/", handleRoot);                     // Serve the HTML page
-                                                    // Serve all static files (HTML, PNG, CSS, etc.)
-    server.serveStatic("/fonts", SPIFFS, "/fonts"); // optional
-    server.serveStatic("/logo1.png", SPIFFS, "/logo1.png");
-    server.serveStatic("/logo2.png", SPIFFS, "/logo2.png");
-    server.serveStatic("/logo3.png", SPIFFS, "/logo3.png");
-    server.serveStatic("/logo4.png", SPIFFS, "/logo4.png");
-    server.serveStatic("/logo4.png", SPIFFS, "/logo4.png");
-       server.serveStatic("/github.png", SPIFFS, "/github.png");
-    server.serveStatic("/favicon.ico", SPIFFS, "/favicon.ico");
+    // Page, images and fonts: the handler sends the headers, httpStreamer the body in slices
+    loadAssetCatalog();
+    const char *collectedHeaders[] = {"If-None-Match", "Accept-Encoding"};
+    server.collectHeaders(collectedHeaders, 2);
+    serveAsset("/", "/index.html");
+    serveAsset("/fonts", "/fonts"); // optional
+    serveAsset("/logo1.png", "/logo1.png");
+    serveAsset("/logo2.png", "/logo2.png");
+    serveAsset("/logo3.png", "/logo3.png");
+    serveAsset("/logo4.png", "/logo4.png");
+    serveAsset("/github.png", "/github.png");
+    serveAsset("/favicon.ico", "/favicon.ico");
     server.on("/config", HTTP_GET, []()
               {
-  StaticJsonDocument<1024> doc;
-
-  doc["latitude"] = latitude;
-  doc["longitude"] = longitude;
-  doc["localTimeColour"] = localTimeColour;
-  doc["utcTimeColour"] = utcTimeColour;
-  doc["doubleFrame"] = doubleFrame;
-  doc["localFrameColour"] = localFrameColour;
-  doc["utcFrameColour"] = utcFrameColour;
-  doc["bannerColour"] = bannerColour;
-  doc["bannerSpeed"] = bannerSpeed;
-  doc["localTimeLabel"] = localTimeLabel;
-  doc["utcTimeLabel"] = utcTimeLabel;
-  doc["startupLogo"] = startupLogo;
-  doc["italicClockFonts"] = italicClockFonts;
-doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minutes
-
-
-  String response;
-  serializeJson(doc, response);
-  server.send(200, "application/json", response); });
+  JsonDocument doc(&jsonArena);
+  configToJson(doc);
+  sendJson(doc); });
+
+    // 📡 One long-lived connection per open page, see EventStream.h
+    server.on("/events", HTTP_GET, []()
+              {
+    if (!eventStream.add(server.client())) {
+        server.sendHeader("Retry-After", "5");
+        server.send(503, "text/plain", "Busy");
+        return;
+    }
+    server.client().stop(); }); // The event stream keeps the connection, the server takes the next one
+
+    // 💾 All settings as JSON, the layout of the old /settings.json, for backup and restore
+    server.on("/settings", HTTP_GET, []()
+              {
+    JsonDocument doc(&jsonArena);
+    settingsToJson(doc);
+    sendJson(doc); });
+
+    server.on("/settings", HTTP_POST, []()
+              {
+    if (!server.hasArg("plain")) {
+        server.send(400, "text/plain", "Missing JSON body");
+        return;
+    }
+    JsonDocument doc(&jsonArena);
+    if (deserializeJson(doc, server.arg("plain"))) {
+        server.send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+    TimeZone zone;
+    if (!zone.set(doc["timeZone"] | timeZoneRule.c_str())) {
+        server.send(400, "text/plain", "Invalid time zone (POSIX TZ expected)");
+        return;
+    }
+    SettingsRecord before;
+    settingsToRecord(before);
+    settingsFromJson(doc);
+    saveSettings();
+    Serial.println("📥 Settings imported over HTTP");
+    applySettings(before);
+    server.send(200, "text/plain", "Settings imported"); });
 
     server.on("/scrolltext", []()
-              { server.send(200, "text/plain", scrollText); });
+              { server.send(200, "text/plain", scrollText.c_str()); });
 
     server.on("/setcolor", HTTP_POST, []() {
     if (!server.hasArg("plain")) {
@@ -440,7 +612,7 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    StaticJsonDocument<256> doc;
+    JsonDocument doc(&jsonArena);
     DeserializationError error = deserializeJson(doc, server.arg("plain"));
     if (error) {
         server.send(400, "text/plain", "JSON parse error");
@@ -448,14 +620,16 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
     }
 
     String target = doc["target"];
+    SettingsRecord before;
+    settingsToRecord(before);
 
     // ✅ Handle doubleFrame checkbox
     if (target == "doubleFrame") {
         bool thinBorder = doc["value"];
         doubleFrame = !thinBorder; // Inverse logic
         Serial.printf("🪟 doubleFrame set to: %s (thinBorder: %s)\n", doubleFrame ? "true" : "false", thinBorder ? "true" : "false");
-        saveSettings();
-        drawOrredrawStaticElements();
+        markSettingsDirty();
+        applySettings(before);
         server.send(200, "text/plain", "OK");
         return;
     }
@@ -484,10 +658,9 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    // 💾 Save and redraw for all standard color updates
-    saveSettings();
-    drawOrredrawStaticElements();
-    refreshDigits = true;
+    // 💾 Saved once the picker stops, redraw only the frame or digits that changed now
+    markSettingsDirty();
+    applySettings(before);
     server.send(200, "text/plain", "OK");
 });
 
@@ -504,7 +677,7 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    StaticJsonDocument<256> doc;
+    JsonDocument doc(&jsonArena);
     DeserializationError error = deserializeJson(doc, server.arg("plain"));
     if (error) {
         server.send(400, "text/plain", "JSON parse error");
@@ -512,8 +685,10 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
     }
 
     int speed = doc["speed"];  // This will already be 45 - slider
+    SettingsRecord before;
+    settingsToRecord(before);
     bannerSpeed = constrain(speed, 0, 45);
-    Serial.println(bannerSpeed);
+    applySettings(before);
 
     Serial.printf("🎬 bannerSpeed set to %d seconds\n", bannerSpeed);
     server.send(200, "text/plain", "OK"); });
@@ -526,7 +701,7 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    StaticJsonDocument<256> doc;
+    JsonDocument doc(&jsonArena);
     DeserializationError error = deserializeJson(doc, server.arg("plain"));
     if (error) {
         server.send(400, "text/plain", "JSON parse error");
@@ -535,6 +710,8 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
 
     String target = doc["target"];
     String value = doc["value"];
+    SettingsRecord before;
+    settingsToRecord(before);
 
     if (target == "localTimeLabel") {
  localTimeLabel = "  " + value + "  ";
@@ -547,9 +724,8 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    // Redraw labels immediately on screen
-    refreshFrames = true;
-    drawOrredrawStaticElements();
+    // Redraw the face with the new label
+    applySettings(before);
 
     server.send(200, "text/plain", "OK"); });
 
@@ -565,7 +741,7 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
     Serial.println("📩 Received JSON:");
     Serial.println(body);  // 🔍 Print raw incoming JSON for debugging
 
-    StaticJsonDocument<256> doc;
+    JsonDocument doc(&jsonArena);
     DeserializationError error = deserializeJson(doc, body);
     if (error) {
         Serial.println("❌ JSON parse error");
@@ -579,13 +755,15 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
+    SettingsRecord before;
+    settingsToRecord(before);
     latitude = doc["latitude"].as<float>();
     longitude = doc["longitude"].as<float>();
 
     Serial.printf("📍 Latitude updated to: %.6f\n", latitude);
     Serial.printf("📍 Longitude updated to: %.6f\n", longitude);
 
-    fetchWeatherData();
+    applySettings(before); // Fetches the weather for the new position
 
     server.send(200, "text/plain", "OK"); });
 
@@ -596,18 +774,20 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    StaticJsonDocument<128> doc;
+    JsonDocument doc(&jsonArena);
     DeserializationError error = deserializeJson(doc, server.arg("plain"));
     if (error) {
         server.send(400, "text/plain", "JSON parse error");
         return;
     }
 
+    SettingsRecord before;
+    settingsToRecord(before);
     italicClockFonts = doc["italicClockFonts"] | italicClockFonts;
 
     Serial.printf("✏️ italicClockFonts set to: %s\n", italicClockFonts ? "true" : "false");
 
-    drawOrredrawStaticElements();
+    applySettings(before);
     // Optionally persist
     // saveSettings();
 
@@ -629,7 +809,7 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
     Serial.println("\n📨 Received JSON from webpage:");
     Serial.println(json);
 
-    StaticJsonDocument<1024> doc;
+    JsonDocument doc(&jsonArena);
     DeserializationError error = deserializeJson(doc, json);
 
     if (error) {
@@ -639,7 +819,20 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    // 🔧 Apply settings directly to global variables (not config struct!)
+    // 🕒 Reject a time zone the clock could not use before anything is applied
+    const char *rule = doc["timeZone"] | timeZoneRule.c_str();
+    TimeZone zone;
+    if (!zone.set(rule)) {
+        Serial.printf("❌ Invalid time zone: %s\n", rule);
+        server.send(400, "text/plain", "Invalid time zone (POSIX TZ expected)");
+        return;
+    }
+
+    // 🔧 Apply settings directly to global variables, then redo only what changed
+    SettingsRecord before;
+    settingsToRecord(before);
+    if (doc["timeZone"].is<const char *>())
+        timeZoneRule     = rule;
     latitude             = doc["latitude"] | latitude;
     longitude            = doc["longitude"] | longitude;
     localTimeLabel       = doc["localTimeLabel"] | localTimeLabel;
@@ -648,6 +841,7 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
     doubleFrame          = doc["doubleFrame"] | doubleFrame;
     bannerSpeed          = doc["bannerSpeed"] | bannerSpeed;
     screenSaverTimeout   = doc["screenSaverTimeout"] | screenSaverTimeout;
+    bannerScreenSaver    = doc["bannerScreenSaver"] | bannerScreenSaver;
 
     // 📋 Debug printout of applied values
     Serial.println("📋 Parsed and applied config:");
@@ -662,43 +856,15 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
     Serial.printf("💤 ScreenSaver Timeout  : %lu ms (%.2f min)\n",
                   screenSaverTimeout,
                   screenSaverTimeout / 60000.0);
+    Serial.printf("📰 Banner ScreenSaver   : %s\n", bannerScreenSaver ? "true" : "false");
+    Serial.printf("🕒 Time Zone            : %s\n", timeZoneRule.c_str());
     Serial.println("──────────────────────────────────────────────");
 
-    // 💾 Save settings to SPIFFS (your version will do the actual work)
+    // 💾 Save settings to flash and show them, no restart
     saveSettings();
-    Serial.println("✅ Settings saved to flash.");
+    applySettings(before);
 
-    server.send(200, "text/plain", "💾 Settings saved to flash");
-    esp_restart(); });
-
-    server.on("/setbootimage", HTTP_POST, []()
-              {
-                  if (!server.hasArg("plain"))
-                  {
-                      server.send(400, "text/plain", "Missing body");
-                      return;
-                  }
-
-                  StaticJsonDocument<256> doc;
-                  DeserializationError error = deserializeJson(doc, server.arg("plain"));
-                  if (error)
-                  {
-                      server.send(400, "text/plain", "JSON parse error");
-                      return;
-                  }
-
-                  if (!doc.containsKey("bootImageId"))
-                  {
-                      server.send(400, "text/plain", "Missing bootImageId");
-                      return;
-                  }
-
-                  startupLogo = doc["bootImageId"].as<String>();
-                  Serial.printf("🖼️ Boot logo updated to: %s\n", startupLogo.c_str());
-                  saveSettings(); // 💾 Persist the change
-
-                  server.send(200, "text/plain", "Boot logo saved");
-                esp_restart(); });
+    server.send(200, "text/plain", "💾 Settings saved and applied"); });
 
     server.on("/setbootimage", HTTP_POST, []()
               {
@@ -707,7 +873,7 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
-    StaticJsonDocument<256> doc;
+    JsonDocument doc(&jsonArena);
     DeserializationError error = deserializeJson(doc, server.arg("plain"));
     if (error) {
         server.send(400, "text/plain", "JSON parse error");
@@ -719,18 +885,87 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
         return;
     }
 
+    SettingsRecord before;
+    settingsToRecord(before);
     startupLogo = doc["bootImageId"].as<String>();
     Serial.printf("🖼️ Boot logo updated to: %s\n", startupLogo.c_str());
 
     saveSettings(); // 💾 Persist the change
+    applySettings(before); // The logo is shown for a moment from the next screensaver step
 
     server.send(200, "text/plain", "Boot logo saved"); });
 
     server.on("/ping", HTTP_GET, []()
               { server.send(200, "text/plain", "pong"); });
 
+    // 🗓️ Scheduler statistics, run times in µs
+    server.on("/tasks", HTTP_GET, []()
+              {
+    JsonDocument doc(&jsonArena);
+    for (int8_t i = 0; i < scheduler.taskCount(); i++) {
+        const TaskScheduler::TaskStats &st = scheduler.taskStats(i);
+        JsonObject task = doc.add<JsonObject>();
+        task["name"] = scheduler.taskName(i);
+        task["periodUs"] = scheduler.taskPeriod(i);
+        task["runs"] = st.runs;
+        task["misses"] = st.misses;
+        task["skipped"] = st.skipped;
+        task["lastRunUs"] = st.lastRunUs;
+        task["avgRunUs"] = st.runs ? (uint32_t)(st.totalRunUs / st.runs) : 0;
+        task["maxRunUs"] = st.maxRunUs;
+        task["maxLatenessUs"] = st.maxLatenessUs;
+        task["maxStartDelayUs"] = st.maxStartDelayUs;
+    }
+
+    sendJson(doc); });
+
+    // 🕒 Second flip timing against the NTP timebase, in µs
+    server.on("/clock", HTTP_GET, []()
+              {
+    JsonDocument doc(&jsonArena);
+    const Timebase::Stats &st = timebase.stats();
+    doc["synced"] = timebase.isSet();
+    doc["rateErrorPpb"] = timebase.rateErrorPpb();
+    doc["flips"] = st.flips;
+    doc["lastFlipUs"] = st.lastFlipUs;
+    doc["avgFlipUs"] = st.flips ? (uint32_t)(st.totalFlipUs / st.flips) : 0;
+    doc["maxFlipUs"] = st.maxFlipUs;
+    doc["syncs"] = st.syncs;
+    doc["lastSyncErrorUs"] = st.lastSyncErrorUs;
+    doc["maxSyncErrorUs"] = st.maxSyncErrorUs;
+    doc["steps"] = st.steps;
+
+    sendJson(doc); });
+
+    // 📈 Prometheus metrics: loop and subsystem latency, SPI traffic, heap, NTP
+    server.on("/metrics", HTTP_GET, sendMetrics);
+
+    // 🧠 Heap health: free heap, largest free block and their lows, history oldest first
+    server.on("/heap", HTTP_GET, []()
+              {
+    JsonDocument doc(&jsonArena);
+    const HeapMonitor::Sample &now = heapMonitor.current();
+    const HeapMonitor::Sample &low = heapMonitor.lowest();
+    doc["freeBytes"] = now.freeBytes;
+    doc["largestBlock"] = now.largestBlock;
+    doc["fragmentationPct"] = heapMonitor.fragmentation();
+    doc["lowestFreeBytes"] = low.freeBytes;
+    doc["lowestLargestBlock"] = low.largestBlock;
+    doc["minFreeEver"] = ESP.getMinFreeHeap(); // Between samples too, kept by the allocator
+    doc["jsonArenaPeakBytes"] = jsonArena.peak(); // Of its capacity, see JsonArena.h
+    doc["jsonArenaFallbacks"] = jsonArena.fallbacks();
+    doc["intervalS"] = heapMonitor.intervalS();
+    JsonArray history = doc["history"].to<JsonArray>();
+    for (uint8_t i = 0; i < heapMonitor.historyCount(); i++) {
+        JsonArray slot = history.add<JsonArray>();
+        slot.add(heapMonitor.history(i).freeBytes);
+        slot.add(heapMonitor.history(i).largestBlock);
+    }
+
+    sendJson(doc); });
+
     server.on("/scrolltext", HTTP_GET, []()
-              { server.send(200, "text/plain", scrollText); });
+              { server.send(200, "text/plain", scrollText.c_str()); });
     server.on("/uploadpng", HTTP_POST, []()
               {
                   // ✅ no early response here
@@ -745,8 +980,6 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
     Serial.println("NTP Client initialized.");
     tft.fillScreen(TFT_BLACK);
 
-    fetchWeatherData();
-
     drawOrredrawStaticElements();
 
     // Create a sprite for the Weather text
@@ -763,96 +996,251 @@ doc["screenSaverTimeout"] = screenSaverTimeout / 60000;  // convert ms → minut
 
     // Calculate the initial position (rightmost position)
     textX = stext2.width();
+    setScrollText("Fetching weather data...");
+
+    // 🌐 Weather and NTP run on core 0, the UI never waits on the network
+    buildWeatherFilter();
+    if (!networkTask.start("network", networkLoop, nullptr, 8192, 1, 0))
+        Serial.println("❌ Failed to start network task");
+
+    // 🗓️ Tasks: name, function, period, priority (higher first), deadline
+    clockTask = addTaskOrHalt("clock", clockTick, 1000000UL, 4, 20000);
+    bannerTask = addTaskOrHalt("banner", bannerStep, bannerPeriodUs(), 3);
+    addTaskOrHalt("network", serviceNetwork, 2000, 2, 20000);
+    addTaskOrHalt("stream", streamStep, 1000, 2);
+    addTaskOrHalt("events", eventsStep, 20000, 2);
+    addTaskOrHalt("mailbox", serviceMailboxes, 50000, 2);
+    addTaskOrHalt("screensaver", screenSaverStep, 50000, 1);
+    addTaskOrHalt("weather", weatherUpdate, 5 * 60 * 1000000UL, 0); // First request right away
+    addTaskOrHalt("heap", heapStep, 1000000UL, 0);
+    addTaskOrHalt("settings", settingsFlushStep, 250000UL, 0);
+}
+
+// A task without a slot would silently never run: stop at boot instead, with the reason
+int8_t addTaskOrHalt(const char *name, TaskScheduler::TaskFunction function, uint32_t periodUs, uint8_t priority,
+               uint32_t deadlineUs)
+{
+    int8_t id = scheduler.addTask(name, function, periodUs, priority, deadlineUs);
+    if (id >= 0)
+        return id;
+    Serial.printf("❌ No scheduler slot for task \"%s\" (%u of %u used), halted\n", name, scheduler.taskCount(),
+                  TaskScheduler::MAX_TASKS);
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextColor(TFT_RED, TFT_BLACK);
+    tft.drawCentreString("Too many tasks, see serial log", 160, 110, 2);
+    for (;;)
+        delay(1000);
 }
 
 void loop()
 {
-    // 🔄 Handle OTA updates and incoming web requests
+    // 🗓️ Run the most urgent due task: clock, banner, web/OTA, screensaver, weather
+    uint32_t startUs = micros();
+    if (scheduler.runOnce())
+        loopHistogram.record(micros() - startUs);
+}
+
+// 🔄 Handle OTA updates and incoming web requests
+void serviceNetwork()
+{
     ArduinoOTA.handle();
+    ScopedTimer timer(handleClientHistogram);
     server.handleClient();
+}
 
-    unsigned long currentMillis = millis();
-    static unsigned long previousMillis = 0;
-    static unsigned long previousMillisForScroller = 0;
-    static unsigned long lastDotUpdate = 0;
-    static bool screenSaver = false;
+// 📤 Next slice of the files being sent to web clients
+void streamStep()
+{
+    httpStreamer.service();
+}
 
-    // ⏳ Check for inactivity → Enable screensaver
-    if (!screenSaver && currentMillis - lastActivity > screenSaverTimeout)
+// 📡 Queued events to the open pages
+void eventsStep()
+{
+    if (!eventStream.clients())
+        return;
+    ScopedTimer timer(eventsHistogram);
+    eventStream.service();
+}
+
+// 🕒 Clock tick, released on each predicted UTC second boundary
+void clockTick()
+{
+    static unsigned long lastEpoch = 0;
+
+    unsigned long epoch = currentEpoch();
+
+    if (!screenSaver && !logoPreviewShown)
     {
-        screenSaver = true;
-        Serial.println("⏳ Inactivity detected — entering screensaver.");
+        // Consecutive seconds only step the calendar fields, no conversion and no heap
+        static CivilClock localClock, utcClock;
+        char localTime[CIVIL_HMS_SIZE], utcTime[CIVIL_HMS_SIZE];
+        formatHMS(localClock.at(timeZone.toLocal(epoch)), localTime);
+        formatHMS(utcClock.at(epoch), utcTime);
+
+        uint32_t startUs = micros();
+        tft.setTextColor(TFT_WHITE);
+        tft.setFreeFont(clockFont());
+        displayTime(8, 5, localTime, previousLocalTime, 0, localTimeColour);
+        displayTime(10, 107, utcTime, previousUTCtime, 0, utcTimeColour);
+        displayTimeHistogram.record(micros() - startUs);
+
+        // Flip error: new digits on the panel versus the true start of their second
+        if (epoch == lastEpoch + 1 && timebase.isSet())
+            timebase.markFlip(epoch, micros());
     }
+    timebase.advance(micros());
 
-    // 💤 Screensaver Mode
-    if (screenSaver)
+    // 📡 Open pages show the clock's own time, also during the screensaver
+    if (epoch != lastEpoch && eventStream.clients())
     {
-        // 🌈 Refresh random pixel animation every 1 second
-        if (currentMillis - lastDotUpdate >= 1000)
-        {
-            tft.fillScreen(TFT_BLACK);
+        char tick[48];
+        snprintf(tick, sizeof(tick), "{\"utc\":%lu,\"local\":%lld}", epoch, (long long)timeZone.toLocal(epoch));
+        eventStream.broadcast("time", tick);
+    }
 
-            for (int i = 0; i < 200; i++)
-            {
-                int x = random(0, 320);
-                int y = random(0, 240);
-                uint16_t color = tft.color565(random(256), random(256), random(256));
-                tft.drawPixel(x, y, color);
-            }
+    // An NTP update can move the grid: a tick that lands just before the new boundary
+    // sees the old second and is released again right on the boundary
+    scheduler.setNextRelease(clockTask, timebase.nextBoundaryUs(micros()));
+    lastEpoch = epoch;
+}
 
-            lastDotUpdate = currentMillis;
-        }
+// 📰 Scroll banner text, one step per frame
+void bannerStep()
+{
+    if (logoPreviewShown)
+        return;
+    // Weather banner, one register write and one new column per step
+    if (screenSaver)
+    {
+        if (bannerScreenSaver)
+            stepBannerScreenSaver();
+        return;
+    }
 
-        // ✋ Exit screensaver on touchscreen interaction
-        if (touchscreen.tirqTouched() && touchscreen.touched())
-        {
-            TS_Point p = touchscreen.getPoint();
-            if (p.z > 200)
-            {
-                Serial.println("🖐 Touch detected — exiting screensaver.");
-                screenSaver = false;
-                tft.fillScreen(TFT_BLACK);
-                drawOrredrawStaticElements(); // 🖼️ Redraw UI frames
-                lastActivity = currentMillis; // 🔄 Reset inactivity timer
-            }
-        }
+    ScopedTimer timer(bannerHistogram);
+    if (tickerStrip.ready())
+    {
+        // Text was rendered once, only the visible window is pushed
+        tickerStrip.push(textX, 5, 205, bannerColour, TFT_BLACK);
+        textX -= 1;
+        if (textX < -tickerStrip.textWidth())
+            textX = tickerStrip.viewWidth();
     }
-    // 📺 Normal Mode (Active Display)
     else
     {
-        // 🕒 Update time display
-        timeClient.update();
-        long localEpoch = timeClient.getEpochTime() + (tOffset * 3600);
-        String localTime = formatLocalTime(localEpoch);
-        String utcTime = timeClient.getFormattedTime();
+        stext2.fillSprite(TFT_BLACK);
+        stext2.setTextColor(bannerColour);
+        stext2.drawString(scrollText.c_str(), textX, 0);
+        textX -= 1;
+        if (textX < -stext2.textWidth(scrollText.c_str()))
+            textX = stext2.width();
+        stext2.pushSprite(5, 205);
+    }
+}
 
-        tft.setTextColor(TFT_WHITE);
-        tft.setFreeFont(italicClockFonts ? &digital_7_monoitalic42pt7b : &digital_7__mono_42pt7b);
-        displayTime(8, 5, localTime, previousLocalTime, 0, localTimeColour);
-        displayTime(10, 107, utcTime, previousUTCtime, 0, utcTimeColour);
+// 🧠 Heap sample for /heap
+void heapStep()
+{
+    heapMonitor.sample();
+}
 
-        // 🌤️ Refresh weather data every 5 minutes
-        if (currentMillis - previousMillis >= 1000UL * 60 * 5)
+// 🌤️ Refresh weather data every 5 minutes
+void weatherUpdate()
+{
+    requestWeather();
+}
+
+// 💤 Screensaver: inactivity check, dot animation and touch to exit
+void screenSaverStep()
+{
+    if (logoPreviewStep())
+        return;
+    unsigned long currentMillis = millis();
+
+    // ⏳ Check for inactivity → Enable screensaver
+    if (!screenSaver && currentMillis - lastActivity > screenSaverTimeout)
+    {
+        screenSaver = true;
+        Serial.println("⏳ Inactivity detected — entering screensaver.");
+        if (bannerScreenSaver)
+            startBannerScreenSaver();
+    }
+    if (!screenSaver)
+        return;
+
+    // 🌈 Refresh random pixel animation every 1 second
+    if (!bannerScreenSaver && currentMillis - lastDotUpdate >= 1000)
+    {
+        tft.fillScreen(TFT_BLACK);
+
+        for (int i = 0; i < 200; i++)
         {
-            previousMillis = currentMillis;
-            fetchWeatherData();
+            int x = random(0, 320);
+            int y = random(0, 240);
+            uint16_t color = tft.color565(random(256), random(256), random(256));
+            tft.drawPixel(x, y, color);
         }
 
-        // 📰 Scroll banner text
-        if (currentMillis - previousMillisForScroller >= bannerSpeed)
+        lastDotUpdate = currentMillis;
+    }
+
+    // ✋ Exit screensaver on touchscreen interaction
+    if (touchscreen.tirqTouched() && touchscreen.touched())
+    {
+        TS_Point p = touchscreen.getPoint();
+        if (p.z > 200)
         {
-            previousMillisForScroller = currentMillis;
-            stext2.fillSprite(TFT_BLACK);
-            stext2.setTextColor(bannerColour);
-            stext2.drawString(scrollText, textX, 0);
-            textX -= 1;
-            if (textX < -stext2.textWidth(scrollText))
-                textX = stext2.width();
-            stext2.pushSprite(5, 205);
+            Serial.println("🖐 Touch detected — exiting screensaver.");
+            exitScreenSaver();
         }
+    }
+}
+
+// 🖼️ Show the startup logo for durationMs, from the next screensaver step
+void previewStartupLogo(unsigned long durationMs)
+{
+    logoPreviewMs = max(durationMs, 1UL);
+}
 
-        // 🖐 Optional: Add button or additional activity tracking here
+// One decode in one run, then the panel is the logo's until the time is up; true meanwhile
+bool logoPreviewStep()
+{
+    if (logoPreviewMs)
+    {
+        if (screenSaver)
+            exitScreenSaver(); // Unscrolled panel for the logo
+        displayPNGfromSPIFFS(startupLogo.c_str(), 0); // Also rebuilds the splash cache
+        logoPreviewUntil = millis() + logoPreviewMs;
+        logoPreviewMs = 0;
+        logoPreviewShown = true;
+        return true;
     }
+    if (!logoPreviewShown)
+        return false;
+    if ((long)(millis() - logoPreviewUntil) < 0)
+        return true;
+    logoPreviewShown = false;
+    tft.fillScreen(TFT_BLACK);
+    drawOrredrawStaticElements(); // Frames, labels and every digit again
+    lastActivity = millis();
+    return false;
+}
+
+// Back to the clock, from a touch, a settings change or a screen drawn over it
+void exitScreenSaver()
+{
+    screenSaver = false;
+    tft.resetScrollArea();
+    tft.fillScreen(TFT_BLACK);
+    drawOrredrawStaticElements(); // 🖼️ Redraw UI frames
+    lastActivity = millis();      // 🔄 Reset inactivity timer
+}
+
+// Banner frame period, bannerSpeed is the step time in ms
+uint32_t bannerPeriodUs()
+{
+    return max(bannerSpeed, 1) * 1000UL;
 }
 
 // 📶 Function to connect to Wi-Fi and initialize mDNS
@@ -890,255 +1278,369 @@ void connectWiFi()
     Serial.println(WiFi.localIP());
 }
 
-// Fetch weather data
-void fetchWeatherData()
+// Fields of the OpenWeather response the banner uses, everything else is skipped while parsing
+void buildWeatherFilter()
+{
+    weatherFilter["name"] = true;
+    weatherFilter["dt"] = true;
+    weatherFilter["main"]["temp"] = true;
+    weatherFilter["main"]["humidity"] = true;
+    weatherFilter["weather"][0]["description"] = true;
+    weatherFilter["sys"]["country"] = true;
+    weatherFilter["sys"]["sunrise"] = true;
+    weatherFilter["sys"]["sunset"] = true;
+}
+
+// Fetch weather data, runs on the network task: nothing here touches the display
+bool fetchWeatherReport(const WeatherRequest &request, WeatherReport &report)
 {
     HTTPClient http;
-    String weatherURL = weatherAPI + "?lat=" + String(latitude) + "&lon=" + String(longitude) + "&appid=" + apiKey + "&units=metric";
+    FixedString<256> weatherURL;
+    weatherURL.appendf("%s?lat=%.2f&lon=%.2f&appid=%s&units=metric", weatherAPI.c_str(), request.latitude, request.longitude, apiKey.c_str());
 
     // Make GET Request
-    http.begin(weatherURL);
+    http.useHTTP10(true); // No chunked transfer encoding, the stream is the plain JSON body
+    http.begin(weatherURL.c_str());
     Serial.println("");
-    Serial.println(weatherURL);
+    Serial.println(weatherURL.c_str());
     Serial.println("");
 
+    uint32_t startUs = micros();
     int httpCode = http.GET();
+    httpLatencyHistogram.record(micros() - startUs);
 
+    // Parse straight from the HTTP stream, only the filtered fields are stored. The few
+    // hundred bytes come from the heap: jsonArena belongs to the loop task.
+    JsonDocument doc;
+    DeserializationError error = DeserializationError::InvalidInput;
     if (httpCode == HTTP_CODE_OK)
     {
-        String payload = http.getString();
-        Serial.println(payload);
-        Serial.println("Weather data received.");
+        error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(weatherFilter));
+        if (error)
+        {
+            Serial.print("❌ Weather JSON parse error: ");
+            Serial.println(error.c_str());
+        }
+    }
 
-        // Parse the JSON response
-        DynamicJsonDocument doc(1024);
-        deserializeJson(doc, payload);
+    if (httpCode == HTTP_CODE_OK && !error)
+    {
+        const char *name = doc["name"] | "";
+        const char *sys_country = doc["sys"]["country"] | "";
+        long dt = doc["dt"];
+        float temp = doc["main"]["temp"];
+        int humidity = doc["main"]["humidity"];
+        const char *weatherDescription = doc["weather"][0]["description"] | "";
+        long sunrise = doc["sys"]["sunrise"];
+        long sunset = doc["sys"]["sunset"];
 
-        // Extracting values from the JSON response and assigning to variables
+        // Print the extracted values
+        Serial.println("Weather data received.");
+        Serial.printf("Location Name: %s, Country: %s\n", name, sys_country);
+        Serial.printf("Timestamp: %ld\n", dt);
+        Serial.printf("Temperature: %.2f, Humidity: %d\n", temp, humidity);
+        Serial.printf("Description: %s\n", weatherDescription);
+        Serial.printf("Sunrise: %ld, Sunset: %ld\n", sunrise, sunset);
+        Serial.printf("Parsed document: %u bytes\n", (unsigned)measureJson(doc));
+
+        // Convert sunrise and sunset times to local time, with the network task's own zone
+        // (its offset cache must not be shared with the clock on the other core)
+        static TimeZone zone;
+        if (strcmp(zone.rule(), request.timeZone) != 0)
+            zone.set(request.timeZone);
+        int64_t localSunrise = zone.toLocal(sunrise);
+        int64_t localSunset = zone.toLocal(sunset);
 
-        // Coordinates
-        float lon = doc["coord"]["lon"];
-        float lat = doc["coord"]["lat"];
+        // Convert sunrise and sunset times to human-readable format
+        CivilTime civil;
+        char sunriseTime[CIVIL_HMS_SIZE], sunsetTime[CIVIL_HMS_SIZE], date[CIVIL_DMY_SIZE];
+        civilFromEpoch(localSunrise, civil);
+        formatHMS(civil, sunriseTime);
+        civilFromEpoch(localSunset, civil);
+        formatHMS(civil, sunsetTime);
+        civilFromEpoch(dt, civil);
+        formatDMY(civil, date); // DD:MM:YY
+        // Build the scrollText with the date, weather, sunrise, and sunset times
+        report.text.clear();
+        report.text.appendf("%s     %s    %s     Temp: %.1f°C     RH: %d%%       %s       Sunrise: %s     Sunset: %s",
+                            name, sys_country, date, temp, humidity, weatherDescription, sunriseTime, sunsetTime);
+        Serial.println(report.text.c_str());
+        report.ok = true;
+    }
+    else
+    {
+        Serial.print("Error fetching weather data, HTTP code: ");
+        Serial.println(httpCode);
+        report.text = "Sorry, No Weather Info At This Moment!!!            Have you enterred your API key?"; // Text to scroll
+        report.ok = false;
+    }
 
-        // Weather
-        int weatherId = doc["weather"][0]["id"];
-        const char *weatherMain = doc["weather"][0]["main"];
-        const char *weatherDescription = doc["weather"][0]["description"];
-        const char *weatherIcon = doc["weather"][0]["icon"];
+    http.end();
+    return report.ok;
+}
 
-        // Base
-        const char *base = doc["base"];
+// 🌐 Network task on core 0: weather requests and NTP, results go back through mailboxes
+void networkLoop(void *arg)
+{
+    for (;;)
+    {
+        // Only the newest request matters, e.g. several /setposition calls in a row
+        WeatherRequest request;
+        if (weatherRequests.popLatest(request))
+        {
+            WeatherReport report;
+            uint32_t startUs = micros();
+            fetchWeatherReport(request, report);
+            weatherFetchHistogram.record(micros() - startUs);
+            if (!weatherReports.push(report))
+                Serial.println("⚠️ Weather report dropped, UI mailbox full");
+        }
 
-        // Main weather data
-        float temp = doc["main"]["temp"];
-        float feels_like = doc["main"]["feels_like"];
-        float temp_min = doc["main"]["temp_min"];
-        float temp_max = doc["main"]["temp_max"];
-        int pressure = doc["main"]["pressure"];
-        int humidity = doc["main"]["humidity"];
-        int sea_level = doc["main"]["sea_level"];
-        int grnd_level = doc["main"]["grnd_level"];
+        // Never waits: sends when due, later passes pick up the reply
+        uint32_t startUs = micros();
+        bool updated = timeClient.update();
+        ntpUpdateHistogram.record(micros() - startUs);
+        if (updated)
+        {
+            TimeSync sync = {timeClient.getEpochTimeAtLastUpdate(), timeClient.getLastUpdate()};
+            timeSyncs.push(sync);
+            ntpOffsetMs.store(timeClient.getOffsetMillis(), std::memory_order_relaxed);
+            ntpDelayMs.store(timeClient.getDelayMillis(), std::memory_order_relaxed);
+            Serial.printf("🕒 NTP update: offset %ld ms, round trip %lu ms\n", timeClient.getOffsetMillis(), timeClient.getDelayMillis());
+        }
 
-        // Visibility
-        int visibility = doc["visibility"];
+        BackgroundTask::sleepMs(20);
+    }
+}
 
-        // Wind data
-        float wind_speed = doc["wind"]["speed"];
-        int wind_deg = doc["wind"]["deg"];
-        float wind_gust = doc["wind"]["gust"];
+// Ask the network task for fresh weather at the current position, never blocks
+void requestWeather()
+{
+    WeatherRequest request = {latitude, longitude, ""};
+    strlcpy(request.timeZone, timeZone.rule(), sizeof(request.timeZone));
+    if (!weatherRequests.push(request))
+        Serial.println("⚠️ Weather request dropped, network mailbox full");
+}
 
-        // Rain data
-        float rain_1h = doc["rain"]["1h"];
+// 📬 Take new weather from the network task
+void serviceMailboxes()
+{
+    WeatherReport report;
+    if (weatherReports.popLatest(report))
+        setScrollText(report.text.c_str());
+}
 
-        // Clouds data
-        int clouds_all = doc["clouds"]["all"];
+// UTC seconds from the timebase, after applying the latest NTP time from the network task
+unsigned long currentEpoch()
+{
+    TimeSync sync;
+    if (timeSyncs.popLatest(sync))
+    {
+        // millis() and micros() count from the same boot, move the second start onto micros()
+        uint32_t nowUs = micros();
+        uint32_t startUs = nowUs - (millis() - sync.millisAt) * 1000UL;
+        timebase.sync(sync.epoch, startUs);
+        const Timebase::Stats &st = timebase.stats();
+        Serial.printf("🕒 Timebase sync: prediction off by %ld µs, rate %ld ppb\n", (long)st.lastSyncErrorUs, (long)timebase.rateErrorPpb());
+    }
+    return timebase.epochAt(micros());
+}
 
-        // Date/Time
-        long dt = doc["dt"];
 
-        // System data
-        int sys_type = doc["sys"]["type"];
-        int sys_id = doc["sys"]["id"];
-        const char *sys_country = doc["sys"]["country"];
-        long sunrise = doc["sys"]["sunrise"];
-        long sunset = doc["sys"]["sunset"];
 
-        // Timezone
-        int timezone = doc["timezone"];
+// Screensaver with the weather banner scrolled by the display controller. Only the
+// frames are drawn: they look the same after scrolling, the labels and digits would not.
+void startBannerScreenSaver()
+{
+    tft.fillScreen(TFT_BLACK);
+    drawClockFrames();
+    tft.setScrollArea(bannerScrollMargin, bannerScrollMargin);
+    bannerScrollColumn = 0;
+}
 
-        // Location data
-        int id = doc["id"];
-        const char *name = doc["name"];
+void stepBannerScreenSaver()
+{
+    int32_t scrollWidth = tft.width() - 2 * bannerScrollMargin;
 
-        // Status code
-        int cod = doc["cod"];
+    // The column that just left on the left reappears on the right, draw the new text there
+    tft.scrollTo(tft.getScrollOffset() + 1);
+    int32_t x = bannerScrollMargin + (tft.getScrollOffset() + scrollWidth - 1) % scrollWidth;
+    tickerStrip.pushColumn(bannerScrollColumn, x, 205, bannerColour, TFT_BLACK);
 
-        // Print the extracted values
-        Serial.println("Weather data received.");
-        Serial.print("Coordinates: ");
-        Serial.print("Longitude: ");
-        Serial.print(lon);
-        Serial.print(", Latitude: ");
-        Serial.println(lat);
-
-        Serial.print("Weather ID: ");
-        Serial.println(weatherId);
-        Serial.print("Main: ");
-        Serial.println(weatherMain);
-        Serial.print("Description: ");
-        Serial.println(weatherDescription);
-        Serial.print("Icon: ");
-        Serial.println(weatherIcon);
-
-        Serial.print("Base: ");
-        Serial.println(base);
-
-        Serial.print("Temperature: ");
-        Serial.println(temp);
-        Serial.print("Feels like: ");
-        Serial.println(feels_like);
-        Serial.print("Min Temp: ");
-        Serial.println(temp_min);
-        Serial.print("Max Temp: ");
-        Serial.println(temp_max);
-        Serial.print("Pressure: ");
-        Serial.println(pressure);
-        Serial.print("Humidity: ");
-        Serial.println(humidity);
-        Serial.print("Sea level: ");
-        Serial.println(sea_level);
-        Serial.print("Ground level: ");
-        Serial.println(grnd_level);
-
-        Serial.print("Visibility: ");
-        Serial.println(visibility);
-
-        Serial.print("Wind speed: ");
-        Serial.println(wind_speed);
-        Serial.print("Wind degree: ");
-        Serial.println(wind_deg);
-        Serial.print("Wind gust: ");
-        Serial.println(wind_gust);
-
-        Serial.print("Rain 1h: ");
-        Serial.println(rain_1h);
-
-        Serial.print("Clouds: ");
-        Serial.println(clouds_all);
-
-        Serial.print("Timestamp: ");
-        Serial.println(dt);
-
-        Serial.print("System type: ");
-        Serial.println(sys_type);
-        Serial.print("System ID: ");
-        Serial.println(sys_id);
-        Serial.print("Country: ");
-        Serial.println(sys_country);
-        Serial.print("Sunrise: ");
-        Serial.println(sunrise);
-        Serial.print("Sunset: ");
-        Serial.println(sunset);
-
-        Serial.print("Timezone: ");
-        Serial.println(timezone);
-
-        Serial.print("Location ID: ");
-        Serial.println(id);
-        Serial.print("Location Name: ");
-        Serial.println(name);
-
-        Serial.print("Status code: ");
-        Serial.println(cod);
-
-        // Convert sunrise and sunset times to local time
-        long localSunrise = sunrise + (tOffset * 3600); // Adjust for local time (seconds)
-        long localSunset = sunset + (tOffset * 3600);   // Adjust for local time (seconds)
+    // Let the text clear the screen before it starts again
+    if (++bannerScrollColumn >= tickerStrip.textWidth() + scrollWidth)
+        bannerScrollColumn = 0;
+}
 
-        // Convert sunrise and sunset times to human-readable format
-        String sunriseTime = convertEpochToTimeString(localSunrise);
-        String sunsetTime = convertEpochToTimeString(localSunset);
-        String date = convertTimestampToDate(dt); // Convert to DD:MM:YY format
-        // Build the scrollText with the date, weather, sunrise, and sunset times
-        scrollText = String(name) + "     " + sys_country + "    " +
-                     date + "     " +
-                     "Temp: " + String(temp, 1) + "°C     " + // One decimal place for temp
-                     "RH: " + String(humidity) + "%" + "       " +
-                     String(weatherDescription) + "       " +
-                     "Sunrise: " + sunriseTime + "     " +
-                     "Sunset: " + sunsetTime;
-
-        stext2.drawString(scrollText, textX, 0); // Draw text in sprite at position textX
-        textX = stext2.width();
-        Serial.println(scrollText);
-    }
-    else
+// Send a JSON response without building it in a String, handlers all run on the loop task
+void sendJson(const JsonDocument &doc)
+{
+    static char buffer[4096];
+    size_t length = measureJson(doc);
+    if (length >= sizeof(buffer))
     {
-        Serial.print("Error fetching weather data, HTTP code: ");
-        Serial.println(httpCode);
-scrollText = "Sorry, No Weather Info At This Moment!!!            Have you enterred your API key?"; // Text to scroll
-        textX = stext2.width();
+        server.send(500, "text/plain", "Response too large");
+        return;
     }
+    serializeJson(doc, buffer, sizeof(buffer));
+    server.send_P(200, "application/json", buffer, length);
+}
 
-    http.end();
+// Chunks of the /metrics reply go straight to the client
+void sendMetricsChunk(const char *text, size_t length)
+{
+    server.sendContent(text, length);
 }
 
-// Function to format the local time from epoch time
-String formatLocalTime(long epochTime)
+// Prometheus text format, written in chunks so the reply never sits in memory whole
+void sendMetrics()
 {
-    struct tm *timeInfo;
-    timeInfo = localtime(&epochTime); // Convert epoch to local time
-    char buffer[9];
-    strftime(buffer, sizeof(buffer), "%H:%M:%S", timeInfo); // Format time as HH:MM:SS
-    return String(buffer);
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4", "");
+
+    MetricsWriter out(sendMetricsChunk);
+    out.describe("hamclock_loop_duration_seconds", "histogram", "loop() iterations that ran a scheduler task");
+    out.histogram("hamclock_loop_duration_seconds", nullptr, loopHistogram);
+
+    out.describe("hamclock_subsystem_duration_seconds", "histogram", "Time spent per call in each subsystem");
+    out.histogram("hamclock_subsystem_duration_seconds", "subsystem=\"display_time\"", displayTimeHistogram);
+    out.histogram("hamclock_subsystem_duration_seconds", "subsystem=\"banner_push\"", bannerHistogram);
+    out.histogram("hamclock_subsystem_duration_seconds", "subsystem=\"handle_client\"", handleClientHistogram);
+    out.histogram("hamclock_subsystem_duration_seconds", "subsystem=\"weather_fetch\"", weatherFetchHistogram);
+    out.histogram("hamclock_subsystem_duration_seconds", "subsystem=\"ntp_update\"", ntpUpdateHistogram);
+    out.histogram("hamclock_subsystem_duration_seconds", "subsystem=\"settings_write\"", settingsWriteHistogram);
+    out.histogram("hamclock_subsystem_duration_seconds", "subsystem=\"events\"", eventsHistogram);
+
+    out.describe("hamclock_http_fetch_latency_seconds", "histogram", "Weather request until the response headers");
+    out.histogram("hamclock_http_fetch_latency_seconds", nullptr, httpLatencyHistogram);
+
+    out.describe("hamclock_http_streams", "gauge", "Files being sent to web clients");
+    out.value("hamclock_http_streams", nullptr, httpStreamer.active());
+    out.describe("hamclock_http_stream_bytes_total", "counter", "File bytes sent to web clients");
+    out.value("hamclock_http_stream_bytes_total", nullptr, httpStreamer.stats().bytes);
+
+    out.describe("hamclock_spi_pixel_bytes_total", "counter", "RGB565 pixel data pushed to the display");
+    out.value("hamclock_spi_pixel_bytes_total", nullptr, tft.pixelsPushed() * 2);
+
+    out.describe("hamclock_settings_changes_total", "counter", "Settings changes from the web page, saved by coalesced writes");
+    out.value("hamclock_settings_changes_total", nullptr, settingsWriteBehind.stats().changes);
+    out.describe("hamclock_settings_writes_total", "counter", "Settings records written to flash");
+    out.value("hamclock_settings_writes_total", nullptr, settingsStore.writes());
+    out.describe("hamclock_settings_flush_latency_seconds", "histogram", "From a settings change until it is on flash");
+    out.histogram("hamclock_settings_flush_latency_seconds", nullptr, settingsFlushHistogram);
+
+    out.describe("hamclock_sse_clients", "gauge", "Pages connected to /events");
+    out.value("hamclock_sse_clients", nullptr, eventStream.clients());
+    out.describe("hamclock_sse_events_total", "counter", "Events pushed to /events clients");
+    out.value("hamclock_sse_events_total", nullptr, eventStream.stats().events);
+    out.describe("hamclock_sse_dropped_total", "counter", "/events clients dropped as slow, idle or gone");
+    out.value("hamclock_sse_dropped_total", nullptr, eventStream.stats().dropped);
+    out.describe("hamclock_sse_bytes_total", "counter", "Bytes sent to /events clients");
+    out.value("hamclock_sse_bytes_total", nullptr, eventStream.stats().bytes);
+
+    out.describe("hamclock_boot_splash_seconds", "gauge", "Time to show the startup logo at boot");
+    out.seconds("hamclock_boot_splash_seconds", bootSplashCached ? "path=\"cache\"" : "path=\"png\"", bootSplashUs);
+
+    out.describe("hamclock_heap_free_bytes", "gauge", "Free heap");
+    out.value("hamclock_heap_free_bytes", nullptr, ESP.getFreeHeap());
+    out.describe("hamclock_heap_min_free_bytes", "gauge", "Lowest free heap since boot");
+    out.value("hamclock_heap_min_free_bytes", nullptr, ESP.getMinFreeHeap());
+    out.describe("hamclock_heap_min_largest_block_bytes", "gauge", "Lowest largest free block seen by the heap task");
+    out.value("hamclock_heap_min_largest_block_bytes", nullptr, heapMonitor.lowest().largestBlock);
+
+    out.describe("hamclock_ntp_offset_seconds", "gauge", "Clock offset measured by the last NTP update");
+    out.seconds("hamclock_ntp_offset_seconds", nullptr, (int64_t)ntpOffsetMs.load(std::memory_order_relaxed) * 1000);
+    out.describe("hamclock_ntp_delay_seconds", "gauge", "Round trip of the last NTP update");
+    out.seconds("hamclock_ntp_delay_seconds", nullptr, (int64_t)ntpDelayMs.load(std::memory_order_relaxed) * 1000);
+
+    out.flush();
+    server.sendContent(""); // Last chunk
 }
 
-// Function to convert an epoch time to a human-readable time string
-String convertEpochToTimeString(long epochTime)
+// A file from SPIFFS, sent with its ETag and encoding from the asset catalog
+void serveAsset(const char *uri, const char *path)
 {
-    struct tm *timeInfo;
-    timeInfo = localtime(&epochTime); // Convert epoch to local time
-    char buffer[9];
-    strftime(buffer, sizeof(buffer), "%H:%M:%S", timeInfo); // Format time as HH:MM:SS
-    return String(buffer);
+    server.addHandler(new StreamedFileHandler(httpStreamer, assetCatalog, SPIFFS, uri, path));
 }
 
-// Function to display time (local or UTC) with change detection and custom font color
-void displayTime(int x, int y, String time, String &previousTime, int yOffset, uint16_t fontColor)
+// 🏷️ ETags and encodings written by scripts/build_assets.py with the SPIFFS image
+void loadAssetCatalog()
 {
-    if (refreshDigits)
+    fs::File file = SPIFFS.open("/assets.txt", "r");
+    if (!file)
     {
-        refreshDigitsCounter++;
-        if (refreshDigitsCounter == 1)
-        {
-            // First call — force clear by using empty string
-            previousTime = "";
-        }
-        else if (refreshDigitsCounter >= 2)
-        {
-            // Second call — stop refreshing
-            previousTime = "";
-            refreshDigits = false;
-            refreshDigitsCounter = 0;
-        }
+        Serial.println("⚠️ /assets.txt missing, web files are sent without ETags");
+        return;
     }
+    Serial.printf("🏷️ %u web files with ETags\n", assetCatalog.load(file));
+    file.close();
+}
+
+void saveAssetCatalog()
+{
+    fs::File file = SPIFFS.open("/assets.txt", FILE_WRITE);
+    if (!file || !assetCatalog.save(file))
+        Serial.println("❌ Failed to save /assets.txt");
+    file.close();
+}
 
+// Replace the banner text and render it once into the ticker strip
+void setScrollText(const char *text)
+{
+    scrollText = text;
+    eventStream.broadcast("banner", scrollText.c_str()); // New weather for the open pages
+    if (!tickerStrip.render(scrollText.c_str(), &Orbitron_Medium10pt7b))
+        Serial.println("⚠️ Ticker strip unavailable, rendering banner per frame");
+    textX = stext2.width();
+}
+
+// Function to display time (local or UTC) with change detection and custom font color
+void displayTime(int x, int y, const char *time, char *previousTime, int yOffset, uint16_t fontColor)
+{
     // Define the calculated positions for each character
     int positions[] = {x, x + 48, x + 78, x + 108, x + 156, x + 186, x + 216, x + 264};
 
+    // Cached glyphs are only valid for the font they were built from
+    bool useCache = clockGlyphs.font() == clockFont();
+
     // Loop over the time string and compare it with the previous time
-    for (int i = 0; i < time.length(); i++)
+    for (int i = 0; time[i] && i < (int)CIVIL_HMS_SIZE - 1; i++)
     {
         if (time[i] != previousTime[i])
         {
-            tft.setTextColor(TFT_BLACK);
-            tft.drawString(String(previousTime[i]), positions[i], y + yOffset, 1);
-            tft.setTextColor(fontColor);
-            tft.drawString(String(time[i]), positions[i], y + yOffset, 1);
+            // Changed segments only, else one opaque pass over the character cell
+            if (useCache && segmentClock.drawTransition(previousTime[i], time[i], positions[i], y + yOffset, fontColor, TFT_BLACK))
+                continue;
+            // Digits share a cell, the colon has its own: it sits closer to a digit than a digit cell is wide
+            tft.setFreeFontCell(time[i] == ':' ? ":" : "0123456789");
+            tft.setTextColor(fontColor, TFT_BLACK);
+            char glyph[2] = {time[i], '\0'};
+            tft.drawString(glyph, positions[i], y + yOffset, 1);
         }
     }
 
-    previousTime = time;
+    strlcpy(previousTime, time, CIVIL_HMS_SIZE);
+}
+
+// Clock font selected by the italic setting
+const GFXfont *clockFont()
+{
+    return italicClockFonts ? &digital_7_monoitalic42pt7b : &digital_7__mono_42pt7b;
+}
+
+// Rasterise the clock digits for the current clock font
+void rebuildClockGlyphs()
+{
+    if (clockGlyphs.font() == clockFont())
+        return;
+    if (clockGlyphs.build(clockFont()))
+    {
+        Serial.printf("🔢 Clock glyphs cached (%dx%d digit cell)\n", clockGlyphs.cell('0').w, clockGlyphs.cell('0').h);
+        if (segmentClock.build())
+            Serial.printf("🔢 %d digit segments found\n", segmentClock.segmentCount());
+    }
+    else
+        Serial.println("⚠️ Clock glyph cache unavailable, using font rendering");
 }
 
 // PNG Decoder Callback Functions
@@ -1177,78 +1679,97 @@ void displayPNGfromSPIFFS(const char *filename, int duration_ms)
         return;
     }
 
+    // Rows arrive in bands fitted to the screen, one address window each
     int16_t rc = png.open(filename, fileOpen, fileClose, fileRead, fileSeek, [](PNGDRAW *pDraw)
                           {
-    uint16_t lineBuffer[480];  // Adjust to your screen width if needed
-    png.getLineAsRGB565(pDraw, lineBuffer, PNG_RGB565_BIG_ENDIAN, 0xFFFFFFFF);
-    tft.pushImage(0, pDraw->y, pDraw->iWidth, 1, lineBuffer); });
+    tft.pushImage(pDraw->x, pDraw->y, pDraw->iWidth, pDraw->iLines, pDraw->pBand);
+    for (int i = 0; i < pDraw->iLines; i++)
+        splashCache.addLine(pDraw->pBand + i * pDraw->iWidth); });
+
+    // Any size is shrunk (box filter) to fit and centred, memory stays one band and one row of sums
+    if (rc == PNG_SUCCESS)
+        rc = png.setScale(tft.width(), tft.height());
+    uint16_t *band = nullptr;
+    if (rc == PNG_SUCCESS)
+    {
+        int lines = pngBandLines;
+        while (!band && lines)
+        {
+            band = (uint16_t *)malloc(png.getOutputWidth() * lines * sizeof(uint16_t));
+            if (!band)
+                lines /= 2;
+        }
+        if (band)
+            png.setBand(band, lines, PNG_RGB565_LITTLE_ENDIAN, 0xFFFFFFFF);
+        else
+            rc = PNG_MEM_ERROR;
+    }
 
     if (rc == PNG_SUCCESS)
     {
-        Serial.printf("Displaying PNG: %s\n", filename);
+        Serial.printf("Displaying PNG: %s (%d x %d shown as %d x %d)\n", filename, png.getWidth(), png.getHeight(),
+                      png.getOutputWidth(), png.getOutputHeight());
+        int x = (tft.width() - png.getOutputWidth()) / 2;
+        int y = (tft.height() - png.getOutputHeight()) / 2;
+        if (png.getOutputWidth() < tft.width() || png.getOutputHeight() < tft.height())
+            tft.fillScreen(TFT_BLACK); // Border around a smaller image
+
+        // The startup logo is kept decoded, the next boot shows it without inflating
+        String path = String("/") + filename;
+        if (startupLogo == filename)
+            splashCache.begin(path.c_str(), x, y, png.getOutputWidth(), png.getOutputHeight());
+
+        bool swap = tft.getSwapBytes();
+        tft.setSwapBytes(true); // Lines are native RGB565
         tft.startWrite();
-        png.decode(nullptr, 0);
+        rc = png.decode(nullptr, 0);
         tft.endWrite();
+        tft.setSwapBytes(swap);
+
+        if (rc != PNG_SUCCESS)
+        {
+            splashCache.abort();
+            Serial.printf("⚠️ PNG decode failed (error %d)\n", rc);
+        }
+        else if (splashCache.recording() && splashCache.end())
+            Serial.printf("🖼️ Splash cache rebuilt from %s\n", filename);
     }
     else
     {
-        Serial.println("PNG decode failed.");
+        Serial.printf("⚠️ PNG decode failed (error %d)\n", rc);
     }
+    png.close();
+    free(band);
 
     delay(duration_ms);
 }
 
-// Function to convert Unix timestamp to human-readable format (DD:MM:YY)
-String convertTimestampToDate(long timestamp)
-{
-    struct tm *timeinfo;
-    timeinfo = localtime(&timestamp);                       // Convert epoch to local time
-    char buffer[11];                                        // Buffer for "DD:MM:YY"
-    strftime(buffer, sizeof(buffer), "%d:%m:%y", timeinfo); // Format as DD:MM:YY
-    return String(buffer);
-}
-
-// Load settings from SPIFFS JSON
+// Load settings from the binary store, once from the old JSON file, else keep the defaults
 void loadSettings()
 {
-
-    fs::File file = SPIFFS.open("/settings.json", "r"); // ✅ OPEN IN READ MODE
-    if (!file)
+    SettingsRecord r;
+    settingsToRecord(r); // Defaults for fields an older record does not have
+    uint16_t version;
+    if (settingsStore.load(&r, sizeof(r), version))
     {
-        Serial.println("⚠️ Could not open settings file. Using defaults.");
-        saveSettings();
-        esp_restart();
-        return;
+        settingsFromRecord(r);
+        Serial.printf("✅ Settings record #%u (layout %u) from slot %d\n", (unsigned)settingsStore.sequence(),
+                      version, settingsStore.slot());
+        // Conversions of older layouts go here, oldest first; appended fields need none. A
+        // newer layout, saved by later firmware, is left for that firmware to read back
+        if (version < SETTINGS_VERSION)
+            saveSettings();
     }
-
-    StaticJsonDocument<1024> doc;
-    DeserializationError error = deserializeJson(doc, file);
-    if (error)
+    else if (importLegacySettings())
+        Serial.println("✅ Settings imported from /settings.json");
+    else
     {
-        Serial.println("⚠️ Failed to parse settings file. Using defaults.");
-        file.close();
-        return;
+        Serial.println("⚠️ No saved settings, using defaults");
+        saveSettings();
     }
-
-    file.close(); // Always close file after use
-
-    latitude = doc["latitude"] | latitude;
-    longitude = doc["longitude"] | longitude;
-    localTimeColour = doc["localTimeColour"] | localTimeColour;
-    utcTimeColour = doc["utcTimeColour"] | utcTimeColour;
-    doubleFrame = doc["doubleFrame"] | doubleFrame;
-    localFrameColour = doc["localFrameColour"] | localFrameColour;
-    utcFrameColour = doc["utcFrameColour"] | utcFrameColour;
-    bannerColour = doc["bannerColour"] | bannerColour;
-    bannerSpeed = doc["bannerSpeed"] | bannerSpeed;
-    localTimeLabel = doc["localTimeLabel"] | localTimeLabel;
-    utcTimeLabel = doc["utcTimeLabel"] | utcTimeLabel;
-    startupLogo = doc["startupLogo"] | startupLogo;
-    italicClockFonts = doc["italicClockFonts"] | italicClockFonts;
-    screenSaverTimeout = doc["screenSaverTimeout"] | screenSaverTimeout;
     Serial.println();
     Serial.println("-----------------------------------------------------------------");
-    Serial.println("✅ Settings loaded from SPIFFS:");
+    Serial.println("✅ Settings in use:");
     Serial.printf("📍 latitude: %.6f\n", latitude);
     Serial.printf("📍 longitude: %.6f\n", longitude);
     Serial.printf("🎨 localTimeColour: 0x%04X\n", localTimeColour);
@@ -1263,44 +1784,38 @@ void loadSettings()
     Serial.printf("🖼️ startupLogo: %s\n", startupLogo.c_str());
     Serial.printf("🔤 italicClockFonts: %s\n", italicClockFonts ? "true" : "false");
     Serial.printf("🕓 screenSaverTimeout: %lu ms\n", screenSaverTimeout);
+    Serial.printf("📰 bannerScreenSaver: %s\n", bannerScreenSaver ? "true" : "false");
+    Serial.printf("🕒 timeZone: %s\n", timeZoneRule.c_str());
     Serial.println("-----------------------------------------------------------------");
 }
 
-// Save settings to SPIFFS
+// Save settings to the spare slot of the binary store
 void saveSettings()
 {
-    StaticJsonDocument<1024> doc;
-    doc["latitude"] = latitude;
-    doc["longitude"] = longitude;
-    doc["localTimeColour"] = localTimeColour;
-    doc["utcTimeColour"] = utcTimeColour;
-    doc["doubleFrame"] = doubleFrame;
-    doc["localFrameColour"] = localFrameColour;
-    doc["utcFrameColour"] = utcFrameColour;
-    doc["bannerColour"] = bannerColour;
-    doc["bannerSpeed"] = bannerSpeed;
-    doc["localTimeLabel"] = localTimeLabel;
-    doc["utcTimeLabel"] = utcTimeLabel;
-    doc["startupLogo"] = startupLogo;
-    doc["italicClockFonts"] = italicClockFonts;
-    doc["screenSaverTimeout"] = screenSaverTimeout;
-
-    fs::File file = SPIFFS.open("/settings.json", "w");
-
-    if (!file)
+    SettingsRecord r;
+    settingsToRecord(r);
+    uint32_t startUs = micros();
+    bool saved = settingsStore.save(&r, sizeof(r), SETTINGS_VERSION);
+    uint32_t writeUs = micros() - startUs;
+    settingsWriteHistogram.record(writeUs);
+    if (!saved)
     {
-        Serial.println("❌ Failed to open settings file for writing");
+        settingsWriteBehind.failed(millis());
+        Serial.println("❌ Failed to write the settings record");
         return;
     }
-
-    serializeJsonPretty(doc, file);
-    file.close();
+    // Any pending change is in this record too
+    if (settingsWriteBehind.dirty())
+        settingsFlushHistogram.record(settingsWriteBehind.flushed(millis()) * 1000);
+    if (configBroadcastPending)
+        broadcastConfig();
 
     // ✅ Nicely formatted output
     Serial.println("");
     Serial.println(F("────────────────────────────────────────"));
 
-    Serial.println("💾 Saving settings to SPIFFS:");
+    Serial.printf("💾 Settings record #%u saved to slot %d in %u µs:\n", (unsigned)settingsStore.sequence(),
+                  settingsStore.slot(), (unsigned)writeUs);
     Serial.println(F("────────────────────────────────────────"));
     Serial.printf("🌍 Latitude           : %f\n", latitude);
     Serial.printf("🌍 Longitude          : %f\n", longitude);
@@ -1316,29 +1831,211 @@ void saveSettings()
     Serial.printf("🖼️  Startup Logo      : %s\n", startupLogo.c_str());
     Serial.printf("✏️  Italic Fonts      : %s\n", italicClockFonts ? "true" : "false");
     Serial.printf("😴 Screensaver (ms)   : %lu\n", screenSaverTimeout);
+    Serial.printf("📰 Banner Screensaver : %s\n", bannerScreenSaver ? "true" : "false");
+    Serial.printf("🕒 Time Zone          : %s\n", timeZoneRule.c_str());
     Serial.println(F("────────────────────────────────────────"));
-
-    Serial.println("✅ Settings saved to SPIFFS and restarting...");
     Serial.println("");
 }
 
-// Serve index.html from SPIFFS
-void handleRoot()
+// Settings before the binary store: applied and saved once, the file goes afterwards
+bool importLegacySettings()
 {
-
-    fs::File file = SPIFFS.open("/index.html", "r"); // ✅ Declare 'file' properly here
+    fs::File file = SPIFFS.open("/settings.json", "r");
     if (!file)
+        return false;
+    JsonDocument doc(&jsonArena); // In setup(), on the loop task as the handlers
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error)
     {
-        server.send(500, "text/plain", "⚠️ Failed to open index.html");
+        Serial.println("⚠️ Failed to parse /settings.json, using defaults");
+        return false;
+    }
+    settingsFromJson(doc);
+    saveSettings();
+    if (settingsStore.slot() >= 0) // Saved, a power cut before the removal imports it again
+        SPIFFS.remove("/settings.json");
+    return true;
+}
+
+void settingsToRecord(SettingsRecord &r)
+{
+    memset(&r, 0, sizeof(r));
+    r.latitude = latitude;
+    r.longitude = longitude;
+    r.localTimeColour = localTimeColour;
+    r.utcTimeColour = utcTimeColour;
+    r.localFrameColour = localFrameColour;
+    r.utcFrameColour = utcFrameColour;
+    r.bannerColour = bannerColour;
+    r.doubleFrame = doubleFrame;
+    r.italicClockFonts = italicClockFonts;
+    r.bannerScreenSaver = bannerScreenSaver;
+    r.bannerSpeed = bannerSpeed;
+    r.screenSaverTimeout = screenSaverTimeout;
+    strlcpy(r.localTimeLabel, localTimeLabel.c_str(), sizeof(r.localTimeLabel));
+    strlcpy(r.utcTimeLabel, utcTimeLabel.c_str(), sizeof(r.utcTimeLabel));
+    strlcpy(r.startupLogo, startupLogo.c_str(), sizeof(r.startupLogo));
+    strlcpy(r.timeZone, timeZoneRule.c_str(), sizeof(r.timeZone));
+}
+
+void settingsFromRecord(SettingsRecord &r)
+{
+    latitude = r.latitude;
+    longitude = r.longitude;
+    localTimeColour = r.localTimeColour;
+    utcTimeColour = r.utcTimeColour;
+    localFrameColour = r.localFrameColour;
+    utcFrameColour = r.utcFrameColour;
+    bannerColour = r.bannerColour;
+    doubleFrame = r.doubleFrame;
+    italicClockFonts = r.italicClockFonts;
+    bannerScreenSaver = r.bannerScreenSaver;
+    bannerSpeed = r.bannerSpeed;
+    screenSaverTimeout = r.screenSaverTimeout;
+    // The CRC vouches for the bytes, not for the terminators
+    r.localTimeLabel[sizeof(r.localTimeLabel) - 1] = 0;
+    r.utcTimeLabel[sizeof(r.utcTimeLabel) - 1] = 0;
+    r.startupLogo[sizeof(r.startupLogo) - 1] = 0;
+    r.timeZone[sizeof(r.timeZone) - 1] = 0;
+    localTimeLabel = r.localTimeLabel;
+    utcTimeLabel = r.utcTimeLabel;
+    startupLogo = r.startupLogo;
+    timeZoneRule = r.timeZone;
+}
+
+// The JSON layout of the old /settings.json, now only exported and imported over HTTP
+void settingsToJson(JsonDocument &doc)
+{
+    doc["latitude"] = latitude;
+    doc["longitude"] = longitude;
+    doc["localTimeColour"] = localTimeColour;
+    doc["utcTimeColour"] = utcTimeColour;
+    doc["doubleFrame"] = doubleFrame;
+    doc["localFrameColour"] = localFrameColour;
+    doc["utcFrameColour"] = utcFrameColour;
+    doc["bannerColour"] = bannerColour;
+    doc["bannerSpeed"] = bannerSpeed;
+    doc["localTimeLabel"] = localTimeLabel;
+    doc["utcTimeLabel"] = utcTimeLabel;
+    doc["startupLogo"] = startupLogo;
+    doc["italicClockFonts"] = italicClockFonts;
+    doc["screenSaverTimeout"] = screenSaverTimeout;
+    doc["bannerScreenSaver"] = bannerScreenSaver;
+    doc["timeZone"] = timeZoneRule;
+}
+
+// What the web page shows, as settingsToJson() with the screensaver in minutes
+void configToJson(JsonDocument &doc)
+{
+    settingsToJson(doc);
+    doc["screenSaverTimeout"] = screenSaverTimeout / 60000; // convert ms → minutes
+}
+
+// Missing keys keep their current value
+void settingsFromJson(const JsonDocument &doc)
+{
+    latitude = doc["latitude"] | latitude;
+    longitude = doc["longitude"] | longitude;
+    localTimeColour = doc["localTimeColour"] | localTimeColour;
+    utcTimeColour = doc["utcTimeColour"] | utcTimeColour;
+    doubleFrame = doc["doubleFrame"] | doubleFrame;
+    localFrameColour = doc["localFrameColour"] | localFrameColour;
+    utcFrameColour = doc["utcFrameColour"] | utcFrameColour;
+    bannerColour = doc["bannerColour"] | bannerColour;
+    bannerSpeed = doc["bannerSpeed"] | bannerSpeed;
+    localTimeLabel = doc["localTimeLabel"] | localTimeLabel;
+    utcTimeLabel = doc["utcTimeLabel"] | utcTimeLabel;
+    startupLogo = doc["startupLogo"] | startupLogo;
+    italicClockFonts = doc["italicClockFonts"] | italicClockFonts;
+    screenSaverTimeout = doc["screenSaverTimeout"] | screenSaverTimeout;
+    bannerScreenSaver = doc["bannerScreenSaver"] | bannerScreenSaver;
+    timeZoneRule = doc["timeZone"] | timeZoneRule;
+}
+
+// 💾 A change worth keeping, written by settingsFlushStep() once changes stop coming
+void markSettingsDirty()
+{
+    settingsWriteBehind.markDirty(millis());
+}
+
+void settingsFlushStep()
+{
+    if (settingsWriteBehind.due(millis()))
+        saveSettings();
+    // Changes that are not saved (banner speed, labels) or that were saved at once
+    if (configBroadcastPending && !settingsWriteBehind.dirty())
+        broadcastConfig();
+}
+
+// 📡 The settings as /config has them, to every open page
+void broadcastConfig()
+{
+    configBroadcastPending = false;
+    if (!eventStream.clients())
         return;
+    JsonDocument doc(&jsonArena);
+    configToJson(doc);
+    char json[EventStream::MAX_EVENT - 32];
+    if (serializeJson(doc, json, sizeof(json)) < sizeof(json) - 1)
+        eventStream.broadcast("config", json);
+}
+
+// ⚙️ Show a settings change while the clock runs: only what differs from before is redone
+void applySettings(const SettingsRecord &before)
+{
+    SettingsRecord after;
+    settingsToRecord(after);
+    uint16_t changes = settingsChanges(before, after);
+    lastActivity = millis(); // A change from the web page is activity
+
+    // 📡 Every open page follows, including fields that need no action here; once per
+    // flush, not once per picker move
+    if (memcmp(&before, &after, sizeof(after)) != 0)
+        configBroadcastPending = true;
+    if (!changes)
+        return;
+
+    if ((changes & CHANGE_TIME_ZONE) && !timeZone.set(timeZoneRule.c_str()))
+        Serial.printf("⚠️ Invalid time zone \"%s\", local time shows UTC\n", timeZoneRule.c_str());
+    if (changes & CHANGE_BANNER_SPEED)
+        scheduler.setPeriod(bannerTask, bannerPeriodUs());
+    if (changes & CHANGE_WEATHER)
+        requestWeather();
+    if (changes & CHANGE_CLOCK_FONT)
+        rebuildClockGlyphs(); // Old digits are a different shape, both faces start again
+
+    const uint16_t faces = CHANGE_LOCAL_FACE | CHANGE_UTC_FACE | CHANGE_CLOCK_FONT;
+    if (changes & CHANGE_STARTUP_LOGO)
+        previewStartupLogo(2000); // Not here: the handler would hold loop() for the decode and the wait
+
+    // The screensaver shows no faces, leaving it draws them all; so does the end of a preview
+    if (screenSaver && (changes & (faces | CHANGE_LOCAL_DIGITS | CHANGE_UTC_DIGITS)))
+        exitScreenSaver();
+    else if (!screenSaver && !logoPreviewShown)
+    {
+        if (changes & (CHANGE_LOCAL_FACE | CHANGE_CLOCK_FONT))
+            redrawClockFace(false);
+        else if (changes & CHANGE_LOCAL_DIGITS)
+            memset(previousLocalTime, 0, sizeof(previousLocalTime)); // Repainted on the next tick
+        if (changes & (CHANGE_UTC_FACE | CHANGE_CLOCK_FONT))
+            redrawClockFace(true);
+        else if (changes & CHANGE_UTC_DIGITS)
+            memset(previousUTCtime, 0, sizeof(previousUTCtime));
     }
-    server.streamFile(file, "text/html");
-    file.close();
+
+    Serial.print("⚙️ Applied live:");
+    for (uint8_t i = 0; i < SETTINGS_CHANGE_COUNT; i++)
+        if (changes & (1 << i))
+            Serial.printf(" %s", settingsChangeName(1 << i));
+    Serial.println();
 }
 
 // Handle POST form submission and save settings
 void handleSave()
 {
+    SettingsRecord before;
+    settingsToRecord(before);
     if (server.hasArg("latitude"))
         latitude = server.arg("latitude").toFloat();
     if (server.hasArg("longitude"))
@@ -1355,57 +2052,57 @@ void handleSave()
         italicClockFonts = (server.arg("italicFont") == "on");
 
     saveSettings(); // Save updated settings
+    applySettings(before);
 
     server.send(200, "text/html", "<h1>✅ Settings saved!</h1><a href='/'>Back</a>");
 }
-void drawOrredrawStaticElements()
+// Clear both clock faces and draw their frames
+void drawClockFrames()
+{
+    drawClockFrame(0, localFrameColour);  // 🟩 Local Frame
+    drawClockFrame(105, utcFrameColour); // 🟥 UTC Frame
+}
+
+// Clear one clock face, top at y, and draw its frame
+void drawClockFrame(int y, uint16_t colour)
 {
-    // Only run if we want to refresh the frames
-    if (refreshFrames)
+    tft.fillRect(0, y, 320, 87, TFT_BLACK); // Clear previous frame
+    tft.drawRoundRect(1, y + 1, 318, 85, 4, TFT_BLACK);
+
+    tft.drawRoundRect(0, y, 320, 87, 5, colour);
+    if (doubleFrame)
     {
-        refreshFramesCounter++;
-        if (refreshFramesCounter < 2)
-        {
-            return; // Wait for second execution
-        }
-        refreshFrames = false;
-        refreshFramesCounter = 0;
+        tft.drawRoundRect(1, y + 1, 318, 85, 4, colour);
+        tft.drawRoundRect(2, y + 2, 316, 83, 4, colour);
+        tft.drawRoundRect(3, y + 3, 314, 81, 4, colour);
     }
-    previousLocalTime = "";
-    previousUTCtime = "";
+}
+
+// One face after its frame or label changed, the digits come back on the next tick
+void redrawClockFace(bool utc)
+{
+    int y = utc ? 105 : 0;
+    drawClockFrame(y, utc ? utcFrameColour : localFrameColour);
+    tft.setFreeFont(&Orbitron_Medium8pt7b);
+    tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
+    tft.drawCentreString(utc ? utcTimeLabel : localTimeLabel, 160, 76 + y, 1);
+    memset(utc ? previousUTCtime : previousLocalTime, 0, CIVIL_HMS_SIZE);
+}
+
+void drawOrredrawStaticElements()
+{
+    memset(previousLocalTime, 0, sizeof(previousLocalTime));
+    memset(previousUTCtime, 0, sizeof(previousUTCtime));
     tft.setFreeFont(&Orbitron_Medium8pt7b);
     tft.fillRect(25, 0 + 85 - 10, 270, 20, TFT_BLACK);
     tft.fillRect(25, 106 + 85 - 10, 270, 20, TFT_BLACK);
 
-    // 🟩 Local Frame
-    tft.fillRect(0, 0, 320, 87, TFT_BLACK); // Clear previous frame
-    tft.drawRoundRect(1, 1, 318, 85, 4, TFT_BLACK);
-
-    tft.drawRoundRect(0, 0, 320, 87, 5, localFrameColour);
-    if (doubleFrame)
-    {
-        tft.drawRoundRect(1, 1, 318, 85, 4, localFrameColour);
-        tft.drawRoundRect(2, 2, 316, 83, 4, localFrameColour);
-        tft.drawRoundRect(3, 3, 314, 81, 4, localFrameColour);
-    }
+    drawClockFrames();
 
     // 🟦 Local Time Label
-
     tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
     tft.drawCentreString(localTimeLabel, 160, 76, 1);
 
-    // 🟥 UTC Frame
-    tft.fillRect(0, 105, 320, 87, TFT_BLACK); // Clear previous frame
-    tft.drawRoundRect(1, 106, 318, 85, 4, TFT_BLACK);
-
-    tft.drawRoundRect(0, 105, 320, 87, 5, utcFrameColour);
-    if (doubleFrame)
-    {
-        tft.drawRoundRect(1, 106, 318, 85, 4, utcFrameColour);
-        tft.drawRoundRect(2, 107, 316, 83, 4, utcFrameColour);
-        tft.drawRoundRect(3, 108, 314, 81, 4, utcFrameColour);
-    }
-
     // ⬜ UTC Label
     tft.drawCentreString(utcTimeLabel, 160, 76 + 105, 1);
 }
@@ -1477,6 +2174,8 @@ void handlePNGUpload()
         Serial.printf("📁 Uploading PNG: %s\n", upload.filename.c_str());
 
         // 🖥️ Blank screen and show "Receiving" + "New" + "Splash Screen" on 3 lines
+        if (screenSaver)
+            exitScreenSaver(); // The banner screensaver's scroll offset would shift the text
         tft.fillScreen(TFT_BLACK);
         tft.setTextColor(TFT_WHITE, TFT_BLACK);
         tft.setFreeFont(&Orbitron_Light_32);
@@ -1490,31 +2189,47 @@ void handlePNGUpload()
         tft.setFreeFont(&Orbitron_Medium8pt7b);
         tft.drawCentreString("Please wait...", 160, 170, 1);
 
-        fs::File file = SPIFFS.open("/logo4.png", FILE_WRITE);
-        if (!file)
-        {
-            Serial.println("❌ Failed to open file for writing");
-            return;
-        }
-        file.close();
+        // Checked while it streams into /logo4.png.tmp, the current logo stays until it is complete
+        if (!logoUpload.begin())
+            Serial.printf("❌ %s\n", logoUpload.errorText());
     }
     else if (upload.status == UPLOAD_FILE_WRITE)
     {
-        fs::File file = SPIFFS.open("/logo4.png", FILE_APPEND);
-        if (file)
-        {
-            file.write(upload.buf, upload.currentSize);
-            file.close();
-        }
+        bool ok = logoUpload.error() == PngUpload::NONE;
+        if (!logoUpload.write(upload.buf, upload.currentSize) && ok)
+            Serial.printf("❌ Upload rejected at %u bytes: %s\n", (unsigned)upload.totalSize, logoUpload.errorText());
     }
     else if (upload.status == UPLOAD_FILE_END)
     {
-        Serial.printf("✅ Upload complete: %s (%d bytes)\n", upload.filename.c_str(), upload.totalSize);
+        SettingsRecord before;
+        settingsToRecord(before);
+        if (!logoUpload.end())
+        {
+            Serial.printf("❌ Upload failed: %s, keeping %s\n", logoUpload.errorText(), startupLogo.c_str());
+            server.send(400, "text/plain", String("❌ ") + logoUpload.errorText());
+            exitScreenSaver(); // The clock again, whatever the panel showed when the upload began
+            return;
+        }
+        Serial.printf("✅ Upload complete: %s (%u bytes, %u x %u, %u KB/s)\n", upload.filename.c_str(),
+                      (unsigned)logoUpload.bytes(), (unsigned)logoUpload.checker().width(),
+                      (unsigned)logoUpload.checker().height(), (unsigned)logoUpload.kilobytesPerSecond());
         server.send(200, "text/plain", "✅ PNG upload complete. Will be used at next boot.");
+
+        // The ETag of the old logo4.png must not validate the new one, nor its decoded copy show
+        if (assetCatalog.forget("/logo4.png"))
+            saveAssetCatalog();
+        splashCache.invalidate();
+
         startupLogo = "logo4.png";
-        displayPNGfromSPIFFS("logo4.png", 3000);
         saveSettings();
-        tft.fillScreen(TFT_BLACK);
-        drawOrredrawStaticElements();
+        applySettings(before);
+        configBroadcastPending = true; // logo4.png is new even if it was already the choice
+        previewStartupLogo(3000);
+    }
+    else if (upload.status == UPLOAD_FILE_ABORTED)
+    {
+        Serial.println("❌ Upload aborted by the client");
+        logoUpload.abort();
+        exitScreenSaver();
     }
 }